@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "../src/lib/compiler/lexer.h"
+
+#define BENCH_LINES 200000
+#define BENCH_RUNS 5
+
+static double now_seconds(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static String bench_source(Arena* const arena, char const* const* const lines, size_t const lines_len) {
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_LINES; ++i) {
+        length += strlen(lines[i % lines_len]);
+    }
+
+    char* const chars = arena_alloc(arena, length + 1);
+    char* cursor = chars;
+    for (size_t i = 0; i < BENCH_LINES; ++i) {
+        size_t const line_len = strlen(lines[i % lines_len]);
+        memcpy(cursor, lines[i % lines_len], line_len);
+        cursor += line_len;
+    }
+    *cursor = '\0';
+
+    return (String){ .length = length, .chars = chars };
+}
+
+static void bench_lexer(char const* const bench_name, String const src) {
+    Arena scan_arena = {0};
+    double best = 0;
+    size_t identifiers = 0;
+
+    for (size_t run = 0; run < BENCH_RUNS; ++run) {
+        Lexer lexer = lexer_create(&scan_arena, src);
+
+        double const start = now_seconds();
+        ScanResult const scan_res = lexer_scan(&lexer);
+        double const elapsed = now_seconds() - start;
+
+        scanres_assert(scan_res);
+
+        identifiers = 0;
+        for (size_t i = 0; i < scan_res.res.tokens.length; ++i) {
+            TokenType const type = scan_res.res.tokens.array[i].type;
+            if (type == TT_IDENTIFIER || (type >= TT_BREAK && type <= TT_FLOAT64)) {
+                identifiers += 1;
+            }
+        }
+
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+
+        arena_reset(&scan_arena);
+    }
+
+    printf("%s: %lu bytes, %lu identifiers/keywords, best of %d runs: %.3f ms\n", bench_name, src.length, identifiers, BENCH_RUNS, best * 1000);
+    printf("%s: %.2f M identifiers/sec, %.2f MB/sec\n", bench_name, (double)identifiers / best / 1e6, (double)src.length / best / 1e6);
+
+    arena_free(&scan_arena);
+}
+
+int main(void) {
+    Arena arena = {0};
+
+    // identifier-heavy source: keywords mixed with near-miss identifiers
+    static char const* const IDENTIFIER_LINES[] = {
+        "let mut counter_value: uint64 = other_value + offset;\n",
+        "if breaker and continued or forever then return_value;\n",
+        "struct Item { name_field: char, int6: int32, crash: bool }\n",
+        "foreach element_name in collection_items { print(element_name); }\n",
+        "while is_running_now { step_forward(state, delta_time); }\n",
+        "typedef unionized = staticky; import package_name::module_path;\n",
+    };
+    bench_lexer("identifiers", bench_source(&arena, IDENTIFIER_LINES, sizeof IDENTIFIER_LINES / sizeof *IDENTIFIER_LINES));
+
+    // comment-heavy source: license headers, doc comments and indentation
+    static char const* const COMMENT_LINES[] = {
+        "/*\n * Copyright (c) the Quill authors. Permission is hereby granted, free of charge,\n",
+        " * to any person obtaining a copy of this software and associated documentation\n *\n */\n",
+        "\n\n        // Returns the number of items left in the queue, or zero when empty.\n",
+        "        // Nested /* block */ markers inside a line comment do nothing.\n",
+        "    /* a /* nested */ block comment\n       spanning several lines */\n",
+        "        let x = 1;\n\t\t\r\n",
+    };
+    bench_lexer("comments", bench_source(&arena, COMMENT_LINES, sizeof COMMENT_LINES / sizeof *COMMENT_LINES));
+
+    arena_free(&arena);
+
+    return EXIT_SUCCESS;
+}
@@ -12,64 +12,62 @@ int main(int const argc, char* const argv[]) {
     parse_args(&arena, &args, argc, argv);
     assert(args.paths_to_include.length > 0);
 
-    Packages packages = packages_create(&arena);
-    size_t next_node_id = 0;
-    size_t next_type_id = 0;
-
-    for (size_t i = 0; i < args.paths_to_include.length; ++i) {
-        String const source_path = args.paths_to_include.strings[i];
+    String build_dir = args.opt_args.strings[QO_BUILD_DIR];
+    assert(build_dir.length);
 
-        String const source = file_read(&arena, source_path);
+    String module_paths = args.opt_args.strings[QO_MODULE_PATH];
+    BuildCache cache = build_cache_create(&arena, args.opt_args.strings[QO_CACHE_DIR], build_dir, module_paths.chars ? module_paths : c_str(""));
+    // a dump is only written while compiling, so one asked for means compiling again
+    bool const dumping = log_dumps(LOG_DUMP_AST | LOG_DUMP_C | LOG_DUMP_GENERICS);
+    if (!dumping && build_cache_up_to_date(&cache, args.paths_to_include, args.module_paths)) {
+        log_info("Nothing changed since the last build into \"%s\".\n", cache.build_dir.chars);
+        arena_free(&arena);
+        return EXIT_SUCCESS;
+    }
 
-        Lexer lexer = lexer_create(&arena, source);
-        ScanResult const scan_res = lexer_scan(&lexer);
+    Packages packages = packages_create(&arena);
 
-        scanres_assert(scan_res);
-        ArrayList_Token const tokens = scan_res.res.tokens;
+    dir_create(cache.dir);
 
-        Parser parser = parser_create(&arena, tokens);
-        parser.next_node_id = next_node_id;
-        parser.next_type_id = next_type_id;
+    Frontend frontend = frontend_create(&arena, args.paths_to_include, args.module_paths, cache.dir, args.jobs);
+    frontend_parse(&frontend);
 
-        ASTNodeResult const ast_res = parser_parse(&parser);
-        next_node_id = parser.next_node_id;
-        next_type_id = parser.next_type_id;
+    size_t const next_node_id = frontend.next_node_id;
+    size_t const next_type_id = frontend.next_type_id;
 
-        astres_assert(ast_res);
-        ASTNode const* ast = ast_res.res.ast;
+    for (size_t i = 0; i < frontend.sources_length; ++i) {
+        ParsedSource const* const source = frontend.sources + i;
+        ASTNode const* ast = source->ast;
 
         Analyzer analyzer = {0};
         verify_syntax(&analyzer, ast);
 
-        printf("AST:");
-        if (parser.had_error) {
-            printf(" (partial due to errors)");
-        }
-        printf("\n");
-
-        print_astnode(*ast);
-        printf("\n");
+        if (log_dumps(LOG_DUMP_AST)) {
+            printf("AST:");
+            if (source->had_error) {
+                printf(" (partial due to errors)");
+            }
+            printf("\n");
 
-        PackagePath* package_name = NULL;
-        if (parser.package) {
-            package_name = parser.package->node.package.package_path;
+            print_astnode(*ast);
+            printf("\n");
         }
 
-        Package* pkg = packages_resolve_or_create(&packages, package_name);
+        Package* pkg = packages_resolve_or_create(&packages, source->package_name);
         assert(!pkg->ast);
         pkg->ast = ast;
+        pkg->decls = source->decls;
+        build_cache_track(&cache, source->path, source->listed ? (String){0} : source->package_key, source->source_hash, pkg);
 
         // look for main
         {
-            LLNode_ASTNode* curr = ast->node.file_root.nodes.head;
-            while (curr) {
-                if (curr->data.type == ANT_FUNCTION_DECL) {
-                    if (curr->data.node.function_decl.header.is_main) {
+            for (size_t i = 0; i < ast->node.file_root.nodes.length; ++i) {
+                ASTNode* curr = ast->node.file_root.nodes.array + i;
+                if (curr->type == ANT_FUNCTION_DECL) {
+                    if (curr->node.function_decl->header.is_main) {
                         pkg->is_entry = true;
                     }
                 }
-
-                curr = curr->next;
             }
         }
     }
@@ -81,22 +79,27 @@ int main(int const argc, char* const argv[]) {
     packages.types_length = next_node_id + next_type_id;
     packages.types = arena_calloc(&arena, packages.types_length, sizeof *packages.types);
 
-    TypeResolver type_resolver = type_resolver_create(&arena, &packages);
+    TypeResolver type_resolver = type_resolver_create(&arena, &packages, args.jobs);
     resolve_types(&type_resolver);
 
-    CodegenC codegen = codegen_c_create(&arena, &packages);
-    GeneratedFiles const c_code = generate_c_code(&codegen);
+    Reachability const reachability = reachability_find(&arena, &packages);
+    log_verbose("Pruned %lu of %lu declarations\n", reachability.pruned, reachability.decls);
 
-    String build_dir = args.opt_args.strings[QO_BUILD_DIR];
-    assert(build_dir.length);
+    build_cache_prepare(&cache, &packages, &reachability);
 
-    printf("C Code:\n");
-    for (size_t i = 0; i < c_code.length; ++i) {
-        GeneratedFile* file = c_code.files + i;
-        write_file(&arena, build_dir, file->filepath, file->content);
-    }
+    CodegenC codegen = codegen_c_create(&arena, &packages);
+    codegen.cache = &cache;
+    codegen.reachability = &reachability;
+    codegen.echo = log_dumps(LOG_DUMP_C) ? stdout : NULL;
+    codegen.jobs = args.jobs;
+    generate_c_code(&codegen, build_dir);
+    build_cache_save(&cache);
+
+    log_info("Reused the generated C of %lu of %lu packages\n", cache.reused, packages.count);
 
     // cleanup
+    type_resolver_free(&type_resolver);
+    frontend_free(&frontend);
     arena_free(&arena);
 
     return EXIT_SUCCESS;
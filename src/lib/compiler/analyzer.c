@@ -115,10 +115,9 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
             assert(*iter == 1);
             assert(ast->directives.length == 0);
 
-            LLNode_ASTNode const* curr = ast->node.file_root.nodes.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.file_root.nodes.length; ++i) {
+                ASTNode const* curr = ast->node.file_root.nodes.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
             break;
         }
@@ -169,10 +168,9 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
         }
 
         case ANT_TUPLE: {
-            LLNode_ASTNode* curr = ast->node.tuple.exprs.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.tuple.exprs.length; ++i) {
+                ASTNode* curr = ast->node.tuple.exprs.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
             break;
         }
@@ -198,20 +196,18 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
         case ANT_FUNCTION_CALL: {
             verify_node(analyzer, ast->node.function_call.function, depth + 1, iter);
 
-            LLNode_ASTNode* curr = ast->node.function_call.args.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.function_call.args.length; ++i) {
+                ASTNode* curr = ast->node.function_call.args.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
 
             break;
         }
 
         case ANT_STATEMENT_BLOCK: {
-            LLNode_ASTNode* curr = ast->node.statement_block.stmts.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.statement_block.stmts.length; ++i) {
+                ASTNode* curr = ast->node.statement_block.stmts.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
 
             break;
@@ -222,10 +218,9 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
 
             verify_node(analyzer, ast->node.if_.cond, depth + 1, iter);
 
-            LLNode_ASTNode* curr = ast->node.if_.block->stmts.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.if_.block->stmts.length; ++i) {
+                ASTNode* curr = ast->node.if_.block->stmts.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
 
             if (ast->node.if_.else_) {
@@ -251,10 +246,9 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
 
             verify_node(analyzer, ast->node.while_.cond, depth + 1, iter);
 
-            LLNode_ASTNode* curr = ast->node.while_.block->stmts.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.while_.block->stmts.length; ++i) {
+                ASTNode* curr = ast->node.while_.block->stmts.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
 
             break;
@@ -266,10 +260,9 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
         case ANT_FOREACH: {
             verify_node(analyzer, ast->node.foreach.iterable, depth + 1, iter);
 
-            LLNode_ASTNode* curr = ast->node.foreach.block->stmts.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.foreach.block->stmts.length; ++i) {
+                ASTNode* curr = ast->node.foreach.block->stmts.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
 
             break;
@@ -317,10 +310,9 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
         case ANT_IMPORT: break;
 
         case ANT_TEMPLATE_STRING: {
-            LLNode_ASTNode* curr = ast->node.template_string.template_expr_parts.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.template_string.template_expr_parts.length; ++i) {
+                ASTNode* curr = ast->node.template_string.template_expr_parts.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
             break;
         }
@@ -346,7 +338,7 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
         }
 
         case ANT_STRUCT_DECL: {
-            LLNode_StructField* curr = ast->node.struct_decl.fields.head;
+            LLNode_StructField* curr = ast->node.struct_decl->fields.head;
             while (curr) {
                 verify_type(analyzer, curr->data.type, depth + 1, iter);
                 curr = curr->next;
@@ -366,18 +358,17 @@ static void verify_node(Analyzer* analyzer, ASTNode const* const ast, size_t dep
 
         case ANT_FUNCTION_HEADER_DECL: {
             assert(depth == 1);
-            verify_type(analyzer, &ast->node.function_header_decl.return_type, depth + 1, iter);
+            verify_type(analyzer, &ast->node.function_header_decl->return_type, depth + 1, iter);
             break;
         }
 
         case ANT_FUNCTION_DECL: {
             assert(depth == 1);
-            verify_type(analyzer, &ast->node.function_decl.header.return_type, depth + 1, iter);
+            verify_type(analyzer, &ast->node.function_decl->header.return_type, depth + 1, iter);
 
-            LLNode_ASTNode* curr = ast->node.function_decl.stmts.head;
-            while (curr) {
-                verify_node(analyzer, &curr->data, depth + 1, iter);
-                curr = curr->next;
+            for (size_t i = 0; i < ast->node.function_decl->stmts.length; ++i) {
+                ASTNode* curr = ast->node.function_decl->stmts.array + i;
+                verify_node(analyzer, curr, depth + 1, iter);
             }
 
             break;
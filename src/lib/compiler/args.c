@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "./args.h"
@@ -70,6 +71,41 @@ static ArgMatcher matcher_for(Arena* arena, Strings args, QuillcOption opt) {
             };
         }
 
+        case QO_JOBS: {
+            static size_t const patterns_len = 2;
+            Strings patterns = { patterns_len, arena_calloc(arena, patterns_len, sizeof(Strings)) };
+            patterns.strings[0] = c_str("-j");
+            patterns.strings[1] = c_str("--jobs");
+            return (ArgMatcher){
+                .is_path = false,
+                .patterns = patterns,
+                .arg = args.strings + opt,
+            };
+        }
+
+        case QO_CACHE_DIR: {
+            static size_t const patterns_len = 1;
+            Strings patterns = { patterns_len, arena_calloc(arena, patterns_len, sizeof(Strings)) };
+            patterns.strings[0] = c_str("--cache-dir");
+            return (ArgMatcher){
+                .is_path = true,
+                .patterns = patterns,
+                .arg = args.strings + opt,
+            };
+        }
+
+        case QO_MODULE_PATH: {
+            static size_t const patterns_len = 2;
+            Strings patterns = { patterns_len, arena_calloc(arena, patterns_len, sizeof(Strings)) };
+            patterns.strings[0] = c_str("-I");
+            patterns.strings[1] = c_str("--module-path");
+            return (ArgMatcher){
+                .is_path = false,
+                .patterns = patterns,
+                .arg = args.strings + opt,
+            };
+        }
+
         default: assert(false);
     }
 }
@@ -107,6 +143,24 @@ static bool match_arg(char* const argv[], uint8_t* pi, ArgMatcher* matcher) {
     return false;
 }
 
+// flags take no value, and only match as a whole
+static bool match_flag(char const* arg, QuillcArgs* out) {
+    if (strcmp(arg, "-q") == 0 || strcmp(arg, "--quiet") == 0) {
+        out->log_level = LOG_QUIET;
+    } else if (strcmp(arg, "-v") == 0 || strcmp(arg, "--verbose") == 0) {
+        out->log_level = LOG_VERBOSE;
+    } else if (strcmp(arg, "--dump-ast") == 0) {
+        out->dumps |= LOG_DUMP_AST;
+    } else if (strcmp(arg, "--dump-c") == 0) {
+        out->dumps |= LOG_DUMP_C;
+    } else if (strcmp(arg, "--dump-generics") == 0) {
+        out->dumps |= LOG_DUMP_GENERICS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void parse_args(Arena* arena, QuillcArgs* out, int const argc, char* const argv[]) {
     assert(argc <= ARGC_MAX);
 
@@ -115,6 +169,9 @@ void parse_args(Arena* arena, QuillcArgs* out, int const argc, char* const argv[
 
     uint8_t paths_len = 0;
 
+    out->log_level = LOG_NORMAL;
+    out->dumps = 0;
+
     ArgMatcher arg_matchers[QO_COUNT] = {0};
     for (uint8_t i = 0; i < QO_COUNT; ++i) {
         arg_matchers[i] = matcher_for(arena, out->opt_args, i);
@@ -129,6 +186,10 @@ void parse_args(Arena* arena, QuillcArgs* out, int const argc, char* const argv[
             continue;
         }
 
+        if (match_flag(arg, out)) {
+            continue;
+        }
+
         for (uint8_t j = 0; j < QO_COUNT; ++j) {
             if (match_arg(argv, &i, &arg_matchers[j])) {
                 has_opts = true;
@@ -150,6 +211,31 @@ void parse_args(Arena* arena, QuillcArgs* out, int const argc, char* const argv[
     out->opt_args.length = QO_COUNT;
     out->paths_to_include.length = paths_len;
 
+    out->jobs = 1;
+    if (out->opt_args.strings[QO_JOBS].chars) {
+        char* end = NULL;
+        out->jobs = strtoul(out->opt_args.strings[QO_JOBS].chars, &end, 10);
+        assert(*end == '\0' && out->jobs > 0);
+    }
+
+    out->module_paths = (Strings){0};
+    String module_path = out->opt_args.strings[QO_MODULE_PATH];
+    if (module_path.chars) {
+        out->module_paths.strings = arena_calloc(arena, module_path.length + 1, sizeof(String));
+
+        size_t start = 0;
+        for (size_t i = 0; i <= module_path.length; ++i) {
+            if (i < module_path.length && module_path.chars[i] != ':') {
+                continue;
+            }
+            if (i > start) {
+                String dir = { .length = i - start, .chars = module_path.chars + start };
+                out->module_paths.strings[out->module_paths.length++] = arena_strcpy(arena, normalize_path(dir));
+            }
+            start = i + 1;
+        }
+    }
+
     // remove duplicates
     for (size_t i = 0; i < out->paths_to_include.length - 1; ++i) {
         String const istr = out->paths_to_include.strings[i];
@@ -170,25 +256,24 @@ void parse_args(Arena* arena, QuillcArgs* out, int const argc, char* const argv[
         out->paths_to_include.strings[i] = arena_strcpy(arena, out->paths_to_include.strings[i]);
     }
 
-    // debug print args
-    {
-        printf("\n");
+    log_configure(out->log_level, out->dumps);
 
-        if (has_opts) { printf("Options:\n"); }
+    if (log_enabled(LOG_VERBOSE)) {
+        if (has_opts) { log_verbose("Options:\n"); }
         for (uint8_t i = 0; i < QO_COUNT; ++i) {
             if (!out->opt_args.strings[i].chars) { continue; }
 
             char const* arg = out->opt_args.strings[i].chars;
-            printf("- [%s] %s\n", arg_matchers[i].patterns.strings[0].chars, arg);
+            log_verbose("- [%s] %s\n", arg_matchers[i].patterns.strings[0].chars, arg);
         }
 
         if (out->paths_to_include.length > 0) {
-            printf("- source paths:\n");
+            log_verbose("- source paths:\n");
             for (uint8_t i = 0; i < out->paths_to_include.length; ++i) {
-                printf("  - \"%s\"\n", out->paths_to_include.strings[i].chars);
+                log_verbose("  - \"%s\"\n", out->paths_to_include.strings[i].chars);
             }
         }
 
-        printf("\n");
+        log_verbose("\n");
     }
 }
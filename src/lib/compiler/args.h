@@ -11,6 +11,9 @@ typedef enum {
     QO_LSTD,
     QO_LLIBC,
     QO_BUILD_DIR,
+    QO_JOBS,
+    QO_CACHE_DIR,
+    QO_MODULE_PATH,
 
     QO_COUNT
 } QuillcOption;
@@ -18,8 +21,17 @@ typedef enum {
 typedef struct {
     Strings opt_args;
     Strings paths_to_include;
+    // QO_MODULE_PATH split on ':'
+    Strings module_paths;
+
+    size_t jobs;
+
+    // -q, -v and the --dump-* flags
+    LogLevel log_level;
+    unsigned dumps;
 } QuillcArgs;
 
+// also configures the log from the -q, -v and --dump-* flags
 void parse_args(Arena* arena, QuillcArgs* out, int const argc, char* const argv[]);
 
 #endif
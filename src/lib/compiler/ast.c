@@ -5,139 +5,193 @@
 #include "./ast.h"
 #include "../utils/utils.h"
 
-ASTNode* find_decl_by_id(ASTNodeFileRoot root, NodeId id) {
-    LLNode_ASTNode* curr = root.nodes.head;
-    while (curr) {
-        if (curr->data.id.val == id.val) {
-            return &curr->data;
+// name a top-level decl is found by, if it has one
+static bool decl_name(ASTNode const node, String* out_name) {
+    switch (node.type) {
+        case ANT_VAR_DECL: {
+            if (node.node.var_decl.lhs.type == VDLT_NAME) {
+                *out_name = node.node.var_decl.lhs.lhs.name;
+                return true;
+            }
+            break;
         }
-        curr = curr->next;
-    }
-
-    return NULL;
-}
 
-ASTNode* find_decl_by_name(ASTNodeFileRoot root, String name) {
-    LLNode_ASTNode* curr = root.nodes.head;
-    while (curr) {
-        ASTNode node = curr->data;
-        switch (node.type) {
-            case ANT_VAR_DECL: {
-                if (node.node.var_decl.lhs.type == VDLT_NAME && str_eq(node.node.var_decl.lhs.lhs.name, name)) {
-                    return &curr->data;
-                }
-                break;
+        case ANT_STRUCT_DECL: {
+            if (node.node.struct_decl->maybe_name) {
+                *out_name = *node.node.struct_decl->maybe_name;
+                return true;
             }
+            break;
+        }
 
-            case ANT_STRUCT_DECL: {
-                if (node.node.struct_decl.maybe_name && str_eq(*node.node.struct_decl.maybe_name, name)) {
-                    return &curr->data;
-                }
-                break;
+        case ANT_UNION_DECL: {
+            if (node.node.union_decl.maybe_name) {
+                *out_name = *node.node.union_decl.maybe_name;
+                return true;
             }
+            break;
+        }
 
-            case ANT_UNION_DECL: {
-                if (node.node.union_decl.maybe_name && str_eq(*node.node.union_decl.maybe_name, name)) {
-                    return &curr->data;
-                }
-                break;
-            }
+        case ANT_ENUM_DECL: {
+            *out_name = node.node.enum_decl.name;
+            return true;
+        }
 
-            case ANT_ENUM_DECL: {
-                if (str_eq(node.node.enum_decl.name, name)) {
-                    return &curr->data;
-                }
-                break;
-            }
+        case ANT_TYPEDEF_DECL: {
+            *out_name = node.node.typedef_decl.name;
+            return true;
+        }
 
-            case ANT_TYPEDEF_DECL: {
-                if (str_eq(node.node.typedef_decl.name, name)) {
-                    return &curr->data;
-                }
-                break;
+        case ANT_GLOBALTAG_DECL: {
+            if (node.node.globaltag_decl.maybe_name) {
+                *out_name = *node.node.globaltag_decl.maybe_name;
+                return true;
             }
+            break;
+        }
 
-            case ANT_GLOBALTAG_DECL: {
-                if (node.node.globaltag_decl.maybe_name && str_eq(*node.node.globaltag_decl.maybe_name, name)) {
-                    return &curr->data;
-                }
-                break;
-            }
+        case ANT_FUNCTION_HEADER_DECL: {
+            *out_name = node.node.function_header_decl->name;
+            return true;
+        }
 
-            case ANT_FUNCTION_HEADER_DECL: {
-                if (str_eq(node.node.function_header_decl.name, name)) {
-                    return &curr->data;
-                }
-                break;
-            }
+        case ANT_FUNCTION_DECL: {
+            *out_name = node.node.function_decl->header.name;
+            return true;
+        }
 
-            case ANT_FUNCTION_DECL: {
-                if (str_eq(node.node.function_decl.header.name, name)) {
-                    return &curr->data;
-                }
-                break;
-            }
+        case ANT_NONE: break;
+        case ANT_FILE_SEPARATOR: break;
+        case ANT_UNARY_OP: break;
+        case ANT_BINARY_OP: break;
+        case ANT_POSTFIX_OP: break;
+        case ANT_LITERAL: break;
+        case ANT_TUPLE: break;
+        case ANT_VAR_REF: break;
+        case ANT_GET_FIELD: break;
+        case ANT_INDEX: break;
+        case ANT_RANGE: break;
+        case ANT_ASSIGNMENT: break;
+        case ANT_FUNCTION_CALL: break;
+        case ANT_STATEMENT_BLOCK: break;
+        case ANT_IF: break;
+        case ANT_TRY: break;
+        case ANT_CATCH: break;
+        case ANT_BREAK: break;
+        case ANT_CONTINUE: break;
+        case ANT_WHILE: break;
+        case ANT_DO_WHILE: break;
+        case ANT_FOR: break;
+        case ANT_FOREACH: break;
+        case ANT_RETURN: break;
+        case ANT_DEFER: break;
+        case ANT_STRUCT_INIT: break;
+        case ANT_ARRAY_INIT: break;
+        case ANT_IMPORT: break;
+        case ANT_PACKAGE: break;
+        case ANT_TEMPLATE_STRING: break;
+        case ANT_CRASH: break;
+        case ANT_SIZEOF: break;
+        case ANT_SWITCH: break;
+        case ANT_CAST: break;
+
+        case ANT_FILE_ROOT:
+        case ANT_COUNT: assert(false);
+    }
+
+    return false;
+}
+
+DeclIndex decl_index_create(Arena* arena, ASTNodeFileRoot root) {
+    // keep both tables at most half full
+    size_t capacity = 1;
+    while (capacity < root.nodes.length * 2) {
+        capacity *= 2;
+    }
 
-            case ANT_NONE: break;
-            case ANT_FILE_SEPARATOR: break;
-            case ANT_UNARY_OP: break;
-            case ANT_BINARY_OP: break;
-            case ANT_POSTFIX_OP: break;
-            case ANT_LITERAL: break;
-            case ANT_TUPLE: break;
-            case ANT_VAR_REF: break;
-            case ANT_GET_FIELD: break;
-            case ANT_INDEX: break;
-            case ANT_RANGE: break;
-            case ANT_ASSIGNMENT: break;
-            case ANT_FUNCTION_CALL: break;
-            case ANT_STATEMENT_BLOCK: break;
-            case ANT_IF: break;
-            case ANT_TRY: break;
-            case ANT_CATCH: break;
-            case ANT_BREAK: break;
-            case ANT_CONTINUE: break;
-            case ANT_WHILE: break;
-            case ANT_DO_WHILE: break;
-            case ANT_FOR: break;
-            case ANT_FOREACH: break;
-            case ANT_RETURN: break;
-            case ANT_DEFER: break;
-            case ANT_STRUCT_INIT: break;
-            case ANT_ARRAY_INIT: break;
-            case ANT_IMPORT: break;
-            case ANT_PACKAGE: break;
-            case ANT_TEMPLATE_STRING: break;
-            case ANT_CRASH: break;
-            case ANT_SIZEOF: break;
-            case ANT_SWITCH: break;
-            case ANT_CAST: break;
-
-            case ANT_FILE_ROOT:
-            case ANT_COUNT: assert(false);
+    DeclIndex index = {
+        .nodes = root.nodes.array,
+        .capacity = capacity,
+        .by_symbol = arena_calloc(arena, capacity, sizeof(size_t)),
+        .symbols = arena_calloc(arena, capacity, sizeof(Symbol)),
+        .by_id = arena_calloc(arena, capacity, sizeof(size_t)),
+    };
+
+    for (size_t i = 0; i < root.nodes.length; ++i) {
+        ASTNode const* node = root.nodes.array + i;
+
+        size_t slot = node->id.val & (capacity - 1);
+        while (index.by_id[slot]) {
+            slot = (slot + 1) & (capacity - 1);
         }
-        curr = curr->next;
+        index.by_id[slot] = i + 1;
+
+        String name;
+        if (!decl_name(*node, &name)) {
+            continue;
+        }
+        Symbol symbol = intern(name);
+
+        slot = symbol_hash(symbol) & (capacity - 1);
+        while (index.by_symbol[slot] && index.symbols[slot] != symbol) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        // the first decl of a name wins
+        if (!index.by_symbol[slot]) {
+            index.by_symbol[slot] = i + 1;
+            index.symbols[slot] = symbol;
+        }
+    }
+
+    return index;
+}
+
+ASTNode* decl_index_by_id(DeclIndex const* index, NodeId id) {
+    if (index->capacity == 0) {
+        return NULL;
+    }
+
+    size_t slot = id.val & (index->capacity - 1);
+    while (index->by_id[slot]) {
+        ASTNode* node = index->nodes + (index->by_id[slot] - 1);
+        if (node->id.val == id.val) {
+            return node;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
     }
 
     return NULL;
 }
 
-void ll_ast_push(Arena* const arena, LL_ASTNode* const ll, ASTNode const node) {
-    LLNode_ASTNode* const llnode = arena_alloc(arena, sizeof *llnode);
-    llnode->data = node;
-    llnode->next = NULL;
-    
-    if (ll->head == NULL) {
-        ll->head = llnode;
-        ll->tail = ll->head;
-    } else {
-        ll->tail->next = llnode;
-        ll->tail = llnode;
+ASTNode* decl_index_by_symbol(DeclIndex const* index, Symbol symbol) {
+    if (index->capacity == 0 || symbol == SYMBOL_NONE) {
+        return NULL;
     }
 
-    ll->length += 1;
+    size_t slot = symbol_hash(symbol) & (index->capacity - 1);
+    while (index->by_symbol[slot]) {
+        if (index->symbols[slot] == symbol) {
+            return index->nodes + (index->by_symbol[slot] - 1);
+        }
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    return NULL;
+}
+
+ASTNode* decl_index_by_name(DeclIndex const* index, String name) {
+    return decl_index_by_symbol(index, symbol_find(name));
 }
 
+void arraylist_ast_push(Arena* const arena, ArrayList_ASTNode* const list, ASTNode const node) {
+    if (list->length >= list->capacity) {
+        size_t const capacity = list->capacity > 0 ? list->capacity * 2 : 2;
+        list->array = arena_realloc(arena, list->array, list->capacity * sizeof(ASTNode), capacity * sizeof(ASTNode));
+        list->capacity = capacity;
+    }
+
+    list->array[list->length++] = node;
+}
 void ll_directive_push(Arena* const arena, LL_Directive* const ll, Directive const directive) {
     LLNode_Directive* const llnode = arena_alloc(arena, sizeof *llnode);
     llnode->data = directive;
@@ -272,8 +326,17 @@ void arraylist_typells_push(ArrayList_LL_Type* list, LL_Type type_ll) {
     list->length += 1;
 }
 
+// names from the lexer are interned, anything built by hand falls back to comparing chars
+static bool name_eq(String const a, Symbol const a_symbol, String const b, Symbol const b_symbol) {
+    if (a_symbol != SYMBOL_NONE && b_symbol != SYMBOL_NONE) {
+        return a_symbol == b_symbol;
+    }
+
+    return str_eq(a, b);
+}
+
 bool static_path_eq(StaticPath a, StaticPath b) {
-    if (!str_eq(a.name, b.name)) {
+    if (!name_eq(a.name, a.symbol, b.name, b.symbol)) {
         return false;
     }
 
@@ -514,6 +577,7 @@ PackagePath* import_path_to_package_path(Arena* arena, ImportPath* import_path)
         case IPT_DIR: {
             *package_path = (PackagePath){
                 .name = import_path->import.dir.name,
+                .symbol = intern(import_path->import.dir.name),
                 .child = import_path_to_package_path(arena, import_path->import.dir.child),
             };
             break;
@@ -522,6 +586,7 @@ PackagePath* import_path_to_package_path(Arena* arena, ImportPath* import_path)
         case IPT_FILE: {
             *package_path = (PackagePath){
                 .name = import_path->import.file.name,
+                .symbol = intern(import_path->import.file.name),
                 .child = NULL,
             };
             break;
@@ -553,6 +618,35 @@ ImportPath* package_path_to_import_path(Arena* arena, PackagePath* package_path)
     return import_path;
 }
 
+ImportPath* import_path_expand(Arena* arena, ASTNodeImport* import, PackagePath* current_package) {
+    if (!import) {
+        return NULL;
+    }
+
+    switch (import->type) {
+        case IT_DEFAULT: return import->import_path;
+
+        case IT_LOCAL: {
+            ImportPath* local = package_path_to_import_path(arena, current_package);
+            ImportPath* curr = local;
+            while (curr->type == IPT_DIR && curr->import.dir.child->type == IPT_DIR) {
+                curr = curr->import.dir.child;
+                assert(curr);
+            }
+            curr->import.dir.child = import->import_path;
+            return local;
+        }
+
+        case IT_ROOT: {
+            ImportPath* root = arena_alloc(arena, sizeof *root);
+            root->type = IPT_DIR;
+            root->import.dir.name = current_package->name;
+            root->import.dir.child = import->import_path;
+            return root;
+        }
+    }
+}
+
 bool package_path_eq(PackagePath* p1, PackagePath* p2) {
     if (!p1 || !p2) {
         return !p1 && !p2;
@@ -562,11 +656,7 @@ bool package_path_eq(PackagePath* p1, PackagePath* p2) {
         return false;
     }
 
-    if (p1->name.length != p2->name.length) {
-        return false;
-    }
-
-    if (strncmp(p1->name.chars, p2->name.chars, p1->name.length) != 0) {
+    if (!name_eq(p1->name, p1->symbol, p2->name, p2->symbol)) {
         return false;
     }
 
@@ -577,6 +667,230 @@ bool package_path_eq(PackagePath* p1, PackagePath* p2) {
     }
 }
 
+static void shift_type_ids(Type* const type, size_t const node_offset, size_t const type_offset);
+static void shift_node_ids(ASTNode* const node, size_t const node_offset, size_t const type_offset);
+
+static void shift_typells_ids(LL_Type const types, size_t const node_offset, size_t const type_offset) {
+    for (LLNode_Type* curr = types.head; curr; curr = curr->next) {
+        shift_type_ids(&curr->data, node_offset, type_offset);
+    }
+}
+
+static void shift_nodes_ids(ArrayList_ASTNode const nodes, size_t const node_offset, size_t const type_offset) {
+    for (size_t i = 0; i < nodes.length; ++i) {
+        shift_node_ids(nodes.array + i, node_offset, type_offset);
+    }
+}
+
+static void shift_block_ids(ASTNodeStatementBlock* const block, size_t const node_offset, size_t const type_offset) {
+    if (block) {
+        shift_nodes_ids(block->stmts, node_offset, type_offset);
+    }
+}
+
+static void shift_generic_impls_ids(ArrayList_LL_Type const impls, size_t const node_offset, size_t const type_offset) {
+    for (size_t i = 0; i < impls.length; ++i) {
+        shift_typells_ids(impls.array[i], node_offset, type_offset);
+    }
+}
+
+static void shift_fn_header_ids(ASTNodeFunctionHeaderDecl* const header, size_t const node_offset, size_t const type_offset) {
+    shift_type_ids(&header->return_type, node_offset, type_offset);
+    shift_generic_impls_ids(header->generic_impls, node_offset, type_offset);
+
+    for (LLNode_FnParam* curr = header->params.head; curr; curr = curr->next) {
+        shift_type_ids(&curr->data.type, node_offset, type_offset);
+    }
+}
+
+static void shift_type_ids(Type* const type, size_t const node_offset, size_t const type_offset) {
+    if (!type) {
+        return;
+    }
+
+    type->id.val += type_offset;
+
+    switch (type->kind) {
+        case TK_STATIC_PATH: shift_typells_ids(type->type.static_path.generic_args, node_offset, type_offset); break;
+        case TK_POINTER: shift_type_ids(type->type.ptr.of, node_offset, type_offset); break;
+        case TK_MUT_POINTER: shift_type_ids(type->type.mut_ptr.of, node_offset, type_offset); break;
+        case TK_ARRAY: shift_type_ids(type->type.array.of, node_offset, type_offset); break;
+
+        default: break;
+    }
+}
+
+static void shift_node_ids(ASTNode* const node, size_t const node_offset, size_t const type_offset) {
+    if (!node) {
+        return;
+    }
+
+    node->id.val += node_offset;
+
+    switch (node->type) {
+        case ANT_FILE_ROOT: shift_nodes_ids(node->node.file_root.nodes, node_offset, type_offset); break;
+
+        case ANT_UNARY_OP: shift_node_ids(node->node.unary_op.right, node_offset, type_offset); break;
+        case ANT_POSTFIX_OP: shift_node_ids(node->node.postfix_op.left, node_offset, type_offset); break;
+        case ANT_BINARY_OP: {
+            shift_node_ids(node->node.binary_op.lhs, node_offset, type_offset);
+            shift_node_ids(node->node.binary_op.rhs, node_offset, type_offset);
+            break;
+        }
+
+        case ANT_TUPLE: shift_nodes_ids(node->node.tuple.exprs, node_offset, type_offset); break;
+
+        case ANT_VAR_DECL: {
+            shift_type_ids(node->node.var_decl.type_or_let.maybe_type, node_offset, type_offset);
+            shift_node_ids(node->node.var_decl.initializer, node_offset, type_offset);
+            break;
+        }
+
+        case ANT_GET_FIELD: shift_node_ids(node->node.get_field.root, node_offset, type_offset); break;
+        case ANT_INDEX: {
+            shift_node_ids(node->node.index.root, node_offset, type_offset);
+            shift_node_ids(node->node.index.value, node_offset, type_offset);
+            break;
+        }
+        case ANT_RANGE: {
+            shift_node_ids(node->node.range.lhs, node_offset, type_offset);
+            shift_node_ids(node->node.range.rhs, node_offset, type_offset);
+            break;
+        }
+        case ANT_ASSIGNMENT: {
+            shift_node_ids(node->node.assignment.lhs, node_offset, type_offset);
+            shift_node_ids(node->node.assignment.rhs, node_offset, type_offset);
+            break;
+        }
+        case ANT_FUNCTION_CALL: {
+            shift_node_ids(node->node.function_call.function, node_offset, type_offset);
+            shift_typells_ids(node->node.function_call.generic_args, node_offset, type_offset);
+            shift_nodes_ids(node->node.function_call.args, node_offset, type_offset);
+            break;
+        }
+
+        case ANT_STATEMENT_BLOCK: shift_nodes_ids(node->node.statement_block.stmts, node_offset, type_offset); break;
+        case ANT_IF: {
+            shift_node_ids(node->node.if_.cond, node_offset, type_offset);
+            shift_block_ids(node->node.if_.block, node_offset, type_offset);
+            shift_node_ids(node->node.if_.else_, node_offset, type_offset);
+            break;
+        }
+        case ANT_TRY: shift_node_ids(node->node.try_.target, node_offset, type_offset); break;
+        case ANT_CATCH: {
+            shift_node_ids(node->node.catch_.target, node_offset, type_offset);
+            shift_node_ids(node->node.catch_.then, node_offset, type_offset);
+            break;
+        }
+        case ANT_BREAK: shift_node_ids(node->node.break_.maybe_expr, node_offset, type_offset); break;
+        case ANT_WHILE: {
+            shift_node_ids(node->node.while_.cond, node_offset, type_offset);
+            shift_block_ids(node->node.while_.block, node_offset, type_offset);
+            break;
+        }
+        case ANT_DO_WHILE: {
+            shift_block_ids(node->node.do_while.block, node_offset, type_offset);
+            shift_node_ids(node->node.do_while.cond, node_offset, type_offset);
+            break;
+        }
+        case ANT_FOR: {
+            shift_node_ids(node->node.for_.init, node_offset, type_offset);
+            shift_node_ids(node->node.for_.cond, node_offset, type_offset);
+            shift_node_ids(node->node.for_.step, node_offset, type_offset);
+            shift_block_ids(node->node.for_.block, node_offset, type_offset);
+            break;
+        }
+        case ANT_FOREACH: {
+            shift_node_ids(node->node.foreach.iterable, node_offset, type_offset);
+            shift_block_ids(node->node.foreach.block, node_offset, type_offset);
+            break;
+        }
+        case ANT_RETURN: shift_node_ids(node->node.return_.maybe_expr, node_offset, type_offset); break;
+        case ANT_DEFER: shift_node_ids(node->node.defer.stmt, node_offset, type_offset); break;
+        case ANT_CRASH: shift_node_ids(node->node.crash.maybe_expr, node_offset, type_offset); break;
+
+        case ANT_STRUCT_INIT: {
+            for (LLNode_StructFieldInit* curr = node->node.struct_init.fields.head; curr; curr = curr->next) {
+                shift_node_ids(curr->data.value, node_offset, type_offset);
+            }
+            break;
+        }
+        case ANT_ARRAY_INIT: {
+            shift_node_ids(node->node.array_init.maybe_explicit_length, node_offset, type_offset);
+            for (LLNode_ArrayInitElem* curr = node->node.array_init.elems.head; curr; curr = curr->next) {
+                shift_node_ids(curr->data.maybe_index, node_offset, type_offset);
+                shift_node_ids(curr->data.value, node_offset, type_offset);
+            }
+            break;
+        }
+
+        case ANT_TEMPLATE_STRING: shift_nodes_ids(node->node.template_string.template_expr_parts, node_offset, type_offset); break;
+
+        case ANT_SIZEOF: {
+            if (node->node.sizeof_.kind == SOK_TYPE) {
+                shift_type_ids(node->node.sizeof_.sizeof_.type, node_offset, type_offset);
+            } else {
+                shift_node_ids(node->node.sizeof_.sizeof_.expr, node_offset, type_offset);
+            }
+            break;
+        }
+        case ANT_SWITCH: {
+            shift_node_ids(node->node.switch_.expr, node_offset, type_offset);
+            for (size_t i = 0; i < node->node.switch_.cases_count; ++i) {
+                SwitchCase* const switch_case = node->node.switch_.cases + i;
+                if (switch_case->matches) {
+                    shift_nodes_ids(*switch_case->matches, node_offset, type_offset);
+                }
+                shift_node_ids(switch_case->then, node_offset, type_offset);
+            }
+            shift_node_ids(node->node.switch_.maybe_else, node_offset, type_offset);
+            break;
+        }
+        case ANT_CAST: {
+            shift_type_ids(node->node.cast.type, node_offset, type_offset);
+            shift_node_ids(node->node.cast.target, node_offset, type_offset);
+            break;
+        }
+
+        case ANT_STRUCT_DECL: {
+            for (LLNode_StructField* curr = node->node.struct_decl->fields.head; curr; curr = curr->next) {
+                shift_type_ids(curr->data.type, node_offset, type_offset);
+            }
+            shift_generic_impls_ids(node->node.struct_decl->generic_impls, node_offset, type_offset);
+            break;
+        }
+        case ANT_TYPEDEF_DECL: shift_type_ids(node->node.typedef_decl.type, node_offset, type_offset); break;
+        case ANT_FUNCTION_HEADER_DECL: shift_fn_header_ids(node->node.function_header_decl, node_offset, type_offset); break;
+        case ANT_FUNCTION_DECL: {
+            shift_fn_header_ids(&node->node.function_decl->header, node_offset, type_offset);
+            shift_nodes_ids(node->node.function_decl->stmts, node_offset, type_offset);
+            break;
+        }
+
+        // no ids below these
+        case ANT_NONE:
+        case ANT_FILE_SEPARATOR:
+        case ANT_LITERAL:
+        case ANT_VAR_REF:
+        case ANT_CONTINUE:
+        case ANT_IMPORT:
+        case ANT_PACKAGE:
+        case ANT_UNION_DECL:
+        case ANT_ENUM_DECL:
+        case ANT_GLOBALTAG_DECL:
+        case ANT_COUNT:
+            break;
+    }
+}
+
+void ast_shift_ids(ASTNode* const root, size_t const node_offset, size_t const type_offset) {
+    if (node_offset == 0 && type_offset == 0) {
+        return;
+    }
+
+    shift_node_ids(root, node_offset, type_offset);
+}
+
 static Arena ast_print_arena = {0};
 static Arena* arena = &ast_print_arena;
 
@@ -844,8 +1158,7 @@ void print_astnode(ASTNode const node) {
         }
 
         case ANT_FILE_ROOT: {
-            LL_ASTNode nodes = node.node.file_root.nodes;
-            LLNode_ASTNode* fnode = nodes.head;
+            ArrayList_ASTNode nodes = node.node.file_root.nodes;
 
             typedef enum {
                 BT_OTHER,
@@ -858,31 +1171,31 @@ void print_astnode(ASTNode const node) {
             BlockType curr_block = 0;
             BlockType prev_block = 0;
             bool last_was_ok = true;
-            while (fnode != NULL) {
-                if (fnode->data.type == ANT_NONE) {
+            for (size_t i = 0; i < nodes.length; ++i) {
+                ASTNode const* fnode = nodes.array + i;
+                if (fnode->type == ANT_NONE) {
                     if (last_was_ok) {
                         printf("<Unknown AST Node>\n");
                     }
                     last_was_ok = false;
-                    fnode = fnode->next;
                     continue;
                 }
                 last_was_ok = true;
 
                 //
 
-                print_astnode(fnode->data);
-                fnode = fnode->next;
+                print_astnode(*fnode);
 
-                if (fnode == NULL) {
+                if (i + 1 >= nodes.length) {
                     continue;
                 }
+                fnode = nodes.array + i + 1;
 
-                switch (fnode->data.type) {
+                switch (fnode->type) {
                     case ANT_IMPORT: curr_block = BT_IMPORT; break;
                     case ANT_FUNCTION_HEADER_DECL: curr_block = BT_FUNCTION_DECLS; break;
                     case ANT_VAR_DECL: {
-                        if (fnode->data.node.var_decl.is_static) {
+                        if (fnode->node.var_decl.is_static) {
                             curr_block = BT_STATIC_VARS; break;
                         } else {
                             curr_block = BT_VARS; break;
@@ -938,18 +1251,18 @@ void print_astnode(ASTNode const node) {
         case ANT_STRUCT_DECL: {
             printf("struct ");
 
-            String* m_name = node.node.struct_decl.maybe_name;
+            String* m_name = node.node.struct_decl->maybe_name;
             if (m_name != NULL) {
                 print_string(*m_name);
 
-                if (node.node.struct_decl.generic_params.length > 0) {
+                if (node.node.struct_decl->generic_params.length > 0) {
                     printf("<");
-                    for (size_t i = 0; i < node.node.struct_decl.generic_params.length; ++i) {
+                    for (size_t i = 0; i < node.node.struct_decl->generic_params.length; ++i) {
                         if (i > 0) {
                             printf(", ");
                         }
 
-                        print_string(node.node.struct_decl.generic_params.array[i]);
+                        print_string(node.node.struct_decl->generic_params.array[i]);
                     }
                     printf(">");
                 }
@@ -960,7 +1273,7 @@ void print_astnode(ASTNode const node) {
             printf("{\n");
             indent += 1;
 
-            LLNode_StructField* curr = node.node.struct_decl.fields.head;
+            LLNode_StructField* curr = node.node.struct_decl->fields.head;
             while (curr) {
                 print_tabs();
 
@@ -1003,23 +1316,23 @@ void print_astnode(ASTNode const node) {
         }
 
         case ANT_FUNCTION_HEADER_DECL: {
-            print_type(&node.node.function_header_decl.return_type);
+            print_type(&node.node.function_header_decl->return_type);
             printf(" ");
-            print_string(node.node.function_header_decl.name);
-            if (node.node.function_header_decl.generic_params.length > 0) {
+            print_string(node.node.function_header_decl->name);
+            if (node.node.function_header_decl->generic_params.length > 0) {
                 printf("<");
-                for (size_t i = 0; i < node.node.function_header_decl.generic_params.length; ++i) {
+                for (size_t i = 0; i < node.node.function_header_decl->generic_params.length; ++i) {
                     if (i > 0) {
                         printf(", ");
                     }
 
-                    print_string(node.node.function_header_decl.generic_params.array[i]);
+                    print_string(node.node.function_header_decl->generic_params.array[i]);
                 }
                 printf(">");
             }
             printf("(");
             {
-                LLNode_FnParam* param = node.node.function_header_decl.params.head;
+                LLNode_FnParam* param = node.node.function_header_decl->params.head;
                 while (param != NULL) {
                     print_type(&param->data.type);
                     printf(" ");
@@ -1041,23 +1354,23 @@ void print_astnode(ASTNode const node) {
         }
 
         case ANT_FUNCTION_DECL: {
-            print_type(&node.node.function_decl.header.return_type);
+            print_type(&node.node.function_decl->header.return_type);
             printf(" ");
-            print_string(node.node.function_decl.header.name);
-            if (node.node.function_decl.header.generic_params.length > 0) {
+            print_string(node.node.function_decl->header.name);
+            if (node.node.function_decl->header.generic_params.length > 0) {
                 printf("<");
-                for (size_t i = 0; i < node.node.function_decl.header.generic_params.length; ++i) {
+                for (size_t i = 0; i < node.node.function_decl->header.generic_params.length; ++i) {
                     if (i > 0) {
                         printf(", ");
                     }
 
-                    print_string(node.node.function_decl.header.generic_params.array[i]);
+                    print_string(node.node.function_decl->header.generic_params.array[i]);
                 }
                 printf(">");
             }
             printf("(");
             {
-                LLNode_FnParam* param = node.node.function_decl.header.params.head;
+                LLNode_FnParam* param = node.node.function_decl->header.params.head;
                 while (param != NULL) {
                     print_type(&param->data.type);
                     printf(" ");
@@ -1076,27 +1389,26 @@ void print_astnode(ASTNode const node) {
             printf(") {\n");
             {
                 indent += 1;
-                LLNode_ASTNode* stmt = node.node.function_decl.stmts.head;
-                if (stmt == NULL) {
+                ArrayList_ASTNode const stmts = node.node.function_decl->stmts;
+                if (stmts.length == 0) {
                     printf("    //\n");
                 }
                 bool last_was_ok = true;
-                while (stmt != NULL) {
-                    if (stmt->data.type == ANT_NONE) {
+                for (size_t i = 0; i < stmts.length; ++i) {
+                    ASTNode const* stmt = stmts.array + i;
+                    if (stmt->type == ANT_NONE) {
                         if (last_was_ok) {
                             print_tabs();
                             printf("<Unknown AST Node>\n");
                         }
                         last_was_ok = false;
-                        stmt = stmt->next;
                         continue;
                     }
                     last_was_ok = true;
 
                     print_tabs();
-                    print_astnode(stmt->data);
+                    print_astnode(*stmt);
                     printf(";\n");
-                    stmt = stmt->next;
                 }
                 
                 indent -= 1;
@@ -1122,12 +1434,11 @@ void print_astnode(ASTNode const node) {
             }
             printf("(");
             {
-                LLNode_ASTNode* arg = node.node.function_call.args.head;
-                while (arg != NULL) {
-                    print_astnode(arg->data);
-                    arg = arg->next;
+                ArrayList_ASTNode const args = node.node.function_call.args;
+                for (size_t i = 0; i < args.length; ++i) {
+                    print_astnode(args.array[i]);
 
-                    if (arg != NULL) {
+                    if (i + 1 < args.length) {
                         printf(", ");
                     }
                 }
@@ -1364,12 +1675,11 @@ void print_astnode(ASTNode const node) {
             print_string(node.node.template_string.str_parts.array[0]);
 
             size_t i = 1;
-            LLNode_ASTNode* curr = node.node.template_string.template_expr_parts.head;
-            while (curr) {
-                print_astnode(curr->data);
+            for (size_t j = 0; j < node.node.template_string.template_expr_parts.length; ++j) {
+                ASTNode* curr = node.node.template_string.template_expr_parts.array + j;
+                print_astnode(*curr);
                 print_string(node.node.template_string.str_parts.array[i]);
                 i += 1;
-                curr = curr->next;
             }
 
             break;
@@ -1379,12 +1689,11 @@ void print_astnode(ASTNode const node) {
             printf("while (");
             print_astnode(*node.node.while_.cond);
             printf(") {\n");
-            LLNode_ASTNode* curr = node.node.while_.block->stmts.head;
-            while (curr) {
+            for (size_t i = 0; i < node.node.while_.block->stmts.length; ++i) {
+                ASTNode* curr = node.node.while_.block->stmts.array + i;
                 print_tabs();
-                print_astnode(curr->data);
+                print_astnode(*curr);
                 printf(";\n");
-                curr = curr->next;
             }
             printf("}");
             break;
@@ -1394,12 +1703,11 @@ void print_astnode(ASTNode const node) {
             printf("if (");
             print_astnode(*node.node.if_.cond);
             printf(") {\n");
-            LLNode_ASTNode* curr = node.node.if_.block->stmts.head;
-            while (curr) {
+            for (size_t i = 0; i < node.node.if_.block->stmts.length; ++i) {
+                ASTNode* curr = node.node.if_.block->stmts.array + i;
                 print_tabs();
-                print_astnode(curr->data);
+                print_astnode(*curr);
                 printf(";\n");
-                curr = curr->next;
             }
             printf("}");
             if (node.node.if_.else_) {
@@ -1411,12 +1719,11 @@ void print_astnode(ASTNode const node) {
 
         case ANT_STATEMENT_BLOCK: {
             printf("{\n");
-            LLNode_ASTNode* curr = node.node.statement_block.stmts.head;
-            while (curr) {
+            for (size_t i = 0; i < node.node.statement_block.stmts.length; ++i) {
+                ASTNode* curr = node.node.statement_block.stmts.array + i;
                 print_tabs();
-                print_astnode(curr->data);
+                print_astnode(*curr);
                 printf(";\n");
-                curr = curr->next;
             }
             printf("{");
             break;
@@ -1424,11 +1731,10 @@ void print_astnode(ASTNode const node) {
 
         case ANT_TUPLE: {
             printf("(");
-            LLNode_ASTNode* curr = node.node.tuple.exprs.head;
-            while (curr) {
-                print_astnode(curr->data);
-                curr = curr->next;
-                if (curr) {
+            ArrayList_ASTNode const exprs = node.node.tuple.exprs;
+            for (size_t i = 0; i < exprs.length; ++i) {
+                print_astnode(exprs.array[i]);
+                if (i + 1 < exprs.length) {
                     printf(", ");
                 }
             }
@@ -1466,12 +1772,11 @@ void print_astnode(ASTNode const node) {
             print_astnode(*node.node.foreach.iterable);
             printf(" {\n");
 
-            LLNode_ASTNode* curr = node.node.foreach.block->stmts.head;
-            while (curr) {
+            for (size_t i = 0; i < node.node.foreach.block->stmts.length; ++i) {
+                ASTNode* curr = node.node.foreach.block->stmts.array + i;
                 print_tabs();
-                print_astnode(curr->data);
+                print_astnode(*curr);
                 printf(";\n");
-                curr = curr->next;
             }
             printf("}");
             break;
@@ -12,11 +12,12 @@ typedef struct {
     size_t length;
 } TokensSlice;
 
+// children are stored contiguously, so walking a block is a linear scan
 typedef struct {
+    size_t capacity;
     size_t length;
-    struct LLNode_ASTNode* head;
-    struct LLNode_ASTNode* tail;
-} LL_ASTNode;
+    struct ASTNode* array;
+} ArrayList_ASTNode;
 
 typedef struct {
     size_t length;
@@ -63,6 +64,7 @@ typedef struct {
 
 typedef struct StaticPath_s {
     String name;
+    Symbol symbol;
     struct StaticPath_s* child;
 } StaticPath;
 
@@ -175,7 +177,7 @@ typedef enum {
 //
 
 typedef struct {
-    LL_ASTNode nodes;
+    ArrayList_ASTNode nodes;
 } ASTNodeFileRoot;
 
 //
@@ -278,7 +280,7 @@ typedef struct {
 //
 
 typedef struct {
-    LL_ASTNode exprs;
+    ArrayList_ASTNode exprs;
 } ASTNodeTuple;
 
 //
@@ -371,13 +373,13 @@ typedef struct {
     struct ASTNode* function;
     LL_Type generic_args;
     size_t impl_version;
-    LL_ASTNode args;
+    ArrayList_ASTNode args;
 } ASTNodeFunctionCall;
 
 //
 
 typedef struct {
-    LL_ASTNode stmts;
+    ArrayList_ASTNode stmts;
 } ASTNodeStatementBlock;
 
 //
@@ -533,6 +535,7 @@ typedef struct {
 
 typedef struct PackagePath_s {
     String name;
+    Symbol symbol;
     struct PackagePath_s* child;
 } PackagePath;
 
@@ -544,7 +547,7 @@ typedef struct {
 
 typedef struct {
     ArrayList_String str_parts;
-    LL_ASTNode template_expr_parts;
+    ArrayList_ASTNode template_expr_parts;
 } ASTNodeTemplateString;
 
 //
@@ -571,7 +574,7 @@ typedef struct {
 //
 
 typedef struct {
-    LL_ASTNode* matches;
+    ArrayList_ASTNode* matches;
 
     struct ASTNode* then;
 } SwitchCase;
@@ -597,6 +600,7 @@ typedef struct {
 typedef struct {
     Type* type;
     String name;
+    Symbol symbol;
 } StructField;
 
 typedef struct {
@@ -640,6 +644,7 @@ typedef struct {
     Type type;
     bool is_mut;
     String name;
+    Symbol symbol;
 } FnParam;
 
 typedef struct {
@@ -653,7 +658,7 @@ typedef struct {
 
 typedef struct {
     ASTNodeFunctionHeaderDecl header;
-    LL_ASTNode stmts;
+    ArrayList_ASTNode stmts;
 } ASTNodeFunctionDecl;
 
 //
@@ -696,13 +701,14 @@ typedef struct ASTNode {
         ASTNodeSizeof sizeof_;
         ASTNodeSwitch switch_;
         ASTNodeCast cast;
-        ASTNodeStructDecl struct_decl;
+        // (large decl payloads live out-of-line to keep every node small)
+        ASTNodeStructDecl* struct_decl;
         ASTNodeUnionDecl union_decl;
         ASTNodeEnumDecl enum_decl;
         ASTNodeTypedefDecl typedef_decl;
         ASTNodeGlobaltagDecl globaltag_decl;
-        ASTNodeFunctionHeaderDecl function_header_decl;
-        ASTNodeFunctionDecl function_decl;
+        ASTNodeFunctionHeaderDecl* function_header_decl;
+        ASTNodeFunctionDecl* function_decl;
         ASTNodeAssignment assignment;
     } node;
     LL_Directive directives;
@@ -748,11 +754,6 @@ typedef struct {
     } dir;
 } Directive;
 
-typedef struct LLNode_ASTNode {
-    struct LLNode_ASTNode* next;
-    ASTNode data;
-} LLNode_ASTNode;
-
 typedef struct LLNode_Directive {
     struct LLNode_Directive* next;
     Directive data;
@@ -793,7 +794,7 @@ typedef struct {
 
 
 
-void ll_ast_push(Arena* const arena, LL_ASTNode* const ll, ASTNode const node);
+void arraylist_ast_push(Arena* const arena, ArrayList_ASTNode* const list, ASTNode const node);
 void ll_directive_push(Arena* const arena, LL_Directive* const ll, Directive const directive);
 void ll_param_push(Arena* const arena, LL_FnParam* const ll, FnParam const param);
 void ll_field_push(Arena* const arena, LL_StructField* const ll, StructField const field);
@@ -814,8 +815,23 @@ bool directive_eq(Directive a, Directive b);
 bool directivells_eq(LL_Directive a, LL_Directive b);
 bool typells_eq(LL_Type a, LL_Type b);
 
-ASTNode* find_decl_by_id(ASTNodeFileRoot, NodeId id);
-ASTNode* find_decl_by_name(ASTNodeFileRoot root, String name);
+// Top-level decls of a file, found by name or by node id without walking the file.
+typedef struct {
+    ASTNode* nodes;
+
+    // open-addressed, linear probing: index into nodes + 1, 0 for empty
+    size_t capacity;
+    size_t* by_symbol;
+    Symbol* symbols;
+    size_t* by_id;
+} DeclIndex;
+
+// ids must be final, as decls are placed by their node id
+DeclIndex decl_index_create(Arena* arena, ASTNodeFileRoot root);
+
+ASTNode* decl_index_by_id(DeclIndex const* index, NodeId id);
+ASTNode* decl_index_by_symbol(DeclIndex const* index, Symbol symbol);
+ASTNode* decl_index_by_name(DeclIndex const* index, String name);
 
 String static_path_to_str(Arena* arena, StaticPath* path);
 StringBuffer static_path_to_strbuf(Arena* arena, StaticPath* path);
@@ -829,8 +845,14 @@ StringBuffer import_path_to_strbuf(Arena* arena, ImportPath* path);
 PackagePath* import_path_to_package_path(Arena* arena, ImportPath* import_path);
 ImportPath* package_path_to_import_path(Arena* arena, PackagePath* package_path);
 
+// the full path of an import, with `./` and `~/` imports relative to the importing package
+ImportPath* import_path_expand(Arena* arena, ASTNodeImport* import, PackagePath* current_package);
+
 bool package_path_eq(PackagePath* p1, PackagePath* p2);
 
+// adds the offsets to every NodeId/TypeId under root, for ASTs parsed with ids starting at 0
+void ast_shift_ids(ASTNode* const root, size_t const node_offset, size_t const type_offset);
+
 void print_astnode(ASTNode const node);
 void println_astnode(ASTNode const node);
 
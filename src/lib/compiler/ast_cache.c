@@ -0,0 +1,1202 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./ast_cache.h"
+#include "./ast.h"
+#include "./package.h"
+
+#define INITIAL_BYTES_CAPACITY 4096
+#define AST_CACHE_EXTENSION ".qlast"
+
+// Every field is written as a u64, so a reader can't step out of alignment on a bad file.
+typedef struct {
+    Arena* arena;
+    size_t capacity;
+    size_t length;
+    char* bytes;
+} Bytes;
+
+typedef struct {
+    Bytes data;
+    Bytes strings;
+} Writer;
+
+typedef struct {
+    Arena* arena;
+
+    char const* data;
+    size_t data_length;
+    size_t cursor;
+
+    char* strings;
+    size_t strings_length;
+
+    bool uses_string_templates;
+
+    // set on the first out of bounds read or unknown tag
+    bool ok;
+} Reader;
+
+static void bytes_append(Bytes* bytes, void const* src, size_t length) {
+    if (bytes->length + length > bytes->capacity) {
+        size_t capacity = bytes->capacity > 0 ? bytes->capacity : INITIAL_BYTES_CAPACITY;
+        while (bytes->length + length > capacity) {
+            capacity *= 2;
+        }
+        bytes->bytes = arena_realloc(bytes->arena, bytes->bytes, bytes->capacity, capacity);
+        bytes->capacity = capacity;
+    }
+
+    memcpy(bytes->bytes + bytes->length, src, length);
+    bytes->length += length;
+}
+
+static void put_u64(Writer* w, uint64_t value) {
+    bytes_append(&w->data, &value, sizeof value);
+}
+
+static void put_bool(Writer* w, bool value) {
+    put_u64(w, value ? 1 : 0);
+}
+
+static void put_str(Writer* w, String str) {
+    put_u64(w, w->strings.length);
+    put_u64(w, str.length);
+    if (str.length > 0) {
+        bytes_append(&w->strings, str.chars, str.length);
+    }
+}
+
+static uint64_t get_u64(Reader* r) {
+    uint64_t value = 0;
+    if (!r->ok || r->data_length - r->cursor < sizeof value) {
+        r->ok = false;
+        return 0;
+    }
+
+    memcpy(&value, r->data + r->cursor, sizeof value);
+    r->cursor += sizeof value;
+    return value;
+}
+
+static bool get_bool(Reader* r) {
+    return get_u64(r) != 0;
+}
+
+// a length of things that each take at least one u64, so a bad file can't ask for a huge allocation
+static size_t get_length(Reader* r) {
+    uint64_t length = get_u64(r);
+    if (length > (r->data_length - r->cursor) / sizeof(uint64_t)) {
+        r->ok = false;
+        return 0;
+    }
+    return length;
+}
+
+static String get_str(Reader* r) {
+    uint64_t offset = get_u64(r);
+    uint64_t length = get_u64(r);
+    if (!r->ok || offset > r->strings_length || length > r->strings_length - offset) {
+        r->ok = false;
+        return (String){ .length = 0, .chars = NULL };
+    }
+    return (String){ .length = length, .chars = r->strings + offset };
+}
+
+static uint64_t get_tag(Reader* r, uint64_t count) {
+    uint64_t tag = get_u64(r);
+    if (tag >= count) {
+        r->ok = false;
+        return 0;
+    }
+    return tag;
+}
+
+// writing
+
+static void write_type(Writer* w, Type const* type);
+static void write_node(Writer* w, ASTNode const* node);
+
+static void write_maybe_node(Writer* w, ASTNode const* node) {
+    put_bool(w, node != NULL);
+    if (node) {
+        write_node(w, node);
+    }
+}
+
+static void write_nodes(Writer* w, ArrayList_ASTNode const nodes) {
+    put_u64(w, nodes.length);
+    for (size_t i = 0; i < nodes.length; ++i) {
+        write_node(w, nodes.array + i);
+    }
+}
+
+static void write_maybe_block(Writer* w, ASTNodeStatementBlock const* block) {
+    put_bool(w, block != NULL);
+    if (block) {
+        write_nodes(w, block->stmts);
+    }
+}
+
+static void write_maybe_type(Writer* w, Type const* type) {
+    put_bool(w, type != NULL);
+    if (type) {
+        write_type(w, type);
+    }
+}
+
+static void write_strings(Writer* w, ArrayList_String const strings) {
+    put_u64(w, strings.length);
+    for (size_t i = 0; i < strings.length; ++i) {
+        put_str(w, strings.array[i]);
+    }
+}
+
+static void write_directives(Writer* w, LL_Directive const directives) {
+    put_u64(w, directives.length);
+    for (LLNode_Directive* curr = directives.head; curr; curr = curr->next) {
+        put_u64(w, curr->data.type);
+        if (curr->data.type == DT_C_HEADER) {
+            put_str(w, curr->data.dir.c_header.include);
+        }
+    }
+}
+
+static void write_typells(Writer* w, LL_Type const types) {
+    put_u64(w, types.length);
+    for (LLNode_Type* curr = types.head; curr; curr = curr->next) {
+        write_type(w, &curr->data);
+    }
+}
+
+static void write_generic_impls(Writer* w, ArrayList_LL_Type const impls) {
+    put_u64(w, impls.length);
+    for (size_t i = 0; i < impls.length; ++i) {
+        write_typells(w, impls.array[i]);
+    }
+}
+
+static void write_static_path(Writer* w, StaticPath const* path) {
+    size_t length = 0;
+    for (StaticPath const* curr = path; curr; curr = curr->child) {
+        length += 1;
+    }
+
+    put_u64(w, length);
+    for (StaticPath const* curr = path; curr; curr = curr->child) {
+        put_str(w, curr->name);
+        put_bool(w, curr->symbol != SYMBOL_NONE);
+    }
+}
+
+static void write_package_path(Writer* w, PackagePath const* path) {
+    size_t length = 0;
+    for (PackagePath const* curr = path; curr; curr = curr->child) {
+        length += 1;
+    }
+
+    put_u64(w, length);
+    for (PackagePath const* curr = path; curr; curr = curr->child) {
+        put_str(w, curr->name);
+        put_bool(w, curr->symbol != SYMBOL_NONE);
+    }
+}
+
+static void write_import_static_path(Writer* w, ImportStaticPath const* path) {
+    put_bool(w, path != NULL);
+    if (!path) {
+        return;
+    }
+
+    put_u64(w, path->type);
+    if (path->type == ISPT_IDENT) {
+        put_str(w, path->import.ident.name);
+        write_import_static_path(w, path->import.ident.child);
+    }
+}
+
+static void write_import_path(Writer* w, ImportPath const* path) {
+    put_bool(w, path != NULL);
+    if (!path) {
+        return;
+    }
+
+    put_u64(w, path->type);
+    if (path->type == IPT_DIR) {
+        put_str(w, path->import.dir.name);
+        write_import_path(w, path->import.dir.child);
+    } else {
+        put_str(w, path->import.file.name);
+        write_import_static_path(w, path->import.file.child);
+    }
+}
+
+static void write_token(Writer* w, Token const* token) {
+    put_bool(w, token != NULL);
+    if (token) {
+        put_u64(w, token->type);
+        put_bool(w, token->symbol != SYMBOL_NONE);
+        put_str(w, (String){ .length = token->length, .chars = token->start });
+        put_u64(w, token->line);
+    }
+}
+
+static void write_var_decl_lhs(Writer* w, VarDeclLHS const lhs) {
+    put_u64(w, lhs.type);
+    put_u64(w, lhs.count);
+    if (lhs.type == VDLT_NAME) {
+        put_str(w, lhs.lhs.name);
+    } else {
+        for (size_t i = 0; i < lhs.count; ++i) {
+            put_str(w, lhs.lhs.tuple_names[i]);
+        }
+    }
+}
+
+static void write_fn_header(Writer* w, ASTNodeFunctionHeaderDecl const* header) {
+    write_type(w, &header->return_type);
+    put_str(w, header->name);
+    write_strings(w, header->generic_params);
+    write_generic_impls(w, header->generic_impls);
+
+    put_u64(w, header->params.length);
+    for (LLNode_FnParam* curr = header->params.head; curr; curr = curr->next) {
+        write_type(w, &curr->data.type);
+        put_bool(w, curr->data.is_mut);
+        put_str(w, curr->data.name);
+        put_bool(w, curr->data.symbol != SYMBOL_NONE);
+    }
+
+    put_bool(w, header->is_main);
+}
+
+static void write_type(Writer* w, Type const* type) {
+    put_u64(w, type->id.val);
+    put_u64(w, type->kind);
+
+    switch (type->kind) {
+        case TK_BUILT_IN: put_u64(w, type->type.built_in); break;
+        case TK_STATIC_PATH: {
+            write_static_path(w, type->type.static_path.path);
+            write_typells(w, type->type.static_path.generic_args);
+            put_u64(w, type->type.static_path.impl_version);
+            break;
+        }
+        case TK_POINTER: write_maybe_type(w, type->type.ptr.of); break;
+        case TK_MUT_POINTER: write_maybe_type(w, type->type.mut_ptr.of); break;
+        case TK_ARRAY: {
+            write_token(w, type->type.array.explicit_size);
+            write_maybe_type(w, type->type.array.of);
+            break;
+        }
+
+        default: break;
+    }
+
+    write_directives(w, type->directives);
+}
+
+static void write_node(Writer* w, ASTNode const* node) {
+    put_u64(w, node->id.val);
+    put_u64(w, node->type);
+
+    switch (node->type) {
+        case ANT_FILE_ROOT: write_nodes(w, node->node.file_root.nodes); break;
+
+        case ANT_UNARY_OP: {
+            put_u64(w, node->node.unary_op.op);
+            write_maybe_node(w, node->node.unary_op.right);
+            break;
+        }
+        case ANT_BINARY_OP: {
+            put_u64(w, node->node.binary_op.op);
+            write_maybe_node(w, node->node.binary_op.lhs);
+            write_maybe_node(w, node->node.binary_op.rhs);
+            break;
+        }
+        case ANT_POSTFIX_OP: {
+            write_maybe_node(w, node->node.postfix_op.left);
+            put_u64(w, node->node.postfix_op.op);
+            break;
+        }
+
+        case ANT_LITERAL: {
+            ASTNodeLiteral const* literal = &node->node.literal;
+            put_u64(w, literal->kind);
+            switch (literal->kind) {
+                case LK_BOOL: put_bool(w, literal->value.lit_bool); break;
+                case LK_INT: put_u64(w, literal->value.lit_int); break;
+                case LK_FLOAT: {
+                    uint64_t bits;
+                    memcpy(&bits, &literal->value.lit_float, sizeof bits);
+                    put_u64(w, bits);
+                    break;
+                }
+                case LK_STR: put_str(w, literal->value.lit_str); break;
+                case LK_CHAR: put_str(w, literal->value.lit_char); break;
+                case LK_CHARS: put_str(w, literal->value.lit_chars); break;
+                default: break;
+            }
+            break;
+        }
+
+        case ANT_TUPLE: write_nodes(w, node->node.tuple.exprs); break;
+
+        case ANT_VAR_DECL: {
+            put_bool(w, node->node.var_decl.is_static);
+            put_bool(w, node->node.var_decl.type_or_let.is_let);
+            put_bool(w, node->node.var_decl.type_or_let.is_mut);
+            write_maybe_type(w, node->node.var_decl.type_or_let.maybe_type);
+            write_var_decl_lhs(w, node->node.var_decl.lhs);
+            write_maybe_node(w, node->node.var_decl.initializer);
+            break;
+        }
+        case ANT_VAR_REF: write_static_path(w, node->node.var_ref.path); break;
+
+        case ANT_GET_FIELD: {
+            write_maybe_node(w, node->node.get_field.root);
+            put_bool(w, node->node.get_field.is_ptr_deref);
+            put_str(w, node->node.get_field.name);
+            break;
+        }
+        case ANT_INDEX: {
+            write_maybe_node(w, node->node.index.root);
+            write_maybe_node(w, node->node.index.value);
+            break;
+        }
+        case ANT_RANGE: {
+            write_maybe_node(w, node->node.range.lhs);
+            write_maybe_node(w, node->node.range.rhs);
+            put_bool(w, node->node.range.inclusive);
+            break;
+        }
+        case ANT_ASSIGNMENT: {
+            put_u64(w, node->node.assignment.op);
+            write_maybe_node(w, node->node.assignment.lhs);
+            write_maybe_node(w, node->node.assignment.rhs);
+            break;
+        }
+        case ANT_FUNCTION_CALL: {
+            write_maybe_node(w, node->node.function_call.function);
+            write_typells(w, node->node.function_call.generic_args);
+            put_u64(w, node->node.function_call.impl_version);
+            write_nodes(w, node->node.function_call.args);
+            break;
+        }
+
+        case ANT_STATEMENT_BLOCK: write_nodes(w, node->node.statement_block.stmts); break;
+        case ANT_IF: {
+            write_maybe_node(w, node->node.if_.cond);
+            write_maybe_block(w, node->node.if_.block);
+            write_maybe_node(w, node->node.if_.else_);
+            break;
+        }
+        case ANT_TRY: write_maybe_node(w, node->node.try_.target); break;
+        case ANT_CATCH: {
+            write_maybe_node(w, node->node.catch_.target);
+            put_str(w, node->node.catch_.error);
+            write_maybe_node(w, node->node.catch_.then);
+            break;
+        }
+        case ANT_BREAK: write_maybe_node(w, node->node.break_.maybe_expr); break;
+        case ANT_WHILE: {
+            write_maybe_node(w, node->node.while_.cond);
+            write_maybe_block(w, node->node.while_.block);
+            break;
+        }
+        case ANT_DO_WHILE: {
+            write_maybe_block(w, node->node.do_while.block);
+            write_maybe_node(w, node->node.do_while.cond);
+            break;
+        }
+        case ANT_FOR: {
+            write_maybe_node(w, node->node.for_.init);
+            write_maybe_node(w, node->node.for_.cond);
+            write_maybe_node(w, node->node.for_.step);
+            write_maybe_block(w, node->node.for_.block);
+            break;
+        }
+        case ANT_FOREACH: {
+            write_var_decl_lhs(w, node->node.foreach.var);
+            write_maybe_node(w, node->node.foreach.iterable);
+            write_maybe_block(w, node->node.foreach.block);
+            break;
+        }
+        case ANT_RETURN: write_maybe_node(w, node->node.return_.maybe_expr); break;
+        case ANT_DEFER: write_maybe_node(w, node->node.defer.stmt); break;
+        case ANT_CRASH: write_maybe_node(w, node->node.crash.maybe_expr); break;
+
+        case ANT_STRUCT_INIT: {
+            put_u64(w, node->node.struct_init.fields.length);
+            for (LLNode_StructFieldInit* curr = node->node.struct_init.fields.head; curr; curr = curr->next) {
+                put_str(w, curr->data.name);
+                write_maybe_node(w, curr->data.value);
+            }
+            break;
+        }
+        case ANT_ARRAY_INIT: {
+            write_maybe_node(w, node->node.array_init.maybe_explicit_length);
+            put_u64(w, node->node.array_init.elems.length);
+            for (LLNode_ArrayInitElem* curr = node->node.array_init.elems.head; curr; curr = curr->next) {
+                write_maybe_node(w, curr->data.maybe_index);
+                write_maybe_node(w, curr->data.value);
+            }
+            break;
+        }
+
+        case ANT_IMPORT: {
+            put_u64(w, node->node.import.type);
+            write_import_path(w, node->node.import.import_path);
+            break;
+        }
+        case ANT_PACKAGE: write_package_path(w, node->node.package.package_path); break;
+
+        case ANT_TEMPLATE_STRING: {
+            write_strings(w, node->node.template_string.str_parts);
+            write_nodes(w, node->node.template_string.template_expr_parts);
+            break;
+        }
+
+        case ANT_SIZEOF: {
+            put_u64(w, node->node.sizeof_.kind);
+            if (node->node.sizeof_.kind == SOK_TYPE) {
+                write_maybe_type(w, node->node.sizeof_.sizeof_.type);
+            } else {
+                write_maybe_node(w, node->node.sizeof_.sizeof_.expr);
+            }
+            break;
+        }
+        case ANT_SWITCH: {
+            write_maybe_node(w, node->node.switch_.expr);
+            put_u64(w, node->node.switch_.cases_count);
+            for (size_t i = 0; i < node->node.switch_.cases_count; ++i) {
+                SwitchCase const* switch_case = node->node.switch_.cases + i;
+                put_bool(w, switch_case->matches != NULL);
+                if (switch_case->matches) {
+                    write_nodes(w, *switch_case->matches);
+                }
+                write_maybe_node(w, switch_case->then);
+            }
+            write_maybe_node(w, node->node.switch_.maybe_else);
+            break;
+        }
+        case ANT_CAST: {
+            write_maybe_type(w, node->node.cast.type);
+            write_maybe_node(w, node->node.cast.target);
+            break;
+        }
+
+        case ANT_STRUCT_DECL: {
+            ASTNodeStructDecl const* decl = node->node.struct_decl;
+            put_bool(w, decl->maybe_name != NULL);
+            if (decl->maybe_name) {
+                put_str(w, *decl->maybe_name);
+            }
+
+            put_u64(w, decl->fields.length);
+            for (LLNode_StructField* curr = decl->fields.head; curr; curr = curr->next) {
+                write_maybe_type(w, curr->data.type);
+                put_str(w, curr->data.name);
+                put_bool(w, curr->data.symbol != SYMBOL_NONE);
+            }
+
+            write_strings(w, decl->generic_params);
+            write_generic_impls(w, decl->generic_impls);
+            break;
+        }
+        case ANT_UNION_DECL: {
+            put_bool(w, node->node.union_decl.maybe_name != NULL);
+            if (node->node.union_decl.maybe_name) {
+                put_str(w, *node->node.union_decl.maybe_name);
+            }
+            break;
+        }
+        case ANT_ENUM_DECL: put_str(w, node->node.enum_decl.name); break;
+        case ANT_TYPEDEF_DECL: {
+            put_str(w, node->node.typedef_decl.name);
+            write_maybe_type(w, node->node.typedef_decl.type);
+            break;
+        }
+        case ANT_GLOBALTAG_DECL: {
+            put_bool(w, node->node.globaltag_decl.maybe_name != NULL);
+            if (node->node.globaltag_decl.maybe_name) {
+                put_str(w, *node->node.globaltag_decl.maybe_name);
+            }
+            break;
+        }
+        case ANT_FUNCTION_HEADER_DECL: write_fn_header(w, node->node.function_header_decl); break;
+        case ANT_FUNCTION_DECL: {
+            write_fn_header(w, &node->node.function_decl->header);
+            write_nodes(w, node->node.function_decl->stmts);
+            break;
+        }
+
+        // nothing below these
+        case ANT_NONE:
+        case ANT_FILE_SEPARATOR:
+        case ANT_CONTINUE:
+        case ANT_COUNT:
+            break;
+    }
+
+    write_directives(w, node->directives);
+}
+
+String ast_cache_path(Arena* arena, String dir, String source_path) {
+    // named by the source path, so an edited file overwrites its stale cache file
+    char name[sizeof "0123456789abcdef" AST_CACHE_EXTENSION];
+    snprintf(name, sizeof name, "%016llx" AST_CACHE_EXTENSION,
+        (unsigned long long)fingerprint_chars(FNV_OFFSET_BASIS, source_path)
+    );
+
+    StringBuffer sb = strbuf_create(arena);
+    strbuf_append_str(&sb, dir);
+    strbuf_append_char(&sb, '/');
+    strbuf_append_chars(&sb, name);
+    return strbuf_to_strcpy(sb);
+}
+
+void ast_cache_write(Arena* arena, String path, uint64_t source_hash, ParsedSource const* source) {
+    assert(source->ast);
+    assert(source->ast->type == ANT_FILE_ROOT);
+
+    Writer w = {
+        .data = { .arena = arena, .capacity = 0, .length = 0, .bytes = NULL },
+        .strings = { .arena = arena, .capacity = 0, .length = 0, .bytes = NULL },
+    };
+    write_node(&w, source->ast);
+
+    ASTCacheHeader header = {
+        .magic = AST_CACHE_MAGIC,
+        .format_version = AST_CACHE_FORMAT_VERSION,
+        .source_hash = source_hash,
+
+        .node_ids_length = source->node_ids_length,
+        .type_ids_length = source->type_ids_length,
+
+        .data_offset = sizeof header,
+        .data_length = w.data.length,
+        .strings_offset = sizeof header + w.data.length,
+        .strings_length = w.strings.length,
+    };
+
+    // written aside and renamed over, so a reader never maps a partial file
+    StringBuffer sb = strbuf_create(arena);
+    strbuf_append_str(&sb, path);
+    strbuf_append_chars(&sb, ".tmp");
+    String tmp_path = strbuf_to_strcpy(sb);
+
+    FILE* file = fopen(tmp_path.chars, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open file \"%s\".\n", tmp_path.chars);
+        return;
+    }
+
+    bool written = fwrite(&header, sizeof header, 1, file) == 1
+        && fwrite(w.data.bytes, 1, w.data.length, file) == w.data.length
+        && fwrite(w.strings.bytes, 1, w.strings.length, file) == w.strings.length;
+    fclose(file);
+
+    if (!written || rename(tmp_path.chars, path.chars) != 0) {
+        fprintf(stderr, "Could not write AST cache \"%s\".\n", path.chars);
+        remove(tmp_path.chars);
+    }
+}
+
+// reading
+
+static void read_type(Reader* r, Type* out);
+static void read_node(Reader* r, ASTNode* out);
+
+static ASTNode* read_maybe_node(Reader* r) {
+    if (!get_bool(r)) {
+        return NULL;
+    }
+
+    ASTNode* node = arena_alloc(r->arena, sizeof *node);
+    read_node(r, node);
+    return node;
+}
+
+static ArrayList_ASTNode read_nodes(Reader* r) {
+    size_t length = get_length(r);
+
+    ArrayList_ASTNode nodes = {
+        .capacity = length,
+        .length = length,
+        .array = length > 0 ? arena_calloc(r->arena, length, sizeof(ASTNode)) : NULL,
+    };
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        read_node(r, nodes.array + i);
+    }
+    return nodes;
+}
+
+static ASTNodeStatementBlock* read_maybe_block(Reader* r) {
+    if (!get_bool(r)) {
+        return NULL;
+    }
+
+    ASTNodeStatementBlock* block = arena_alloc(r->arena, sizeof *block);
+    block->stmts = read_nodes(r);
+    return block;
+}
+
+static Type* read_maybe_type(Reader* r) {
+    if (!get_bool(r)) {
+        return NULL;
+    }
+
+    Type* type = arena_alloc(r->arena, sizeof *type);
+    read_type(r, type);
+    return type;
+}
+
+static ArrayList_String read_strings(Reader* r) {
+    size_t length = get_length(r);
+
+    ArrayList_String strings = arraylist_string_create_with_capacity(r->arena, length > 0 ? length : 1);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        arraylist_string_push(&strings, get_str(r));
+    }
+    return strings;
+}
+
+static LL_Directive read_directives(Reader* r) {
+    LL_Directive directives = {0};
+
+    size_t length = get_length(r);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        Directive directive = { .type = get_tag(r, DT_RANGE_LITERAL + 1) };
+        if (directive.type == DT_C_HEADER) {
+            directive.dir.c_header.include = get_str(r);
+        }
+        ll_directive_push(r->arena, &directives, directive);
+    }
+    return directives;
+}
+
+static LL_Type read_typells(Reader* r) {
+    LL_Type types = {0};
+
+    size_t length = get_length(r);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        Type type = {0};
+        read_type(r, &type);
+        ll_type_push(r->arena, &types, type);
+    }
+    return types;
+}
+
+static ArrayList_LL_Type read_generic_impls(Reader* r) {
+    size_t length = get_length(r);
+
+    ArrayList_LL_Type impls = arraylist_typells_create_with_capacity(r->arena, length > 0 ? length : 1);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        arraylist_typells_push(&impls, read_typells(r));
+    }
+    return impls;
+}
+
+static Symbol read_symbol(Reader* r, String name) {
+    return get_bool(r) ? intern(name) : SYMBOL_NONE;
+}
+
+static StaticPath* read_static_path(Reader* r) {
+    StaticPath* head = NULL;
+    StaticPath** tail = &head;
+
+    size_t length = get_length(r);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        StaticPath* path = arena_alloc(r->arena, sizeof *path);
+        path->name = get_str(r);
+        path->symbol = read_symbol(r, path->name);
+        path->child = NULL;
+
+        *tail = path;
+        tail = &path->child;
+    }
+    return head;
+}
+
+static PackagePath* read_package_path(Reader* r) {
+    PackagePath* head = NULL;
+    PackagePath** tail = &head;
+
+    size_t length = get_length(r);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        PackagePath* path = arena_alloc(r->arena, sizeof *path);
+        path->name = get_str(r);
+        path->symbol = read_symbol(r, path->name);
+        path->child = NULL;
+
+        *tail = path;
+        tail = &path->child;
+    }
+    return head;
+}
+
+static ImportStaticPath* read_import_static_path(Reader* r) {
+    if (!get_bool(r)) {
+        return NULL;
+    }
+
+    ImportStaticPath* path = arena_alloc(r->arena, sizeof *path);
+    path->type = get_tag(r, ISPT_IDENT + 1);
+    if (path->type == ISPT_IDENT) {
+        path->import.ident.name = get_str(r);
+        path->import.ident.child = r->ok ? read_import_static_path(r) : NULL;
+    } else {
+        path->import.wildcard = NULL;
+    }
+    return path;
+}
+
+static ImportPath* read_import_path(Reader* r) {
+    if (!get_bool(r)) {
+        return NULL;
+    }
+
+    ImportPath* path = arena_alloc(r->arena, sizeof *path);
+    path->type = get_tag(r, IPT_FILE + 1);
+    if (path->type == IPT_DIR) {
+        path->import.dir.name = get_str(r);
+        path->import.dir.child = r->ok ? read_import_path(r) : NULL;
+    } else {
+        path->import.file.name = get_str(r);
+        path->import.file.child = r->ok ? read_import_static_path(r) : NULL;
+    }
+    return path;
+}
+
+static Token* read_token(Reader* r) {
+    if (!get_bool(r)) {
+        return NULL;
+    }
+
+    Token* token = arena_alloc(r->arena, sizeof *token);
+    token->type = get_tag(r, TT_COUNT);
+    bool has_symbol = get_bool(r);
+    String lexeme = get_str(r);
+    token->start = lexeme.chars;
+    token->length = lexeme.length;
+    token->symbol = has_symbol ? intern(lexeme) : SYMBOL_NONE;
+    token->line = get_u64(r);
+    return token;
+}
+
+static VarDeclLHS read_var_decl_lhs(Reader* r) {
+    VarDeclLHS lhs = {
+        .type = get_tag(r, VDLT_COUNT),
+        .count = get_length(r),
+    };
+    if (lhs.type == VDLT_NAME) {
+        lhs.lhs.name = get_str(r);
+    } else {
+        lhs.lhs.tuple_names = arena_calloc(r->arena, lhs.count > 0 ? lhs.count : 1, sizeof(String));
+        for (size_t i = 0; i < lhs.count && r->ok; ++i) {
+            lhs.lhs.tuple_names[i] = get_str(r);
+        }
+    }
+    return lhs;
+}
+
+static void read_fn_header(Reader* r, ASTNodeFunctionHeaderDecl* out) {
+    read_type(r, &out->return_type);
+    out->name = get_str(r);
+    out->generic_params = read_strings(r);
+    out->generic_impls = read_generic_impls(r);
+
+    out->params = (LL_FnParam){0};
+    size_t length = get_length(r);
+    for (size_t i = 0; i < length && r->ok; ++i) {
+        FnParam param = {0};
+        read_type(r, &param.type);
+        param.is_mut = get_bool(r);
+        param.name = get_str(r);
+        param.symbol = read_symbol(r, param.name);
+        ll_param_push(r->arena, &out->params, param);
+    }
+
+    out->is_main = get_bool(r);
+}
+
+static void read_type(Reader* r, Type* out) {
+    *out = (Type){0};
+    if (!r->ok) {
+        return;
+    }
+
+    out->id.val = get_u64(r);
+    out->kind = get_tag(r, TK_COUNT);
+
+    switch (out->kind) {
+        case TK_BUILT_IN: out->type.built_in = get_tag(r, TBI_COUNT); break;
+        case TK_STATIC_PATH: {
+            out->type.static_path.path = read_static_path(r);
+            out->type.static_path.generic_args = read_typells(r);
+            out->type.static_path.impl_version = get_u64(r);
+            break;
+        }
+        case TK_POINTER: out->type.ptr.of = read_maybe_type(r); break;
+        case TK_MUT_POINTER: out->type.mut_ptr.of = read_maybe_type(r); break;
+        case TK_ARRAY: {
+            out->type.array.explicit_size = read_token(r);
+            out->type.array.of = read_maybe_type(r);
+            break;
+        }
+
+        default: break;
+    }
+
+    out->directives = read_directives(r);
+}
+
+static void read_node(Reader* r, ASTNode* out) {
+    *out = (ASTNode){0};
+    if (!r->ok) {
+        return;
+    }
+
+    out->id.val = get_u64(r);
+    out->type = get_tag(r, ANT_COUNT);
+
+    switch (out->type) {
+        case ANT_FILE_ROOT: out->node.file_root.nodes = read_nodes(r); break;
+
+        case ANT_UNARY_OP: {
+            out->node.unary_op.op = get_tag(r, UO_COUNT);
+            out->node.unary_op.right = read_maybe_node(r);
+            break;
+        }
+        case ANT_BINARY_OP: {
+            out->node.binary_op.op = get_tag(r, BO_COUNT);
+            out->node.binary_op.lhs = read_maybe_node(r);
+            out->node.binary_op.rhs = read_maybe_node(r);
+            break;
+        }
+        case ANT_POSTFIX_OP: {
+            out->node.postfix_op.left = read_maybe_node(r);
+            out->node.postfix_op.op = get_tag(r, PFO_COUNT);
+            break;
+        }
+
+        case ANT_LITERAL: {
+            ASTNodeLiteral* literal = &out->node.literal;
+            literal->kind = get_tag(r, LK_COUNT);
+            switch (literal->kind) {
+                case LK_BOOL: literal->value.lit_bool = get_bool(r); break;
+                case LK_INT: literal->value.lit_int = get_u64(r); break;
+                case LK_FLOAT: {
+                    uint64_t bits = get_u64(r);
+                    memcpy(&literal->value.lit_float, &bits, sizeof bits);
+                    break;
+                }
+                case LK_STR: literal->value.lit_str = get_str(r); break;
+                case LK_CHAR: literal->value.lit_char = get_str(r); break;
+                case LK_CHARS: literal->value.lit_chars = get_str(r); break;
+                default: break;
+            }
+            break;
+        }
+
+        case ANT_TUPLE: out->node.tuple.exprs = read_nodes(r); break;
+
+        case ANT_VAR_DECL: {
+            out->node.var_decl.is_static = get_bool(r);
+            out->node.var_decl.type_or_let.is_let = get_bool(r);
+            out->node.var_decl.type_or_let.is_mut = get_bool(r);
+            out->node.var_decl.type_or_let.maybe_type = read_maybe_type(r);
+            out->node.var_decl.lhs = read_var_decl_lhs(r);
+            out->node.var_decl.initializer = read_maybe_node(r);
+            break;
+        }
+        case ANT_VAR_REF: out->node.var_ref.path = read_static_path(r); break;
+
+        case ANT_GET_FIELD: {
+            out->node.get_field.root = read_maybe_node(r);
+            out->node.get_field.is_ptr_deref = get_bool(r);
+            out->node.get_field.name = get_str(r);
+            break;
+        }
+        case ANT_INDEX: {
+            out->node.index.root = read_maybe_node(r);
+            out->node.index.value = read_maybe_node(r);
+            break;
+        }
+        case ANT_RANGE: {
+            out->node.range.lhs = read_maybe_node(r);
+            out->node.range.rhs = read_maybe_node(r);
+            out->node.range.inclusive = get_bool(r);
+            break;
+        }
+        case ANT_ASSIGNMENT: {
+            out->node.assignment.op = get_tag(r, AO_COUNT);
+            out->node.assignment.lhs = read_maybe_node(r);
+            out->node.assignment.rhs = read_maybe_node(r);
+            break;
+        }
+        case ANT_FUNCTION_CALL: {
+            out->node.function_call.function = read_maybe_node(r);
+            out->node.function_call.generic_args = read_typells(r);
+            out->node.function_call.impl_version = get_u64(r);
+            out->node.function_call.args = read_nodes(r);
+            break;
+        }
+
+        case ANT_STATEMENT_BLOCK: out->node.statement_block.stmts = read_nodes(r); break;
+        case ANT_IF: {
+            out->node.if_.cond = read_maybe_node(r);
+            out->node.if_.block = read_maybe_block(r);
+            out->node.if_.else_ = read_maybe_node(r);
+            break;
+        }
+        case ANT_TRY: out->node.try_.target = read_maybe_node(r); break;
+        case ANT_CATCH: {
+            out->node.catch_.target = read_maybe_node(r);
+            out->node.catch_.error = get_str(r);
+            out->node.catch_.then = read_maybe_node(r);
+            break;
+        }
+        case ANT_BREAK: out->node.break_.maybe_expr = read_maybe_node(r); break;
+        case ANT_WHILE: {
+            out->node.while_.cond = read_maybe_node(r);
+            out->node.while_.block = read_maybe_block(r);
+            break;
+        }
+        case ANT_DO_WHILE: {
+            out->node.do_while.block = read_maybe_block(r);
+            out->node.do_while.cond = read_maybe_node(r);
+            break;
+        }
+        case ANT_FOR: {
+            out->node.for_.init = read_maybe_node(r);
+            out->node.for_.cond = read_maybe_node(r);
+            out->node.for_.step = read_maybe_node(r);
+            out->node.for_.block = read_maybe_block(r);
+            break;
+        }
+        case ANT_FOREACH: {
+            out->node.foreach.var = read_var_decl_lhs(r);
+            out->node.foreach.iterable = read_maybe_node(r);
+            out->node.foreach.block = read_maybe_block(r);
+            break;
+        }
+        case ANT_RETURN: out->node.return_.maybe_expr = read_maybe_node(r); break;
+        case ANT_DEFER: out->node.defer.stmt = read_maybe_node(r); break;
+        case ANT_CRASH: out->node.crash.maybe_expr = read_maybe_node(r); break;
+
+        case ANT_STRUCT_INIT: {
+            size_t length = get_length(r);
+            for (size_t i = 0; i < length && r->ok; ++i) {
+                StructFieldInit field = {0};
+                field.name = get_str(r);
+                field.value = read_maybe_node(r);
+                ll_field_init_push(r->arena, &out->node.struct_init.fields, field);
+            }
+            break;
+        }
+        case ANT_ARRAY_INIT: {
+            out->node.array_init.maybe_explicit_length = read_maybe_node(r);
+            size_t length = get_length(r);
+            for (size_t i = 0; i < length && r->ok; ++i) {
+                ArrayInitElem elem = {0};
+                elem.maybe_index = read_maybe_node(r);
+                elem.value = read_maybe_node(r);
+                ll_array_init_elem_push(r->arena, &out->node.array_init.elems, elem);
+            }
+            break;
+        }
+
+        case ANT_IMPORT: {
+            out->node.import.type = get_tag(r, IT_ROOT + 1);
+            out->node.import.import_path = read_import_path(r);
+            break;
+        }
+        case ANT_PACKAGE: out->node.package.package_path = read_package_path(r); break;
+
+        case ANT_TEMPLATE_STRING: {
+            r->uses_string_templates = true;
+            out->node.template_string.str_parts = read_strings(r);
+            out->node.template_string.template_expr_parts = read_nodes(r);
+            break;
+        }
+
+        case ANT_SIZEOF: {
+            out->node.sizeof_.kind = get_tag(r, SOK_EXPR + 1);
+            if (out->node.sizeof_.kind == SOK_TYPE) {
+                out->node.sizeof_.sizeof_.type = read_maybe_type(r);
+            } else {
+                out->node.sizeof_.sizeof_.expr = read_maybe_node(r);
+            }
+            break;
+        }
+        case ANT_SWITCH: {
+            out->node.switch_.expr = read_maybe_node(r);
+            out->node.switch_.cases_count = get_length(r);
+            out->node.switch_.cases = arena_calloc(r->arena, out->node.switch_.cases_count > 0 ? out->node.switch_.cases_count : 1, sizeof(SwitchCase));
+            for (size_t i = 0; i < out->node.switch_.cases_count && r->ok; ++i) {
+                SwitchCase* switch_case = out->node.switch_.cases + i;
+                if (get_bool(r)) {
+                    switch_case->matches = arena_alloc(r->arena, sizeof *switch_case->matches);
+                    *switch_case->matches = read_nodes(r);
+                }
+                switch_case->then = read_maybe_node(r);
+            }
+            out->node.switch_.maybe_else = read_maybe_node(r);
+            break;
+        }
+        case ANT_CAST: {
+            out->node.cast.type = read_maybe_type(r);
+            out->node.cast.target = read_maybe_node(r);
+            break;
+        }
+
+        case ANT_STRUCT_DECL: {
+            ASTNodeStructDecl* decl = arena_calloc(r->arena, 1, sizeof *decl);
+            if (get_bool(r)) {
+                decl->maybe_name = arena_alloc(r->arena, sizeof *decl->maybe_name);
+                *decl->maybe_name = get_str(r);
+            }
+
+            size_t length = get_length(r);
+            for (size_t i = 0; i < length && r->ok; ++i) {
+                StructField field = {0};
+                field.type = read_maybe_type(r);
+                field.name = get_str(r);
+                field.symbol = read_symbol(r, field.name);
+                ll_field_push(r->arena, &decl->fields, field);
+            }
+
+            decl->generic_params = read_strings(r);
+            decl->generic_impls = read_generic_impls(r);
+            out->node.struct_decl = decl;
+            break;
+        }
+        case ANT_UNION_DECL: {
+            if (get_bool(r)) {
+                out->node.union_decl.maybe_name = arena_alloc(r->arena, sizeof(String));
+                *out->node.union_decl.maybe_name = get_str(r);
+            }
+            break;
+        }
+        case ANT_ENUM_DECL: out->node.enum_decl.name = get_str(r); break;
+        case ANT_TYPEDEF_DECL: {
+            out->node.typedef_decl.name = get_str(r);
+            out->node.typedef_decl.type = read_maybe_type(r);
+            break;
+        }
+        case ANT_GLOBALTAG_DECL: {
+            if (get_bool(r)) {
+                out->node.globaltag_decl.maybe_name = arena_alloc(r->arena, sizeof(String));
+                *out->node.globaltag_decl.maybe_name = get_str(r);
+            }
+            break;
+        }
+        case ANT_FUNCTION_HEADER_DECL: {
+            out->node.function_header_decl = arena_calloc(r->arena, 1, sizeof *out->node.function_header_decl);
+            read_fn_header(r, out->node.function_header_decl);
+            break;
+        }
+        case ANT_FUNCTION_DECL: {
+            out->node.function_decl = arena_calloc(r->arena, 1, sizeof *out->node.function_decl);
+            read_fn_header(r, &out->node.function_decl->header);
+            out->node.function_decl->stmts = read_nodes(r);
+            break;
+        }
+
+        case ANT_NONE:
+        case ANT_FILE_SEPARATOR:
+        case ANT_CONTINUE:
+        case ANT_COUNT:
+            break;
+    }
+
+    out->directives = read_directives(r);
+}
+
+bool ast_cache_load(Arena* arena, String path, uint64_t source_hash, ParsedSource* source) {
+    int fd = open(path.chars, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ASTCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    size_t length = st.st_size;
+    // private and writable, so nothing that edits the AST in place can reach the file
+    char* mapped = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    ASTCacheHeader header;
+    memcpy(&header, mapped, sizeof header);
+
+    bool valid = memcmp(header.magic, AST_CACHE_MAGIC, sizeof header.magic) == 0
+        && header.format_version == AST_CACHE_FORMAT_VERSION
+        && header.source_hash == source_hash
+        && header.data_offset <= length && header.data_length <= length - header.data_offset
+        && header.strings_offset <= length && header.strings_length <= length - header.strings_offset;
+    if (!valid) {
+        munmap(mapped, length);
+        return false;
+    }
+
+    Reader r = {
+        .arena = arena,
+
+        .data = mapped + header.data_offset,
+        .data_length = header.data_length,
+        .cursor = 0,
+
+        .strings = mapped + header.strings_offset,
+        .strings_length = header.strings_length,
+
+        .uses_string_templates = false,
+        .ok = true,
+    };
+
+    ASTNode* root = arena_alloc(arena, sizeof *root);
+    read_node(&r, root);
+
+    if (!r.ok || r.cursor != r.data_length || root->type != ANT_FILE_ROOT) {
+        munmap(mapped, length);
+        return false;
+    }
+
+    source->ast = root;
+    source->had_error = false;
+    source->uses_string_templates = r.uses_string_templates;
+    source->node_ids_length = header.node_ids_length;
+    source->type_ids_length = header.type_ids_length;
+    source->package_name = NULL;
+    for (size_t i = 0; i < root->node.file_root.nodes.length; ++i) {
+        if (root->node.file_root.nodes.array[i].type == ANT_PACKAGE) {
+            source->package_name = root->node.file_root.nodes.array[i].node.package.package_path;
+            break;
+        }
+    }
+
+    source->mapped = mapped;
+    source->mapped_length = length;
+
+    return true;
+}
+
+void ast_cache_unmap(ParsedSource* source) {
+    if (source->mapped) {
+        munmap(source->mapped, source->mapped_length);
+        source->mapped = NULL;
+        source->mapped_length = 0;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef quill_ast_cache_h
+#define quill_ast_cache_h
+
+#include "./frontend.h"
+#include "../utils/utils.h"
+
+#define AST_CACHE_MAGIC "QLAC"
+#define AST_CACHE_FORMAT_VERSION 1
+
+// The whole AST parsed from a source file, function bodies included, as a binary file,
+// so an unchanged file is not lexed or parsed again.
+// It holds no pointers: children are written in order, and every string is an
+// offset and a length into a string section. The file is mapped, and each node is
+// rebuilt into the arena, while strings of the loaded AST point into the mapping,
+// which stays alive until ast_cache_unmap.
+// Only parsing is cached: loaded packages go through type resolution like any other.
+typedef struct {
+    char magic[4];
+    uint32_t format_version;
+    uint64_t source_hash;
+
+    uint64_t node_ids_length;
+    uint64_t type_ids_length;
+
+    uint64_t data_offset;
+    uint64_t data_length;
+    uint64_t strings_offset;
+    uint64_t strings_length;
+} ASTCacheHeader;
+
+// where the AST of the source at source_path is cached inside of dir
+String ast_cache_path(Arena* arena, String dir, String source_path);
+
+// the AST must still have the ids it was parsed with, starting from 0
+void ast_cache_write(Arena* arena, String path, uint64_t source_hash, ParsedSource const* source);
+
+// false if nothing is cached at path, or it was written for other source bytes
+bool ast_cache_load(Arena* arena, String path, uint64_t source_hash, ParsedSource* source);
+
+void ast_cache_unmap(ParsedSource* source);
+
+#endif
@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./build_cache.h"
+#include "./ast.h"
+#include "./frontend.h"
+
+#define MANIFEST_FILE "manifest"
+#define MANIFEST_HEADER "quill-cache " QUILLC_VERSION
+
+static String join_path(Arena* arena, String dir, String file) {
+    StringBuffer sb = strbuf_create(arena);
+    strbuf_append_str(&sb, dir);
+    strbuf_append_char(&sb, '/');
+    strbuf_append_str(&sb, file);
+    return strbuf_to_strcpy(sb);
+}
+
+static BuildCacheEntry* push_prev(BuildCache* cache, size_t* prev_capacity, String path, uint64_t source_hash, uint64_t output_key) {
+    if (cache->prev_length >= *prev_capacity) {
+        size_t prev_cap = *prev_capacity;
+        *prev_capacity = prev_cap > 0 ? prev_cap * 2 : 8;
+        cache->prev = arena_realloc(cache->arena, cache->prev, sizeof(BuildCacheEntry) * prev_cap, sizeof(BuildCacheEntry) * *prev_capacity);
+    }
+
+    BuildCacheEntry* entry = cache->prev + cache->prev_length;
+    cache->prev_length += 1;
+
+    *entry = (BuildCacheEntry){
+        .path = path,
+        .import_name = c_str(""),
+        .source_hash = source_hash,
+        .output_key = output_key,
+        .files = arraylist_string_create(cache->arena),
+    };
+    return entry;
+}
+
+// Lines are "source <hash> <key> <path>", each followed by "import <name>" if it was found as
+// an import and a "file <path>" per generated file, "common <path>" for files that belong
+// to no source, and "modules <paths>" for the module path.
+// A manifest from another compiler version is ignored.
+static void load_manifest(BuildCache* cache) {
+    String path = join_path(cache->arena, cache->dir, c_str(MANIFEST_FILE));
+
+    FILE* file = fopen(path.chars, "rb");
+    if (file == NULL) {
+        return;
+    }
+
+    size_t prev_capacity = 0;
+    BuildCacheEntry* curr = NULL;
+
+    char line[4096];
+    bool first = true;
+    while (fgets(line, sizeof line, file)) {
+        size_t length = strlen(line);
+        if (length > 0 && line[length - 1] == '\n') {
+            line[--length] = '\0';
+        }
+
+        if (first) {
+            first = false;
+            if (strcmp(line, MANIFEST_HEADER) != 0) {
+                break;
+            }
+            continue;
+        }
+
+        if (strncmp(line, "source ", 7) == 0) {
+            char* end = NULL;
+            uint64_t source_hash = strtoull(line + 7, &end, 16);
+            uint64_t output_key = strtoull(end, &end, 16);
+            if (*end != ' ') {
+                break;
+            }
+            curr = push_prev(cache, &prev_capacity, arena_strcpy(cache->arena, c_str(end + 1)), source_hash, output_key);
+        } else if (strncmp(line, "import ", 7) == 0 && curr) {
+            curr->import_name = arena_strcpy(cache->arena, c_str(line + 7));
+        } else if (strncmp(line, "file ", 5) == 0 && curr) {
+            arraylist_string_push(&curr->files, arena_strcpy(cache->arena, c_str(line + 5)));
+        } else if (strncmp(line, "modules ", 8) == 0) {
+            cache->prev_module_paths = arena_strcpy(cache->arena, c_str(line + 8));
+        } else if (strncmp(line, "common ", 7) == 0) {
+            arraylist_string_push(&cache->prev_common_files, arena_strcpy(cache->arena, c_str(line + 7)));
+        } else {
+            break;
+        }
+    }
+
+    fclose(file);
+}
+
+BuildCache build_cache_create(Arena* arena, String dir, String build_dir, String module_paths) {
+    if (dir.length == 0) {
+        dir = join_path(arena, build_dir, c_str(BUILD_CACHE_DEFAULT_DIR));
+    }
+
+    BuildCache cache = {
+        .arena = arena,
+        .dir = arena_strcpy(arena, dir),
+        .build_dir = arena_strcpy(arena, build_dir),
+        .module_paths = arena_strcpy(arena, module_paths),
+
+        .prev_length = 0,
+        .prev = NULL,
+        .prev_common_files = arraylist_string_create(arena),
+        .prev_module_paths = c_str(""),
+
+        .sources_length = 0,
+        .sources_capacity = 0,
+        .entries = NULL,
+        .common_files = arraylist_string_create(arena),
+
+        .prev_idxs = NULL,
+        .package_sources = NULL,
+
+        .reused = 0,
+    };
+
+    load_manifest(&cache);
+
+    return cache;
+}
+
+uint64_t build_cache_source_hash(String chars) {
+    uint64_t source_hash = fingerprint_chars(FNV_OFFSET_BASIS, c_str(QUILLC_VERSION));
+    return fingerprint_chars(source_hash, chars);
+}
+
+static bool files_exist(BuildCache const* cache, ArrayList_String files) {
+    for (size_t i = 0; i < files.length; ++i) {
+        if (!file_exists(join_path(cache->arena, cache->build_dir, files.array[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t prev_idx_of(BuildCache const* cache, String path) {
+    for (size_t p = 0; p < cache->prev_length; ++p) {
+        if (str_eq(cache->prev[p].path, path)) {
+            return p;
+        }
+    }
+    return cache->prev_length;
+}
+
+bool build_cache_up_to_date(BuildCache const* cache, Strings paths, Strings module_paths) {
+    if (cache->prev_length == 0 || cache->prev_common_files.length == 0) {
+        return false;
+    }
+
+    // imports are looked up along the module path, so another one could find other files
+    if (!str_eq(cache->prev_module_paths, cache->module_paths)) {
+        return false;
+    }
+
+    // the same paths are given, none left out or added
+    size_t listed_length = 0;
+    for (size_t p = 0; p < cache->prev_length; ++p) {
+        if (cache->prev[p].import_name.length == 0) {
+            listed_length += 1;
+        }
+    }
+    if (listed_length != paths.length) {
+        return false;
+    }
+    for (size_t i = 0; i < paths.length; ++i) {
+        size_t const p = prev_idx_of(cache, paths.strings[i]);
+        if (p == cache->prev_length || cache->prev[p].import_name.length > 0) {
+            return false;
+        }
+    }
+
+    // the last build also has every source found from an import, which are the same as
+    // long as no source changed and each import still finds the same file first
+    for (size_t p = 0; p < cache->prev_length; ++p) {
+        BuildCacheEntry const* prev = cache->prev + p;
+        if (!file_exists(prev->path) || !files_exist(cache, prev->files)) {
+            return false;
+        }
+
+        if (prev->import_name.length > 0 && !str_eq(frontend_find_module(cache->arena, module_paths, prev->import_name), prev->path)) {
+            return false;
+        }
+
+        if (prev->source_hash != build_cache_source_hash(file_read(cache->arena, prev->path))) {
+            return false;
+        }
+    }
+
+    return files_exist(cache, cache->prev_common_files);
+}
+
+void build_cache_track(BuildCache* cache, String path, String import_name, uint64_t source_hash, Package* package) {
+    if (cache->sources_length >= cache->sources_capacity) {
+        size_t prev_cap = cache->sources_capacity;
+        cache->sources_capacity = prev_cap > 0 ? prev_cap * 2 : 8;
+        cache->entries = arena_realloc(cache->arena, cache->entries, sizeof(BuildCacheEntry) * prev_cap, sizeof(BuildCacheEntry) * cache->sources_capacity);
+        cache->prev_idxs = arena_realloc(cache->arena, cache->prev_idxs, sizeof(size_t) * prev_cap, sizeof(size_t) * cache->sources_capacity);
+        // a package per source, so package ids stay below the number of sources
+        cache->package_sources = arena_realloc(cache->arena, cache->package_sources, sizeof(size_t) * prev_cap, sizeof(size_t) * cache->sources_capacity);
+    }
+    assert(package->id < cache->sources_capacity);
+
+    size_t source_idx = cache->sources_length;
+    cache->sources_length += 1;
+
+    cache->entries[source_idx] = (BuildCacheEntry){
+        .path = path,
+        .import_name = import_name,
+        .source_hash = source_hash,
+        .output_key = 0,
+        .files = arraylist_string_create(cache->arena),
+    };
+    cache->prev_idxs[source_idx] = prev_idx_of(cache, path);
+
+    cache->package_sources[package->id] = source_idx;
+    package->fingerprint = source_hash;
+}
+
+// node ids are shifted per file, so an offset from the file root only changes with the file
+static uint64_t decl_key(Package const* owner, size_t decl_node_id) {
+    if (!owner || !owner->ast) {
+        return FNV_OFFSET_BASIS;
+    }
+    return fingerprint_mix(owner->fingerprint, decl_node_id - owner->ast->id.val);
+}
+
+// like resolved_type_eq_hash, but without pointers or node ids, so it holds across builds
+static uint64_t type_key(ResolvedType const* rt) {
+    if (!rt) {
+        return FNV_OFFSET_BASIS;
+    }
+
+    uint64_t key = fingerprint_mix(FNV_OFFSET_BASIS, rt->kind);
+    switch (rt->kind) {
+        case RTK_NAMESPACE: return fingerprint_mix(key, rt->type.namespace_ ? rt->type.namespace_->fingerprint : 0);
+
+        case RTK_POINTER: return fingerprint_mix(key, type_key(rt->type.ptr.of));
+        case RTK_MUT_POINTER: return fingerprint_mix(key, type_key(rt->type.mut_ptr.of));
+
+        case RTK_ARRAY: {
+            key = fingerprint_mix(key, rt->type.array.has_explicit_length ? rt->type.array.explicit_length + 1 : 0);
+            return fingerprint_mix(key, type_key(rt->type.array.of));
+        }
+
+        case RTK_FUNCTION_DECL: {
+            for (size_t i = 0; i < rt->type.function_decl.params_length; ++i) {
+                key = fingerprint_mix(key, type_key(rt->type.function_decl.params[i].type));
+            }
+            return fingerprint_mix(key, type_key(rt->type.function_decl.return_type));
+        }
+
+        case RTK_FUNCTION_REF: {
+            for (size_t i = 0; i < rt->type.function_ref.decl.params_length; ++i) {
+                key = fingerprint_mix(key, type_key(rt->type.function_ref.decl.params[i].type));
+            }
+            key = fingerprint_mix(key, type_key(rt->type.function_ref.decl.return_type));
+            for (size_t i = 0; i < rt->type.function_ref.generic_args.length; ++i) {
+                key = fingerprint_mix(key, type_key(rt->type.function_ref.generic_args.resolved_types[i]));
+            }
+            return key;
+        }
+
+        case RTK_STRUCT_DECL: return fingerprint_mix(key, rt->src ? decl_key(rt->from_pkg, rt->src->id.val) : 0);
+
+        case RTK_STRUCT_REF: {
+            key = fingerprint_mix(key, decl_key(rt->type.struct_ref.decl->from_pkg, rt->type.struct_ref.decl_node_id.val));
+            for (size_t i = 0; i < rt->type.struct_ref.generic_args.length; ++i) {
+                key = fingerprint_mix(key, type_key(rt->type.struct_ref.generic_args.resolved_types[i]));
+            }
+            return key;
+        }
+
+        case RTK_GENERIC: return fingerprint_mix(key, rt->type.generic.idx);
+
+        default: return key;
+    }
+}
+
+void build_cache_prepare(BuildCache* cache, Packages const* packages, Reachability const* reachability) {
+    uint64_t shared_key = FNV_OFFSET_BASIS;
+
+    // every instantiation, in the order of their decls, with their versions in order
+    for (size_t decl_id = 0; decl_id < packages->generic_impls_nodes_length; ++decl_id) {
+        GenericImpls const* impls = packages->generic_impls_nodes_concrete + decl_id;
+        if (impls->length == 0) {
+            continue;
+        }
+
+        ResolvedType const* decl = packages->types[decl_id].type;
+        shared_key = fingerprint_mix(shared_key, decl_key(decl ? decl->from_pkg : NULL, decl_id));
+
+        for (size_t version = 0; version < impls->length; ++version) {
+            shared_key = fingerprint_mix(shared_key, impls->array[version].length);
+            for (size_t i = 0; i < impls->array[version].length; ++i) {
+                shared_key = fingerprint_mix(shared_key, type_key(impls->array[version].resolved_types[i]));
+            }
+        }
+    }
+
+    // codegen includes these and calls into them without an import
+    for (size_t i = 0; i < packages->count; ++i) {
+        Package const* package = packages->list[i];
+        if (package->full_name && is_runtime_package(package_path_to_str(cache->arena, package->full_name))) {
+            shared_key = fingerprint_mix(shared_key, packages->list[i]->fingerprint);
+        }
+    }
+    ResolvedType const* lang_types[] = {
+        packages->string_literal_type,
+        packages->string_template_type,
+        packages->range_literal_type,
+    };
+    for (size_t i = 0; i < sizeof lang_types / sizeof *lang_types; ++i) {
+        if (lang_types[i] && lang_types[i]->from_pkg) {
+            shared_key = fingerprint_mix(shared_key, lang_types[i]->from_pkg->fingerprint);
+        }
+    }
+
+    for (size_t i = 0; i < packages->count; ++i) {
+        Package const* package = packages->list[i];
+        BuildCacheEntry* entry = cache->entries + cache->package_sources[package->id];
+
+        entry->output_key = fingerprint_mix(package->fingerprint, shared_key);
+
+        // decls are pruned by what other packages use, so their offsets in the file are part of the key
+        if (reachability && package->ast) {
+            ASTNodeFileRoot const root = package->ast->node.file_root;
+            for (size_t j = 0; j < root.nodes.length; ++j) {
+                ASTNode const* curr = root.nodes.array + j;
+                if (!reachability_keeps(reachability, curr)) {
+                    entry->output_key = fingerprint_mix(entry->output_key, j);
+                }
+            }
+        }
+        if (entry->output_key == 0) {
+            entry->output_key = 1;
+        }
+    }
+}
+
+bool build_cache_reuse(BuildCache* cache, Package const* package) {
+    size_t source_idx = cache->package_sources[package->id];
+    BuildCacheEntry* entry = cache->entries + source_idx;
+    assert(entry->output_key != 0);
+
+    size_t prev_idx = cache->prev_idxs[source_idx];
+    if (prev_idx == cache->prev_length) {
+        return false;
+    }
+
+    BuildCacheEntry const* prev = cache->prev + prev_idx;
+    if (prev->output_key != entry->output_key || prev->files.length == 0 || !files_exist(cache, prev->files)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < prev->files.length; ++i) {
+        arraylist_string_push(&entry->files, prev->files.array[i]);
+    }
+    cache->reused += 1;
+
+    return true;
+}
+
+void build_cache_generated(BuildCache* cache, Package const* package, String filepath) {
+    if (!package) {
+        arraylist_string_push(&cache->common_files, filepath);
+        return;
+    }
+
+    arraylist_string_push(&cache->entries[cache->package_sources[package->id]].files, filepath);
+}
+
+void build_cache_save(BuildCache const* cache) {
+    dir_create(cache->dir);
+
+    String path = join_path(cache->arena, cache->dir, c_str(MANIFEST_FILE));
+
+    FILE* file = fopen(path.chars, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open file \"%s\".\n", path.chars);
+        exit(74);
+    }
+
+    fprintf(file, "%s\n", MANIFEST_HEADER);
+    fprintf(file, "modules %s\n", cache->module_paths.chars);
+    for (size_t i = 0; i < cache->common_files.length; ++i) {
+        fprintf(file, "common %s\n", arena_strcpy(cache->arena, cache->common_files.array[i]).chars);
+    }
+    for (size_t i = 0; i < cache->sources_length; ++i) {
+        BuildCacheEntry const* entry = cache->entries + i;
+
+        fprintf(file, "source %016llx %016llx %s\n",
+            (unsigned long long)entry->source_hash,
+            (unsigned long long)entry->output_key,
+            arena_strcpy(cache->arena, entry->path).chars
+        );
+        if (entry->import_name.length > 0) {
+            fprintf(file, "import %s\n", arena_strcpy(cache->arena, entry->import_name).chars);
+        }
+        for (size_t f = 0; f < entry->files.length; ++f) {
+            fprintf(file, "file %s\n", arena_strcpy(cache->arena, entry->files.array[f]).chars);
+        }
+    }
+
+    fclose(file);
+}
@@ -0,0 +1,89 @@
+#ifndef quill_build_cache_h
+#define quill_build_cache_h
+
+#include "./package.h"
+#include "./reachability.h"
+#include "../utils/utils.h"
+
+#define QUILLC_VERSION "0.1.0"
+
+#define BUILD_CACHE_DEFAULT_DIR ".quill-cache"
+
+// A source file as of some build, and the files generated from it.
+typedef struct {
+    String path;
+    // the package it was found as along the module paths, or empty if its path was given
+    String import_name;
+    uint64_t source_hash;
+    // 0 until the package's key is known
+    uint64_t output_key;
+    ArrayList_String files;
+} BuildCacheEntry;
+
+// Remembers in `<dir>/manifest` what each source looked like at the last build,
+// and which files in the build dir were generated from it.
+//
+// When the same sources would be built and none of them changed, nothing needs to be
+// parsed, resolved or generated.
+// Otherwise the files of a package are reused while its output key matches. The key
+// covers the package's fingerprint, the runtime packages codegen refers to by name,
+// every generic instantiation, since their versions show up in generated names,
+// and which of the package's decls are reachable.
+//
+// Only generating C is skipped per package. Every package is still resolved, unchanged
+// or not, as the type resolver can't take in the types of a previous build.
+typedef struct {
+    Arena* arena;
+    String dir;
+    String build_dir;
+    String module_paths;
+
+    // last build, in manifest order
+    size_t prev_length;
+    BuildCacheEntry* prev;
+    ArrayList_String prev_common_files;
+    String prev_module_paths;
+
+    // this build, in the order sources are tracked
+    size_t sources_length;
+    size_t sources_capacity;
+    BuildCacheEntry* entries;
+    ArrayList_String common_files;
+
+    // source index => index in prev, or prev_length if it is new
+    size_t* prev_idxs;
+    // package id => source index
+    size_t* package_sources;
+
+    size_t reused;
+} BuildCache;
+
+// Loads the manifest, if any.
+// An empty `dir` means BUILD_CACHE_DEFAULT_DIR inside of `build_dir`.
+BuildCache build_cache_create(Arena* arena, String dir, String build_dir, String module_paths);
+
+// hash of a source's bytes, as the compiler version sees them
+uint64_t build_cache_source_hash(String chars);
+
+// true if the given paths are exactly the ones of the last build, each of its imports
+// still finds the same file along the module paths, no source of it changed,
+// and its files are still there
+bool build_cache_up_to_date(BuildCache const* cache, Strings paths, Strings module_paths);
+
+// seeds the fingerprint of the package parsed from the source at path,
+// which was found as `import_name`, or given if that is empty
+void build_cache_track(BuildCache* cache, String path, String import_name, uint64_t source_hash, Package* package);
+
+// computes output keys, once types are resolved and generics monomorphized.
+// `reachability` is optional, for when every decl gets generated.
+void build_cache_prepare(BuildCache* cache, Packages const* packages, Reachability const* reachability);
+
+// true if the package's files from the last build are still valid, in which case they are kept
+bool build_cache_reuse(BuildCache* cache, Package const* package);
+
+// records a generated file; a NULL package is for files shared by every package
+void build_cache_generated(BuildCache* cache, Package const* package, String filepath);
+
+void build_cache_save(BuildCache const* cache);
+
+#endif
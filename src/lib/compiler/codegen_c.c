@@ -1,4 +1,6 @@
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "./ast.h"
@@ -18,7 +20,7 @@ static void print_generic_map(Arena* arena, GenericImplMap* map) {
         printf("    %s: %s (RTK_%d),\n",
             arena_strcpy(arena, map->generic_names[i]).chars,
             arena_strcpy(arena, map->mapped_types[i]).chars,
-            map->mapped_rtypes[i].kind
+            map->mapped_rtypes[i]->kind
         );
     }
 
@@ -49,10 +51,10 @@ static DirectiveCHeader* get_c_header(Package* package) {
     }
     assert(package->ast->type == ANT_FILE_ROOT);
 
-    LLNode_ASTNode* n_curr = package->ast->node.file_root.nodes.head;
-    while (n_curr) {
-        if (n_curr->data.type == ANT_PACKAGE) {
-            LLNode_Directive* d_curr = n_curr->data.directives.head;
+    for (size_t i = 0; i < package->ast->node.file_root.nodes.length; ++i) {
+        ASTNode* n_curr = package->ast->node.file_root.nodes.array + i;
+        if (n_curr->type == ANT_PACKAGE) {
+            LLNode_Directive* d_curr = n_curr->directives.head;
             while (d_curr) {
                 if (d_curr->data.type == DT_C_HEADER) {
                     return &d_curr->data.dir.c_header;
@@ -60,21 +62,16 @@ static DirectiveCHeader* get_c_header(Package* package) {
                 d_curr = d_curr->next;
             }
         }
-        n_curr = n_curr->next;
     }
 
     return NULL;
 }
 
-static size_t unique_id(void) {
-    static size_t next_id = 0;
-    return next_id++;
-}
-
-String unique_var_name(Arena* arena) {
-    StringBuffer sb = strbuf_create(arena);
+// numbered within the file being generated, so a name doesn't depend on which other files were generated
+static String unique_var_name(CodegenC* codegen) {
+    StringBuffer sb = strbuf_create(codegen->arena);
     strbuf_append_chars(&sb, "_ql_");
-    strbuf_append_uint(&sb, unique_id());
+    strbuf_append_uint(&sb, codegen->next_temp_id++);
     return strbuf_to_str(sb);
 }
 
@@ -98,13 +95,13 @@ String user_var_name(Arena* arena, String name, Package* pkg) {
     return strbuf_to_str(sb);
 }
 
-static String* get_mapped_generic(GenericImplMap* map, String generic) {
+static String* _get_mapped_generic(GenericImplMap* map, Symbol generic) {
     if (!map) {
         return NULL;
     }
 
     for (size_t i = 0; i < map->length; ++i) {
-        if (str_eq(map->generic_names[i], generic)) {
+        if (map->generic_symbols[i] == generic) {
             return map->mapped_types + i;
         }
     }
@@ -113,16 +110,26 @@ static String* get_mapped_generic(GenericImplMap* map, String generic) {
         return NULL;
     }
 
-    return get_mapped_generic(map->parent, generic);
+    return _get_mapped_generic(map->parent, generic);
 }
 
-static int64_t get_mapped_generic_idx(GenericImplMap* map, String generic) {
+static String* get_mapped_generic(GenericImplMap* map, String generic) {
+    // generic names are interned when a map is made, so anything else can't match
+    Symbol const symbol = symbol_find(generic);
+    if (symbol == SYMBOL_NONE) {
+        return NULL;
+    }
+
+    return _get_mapped_generic(map, symbol);
+}
+
+static int64_t _get_mapped_generic_idx(GenericImplMap* map, Symbol generic) {
     if (!map) {
         return -1;
     }
 
     for (size_t i = 0; i < map->length; ++i) {
-        if (str_eq(map->generic_names[i], generic)) {
+        if (map->generic_symbols[i] == generic) {
             return i;
         }
     }
@@ -131,7 +138,37 @@ static int64_t get_mapped_generic_idx(GenericImplMap* map, String generic) {
         return -1;
     }
 
-    return get_mapped_generic_idx(map->parent, generic);
+    return _get_mapped_generic_idx(map->parent, generic);
+}
+
+static int64_t get_mapped_generic_idx(GenericImplMap* map, String generic) {
+    Symbol const symbol = symbol_find(generic);
+    if (symbol == SYMBOL_NONE) {
+        return -1;
+    }
+
+    return _get_mapped_generic_idx(map, symbol);
+}
+
+// follows generics mapped to other generics, to the index of the concrete type
+static int64_t get_concrete_generic_idx(CodegenC* codegen, ResolvedType* generic) {
+    int64_t mapped_idx = get_mapped_generic_idx(codegen->generic_map, generic->type.generic.name);
+    if (mapped_idx < 0) {
+        println_astnode(*generic->src);
+        printf("Couldn't find %s\n", arena_strcpy(codegen->arena, generic->type.generic.name).chars);
+        print_generic_map(codegen->arena, codegen->generic_map);
+    }
+    assert(mapped_idx >= 0);
+
+    while (codegen->generic_map->mapped_rtypes[mapped_idx]->kind == RTK_GENERIC) {
+        int64_t next_idx = get_mapped_generic_idx(codegen->generic_map, codegen->generic_map->mapped_types[mapped_idx]);
+        while (next_idx >= 0) {
+            mapped_idx = next_idx;
+            next_idx = get_mapped_generic_idx(codegen->generic_map, codegen->generic_map->mapped_types[mapped_idx]);
+        }
+    }
+
+    return mapped_idx;
 }
 
 static void ll_node_push(Arena* const arena, LL_IR_C_Node* const ll, IR_C_Node const node) {
@@ -289,22 +326,26 @@ static void _append_type(CodegenC* codegen, StringBuffer* sb, Type type, Package
             ) {
                 String* mapped = get_mapped_generic(codegen->generic_map, type.type.static_path.path->name);
                 if (mapped) {
-                    printf("TK_%d\n", type.kind);
-                    printf("%s = %s\n\n",
-                        arena_strcpy(codegen->arena, type.type.static_path.path->name).chars,
-                        arena_strcpy(codegen->arena, *mapped).chars
-                    );
+                    if (log_dumps(LOG_DUMP_GENERICS)) {
+                        printf("TK_%d\n", type.kind);
+                        printf("%s = %s\n\n",
+                            arena_strcpy(codegen->arena, type.type.static_path.path->name).chars,
+                            arena_strcpy(codegen->arena, *mapped).chars
+                        );
+                    }
                     // assert(false);
                     strbuf_append_str(sb, *mapped);
                     break;
-                } else {
+                } else if (log_dumps(LOG_DUMP_GENERICS)) {
                     printf("searched map, none found\n");
                 }
             }
-            printf("%lu\n", type.type.static_path.generic_args.length);
-            printf("%lu\n", type.type.static_path.impl_version);
-            printf("%s\n", type.type.static_path.path->child ? "has child" : "no child");
-            printf("%s\n\n", arena_strcpy(codegen->arena, type.type.static_path.path->name).chars);
+            if (log_dumps(LOG_DUMP_GENERICS)) {
+                printf("%lu\n", type.type.static_path.generic_args.length);
+                printf("%lu\n", type.type.static_path.impl_version);
+                printf("%s\n", type.type.static_path.path->child ? "has child" : "no child");
+                printf("%s\n\n", arena_strcpy(codegen->arena, type.type.static_path.path->name).chars);
+            }
 
             StaticPath* curr = type.type.static_path.path;
             while (curr->child) {
@@ -420,60 +461,36 @@ static void _append_type_resolved(CodegenC* codegen, StringBuffer* sb, ResolvedT
         case RTK_STRUCT_REF: {
             strbuf_append_chars(sb, "struct ");
 
-            String name = user_var_name(codegen->arena, type->type.struct_ref.decl.name, type->from_pkg);
+            String name = user_var_name(codegen->arena, type->type.struct_ref.decl->type.struct_decl.name, type->from_pkg);
             strbuf_append_str(sb, name);
             if (type->type.struct_ref.generic_args.length > 0) {
-                LL_GenericImpl generic_impls = codegen->packages->generic_impls_nodes_concrete[type->type.struct_ref.decl_node_id.val];
-                assert(generic_impls.length > 0);
+                GenericImpls* generic_impls = codegen->packages->generic_impls_nodes_concrete + type->type.struct_ref.decl_node_id.val;
+                assert(generic_impls->length > 0);
 
-                size_t version = 0;
-                bool found = true;
-                LLNode_GenericImpl* curr = generic_impls.head;
-                printf("Finding version for struct ref %s<...>\n", arena_strcpy(codegen->arena, type->type.struct_ref.decl.name).chars);
-                while (curr) {
-                    printf("Checking version %lu...\n", version);
-
-                    if (curr->data.length == type->type.struct_ref.generic_args.length) {
-                        printf("len %lu == len %lu\n", curr->data.length, type->type.struct_ref.generic_args.length);
-
-                        found = true;
-                        for (size_t i = 0; i < curr->data.length; ++i) {
-                            ResolvedType* rt_arg = type->type.struct_ref.generic_args.resolved_types + i;
-                            assert(rt_arg);
-                            assert(curr->data.resolved_types + i);
-                            assert(curr->data.resolved_types[i]);
-
-                            if (rt_arg->kind == RTK_GENERIC) {
-                                StringBuffer rt_arg_sb = strbuf_create(codegen->arena);
-                                _append_type_resolved(codegen, &rt_arg_sb, rt_arg);
-
-                                StringBuffer curr_sb = strbuf_create(codegen->arena);
-                                _append_type_resolved(codegen, &curr_sb, curr->data.resolved_types[i]);
-                                if (!str_eq(strbuf_to_str(rt_arg_sb), strbuf_to_str(curr_sb))) {
-                                    printf("\"%s\" != \"%s\"\n",
-                                        arena_strcpy(codegen->arena, strbuf_to_str(rt_arg_sb)).chars,
-                                        arena_strcpy(codegen->arena, strbuf_to_str(curr_sb)).chars
-                                    );
-                                    found = false;
-                                    break;
-                                }
-                            } else if (!resolved_type_eq(curr->data.resolved_types[i], type->type.struct_ref.generic_args.resolved_types + i)) {
-                                printf("RTK_%d != RTK_%d\n", curr->data.resolved_types[i]->kind, (type->type.struct_ref.generic_args.resolved_types + i)->kind);
-                                found = false;
-                                break;
-                            }
-                        }
+                if (log_dumps(LOG_DUMP_GENERICS)) {
+                    printf("Finding version for struct ref %s<...>\n", arena_strcpy(codegen->arena, type->type.struct_ref.decl->type.struct_decl.name).chars);
+                }
 
-                        if (found) {
-                            break;
-                        }
+                // impls are concrete, so look up the args the generics among them are mapped to
+                GenericImpl ref_impl = {
+                    .length = type->type.struct_ref.generic_args.length,
+                    .resolved_types = arena_calloc(codegen->arena, type->type.struct_ref.generic_args.length, sizeof(ResolvedType*)),
+                };
+                for (size_t i = 0; i < ref_impl.length; ++i) {
+                    ResolvedType* rt_arg = type->type.struct_ref.generic_args.resolved_types[i];
+                    assert(rt_arg);
+
+                    if (rt_arg->kind == RTK_GENERIC) {
+                        rt_arg = codegen->generic_map->mapped_rtypes[get_concrete_generic_idx(codegen, rt_arg)];
                     }
+                    ref_impl.resolved_types[i] = rt_arg;
+                }
 
-                    version += 1;
-                    curr = curr->next;
+                size_t version = generic_impls_find(generic_impls, ref_impl);
+                assert(version < generic_impls->length);
+                if (log_dumps(LOG_DUMP_GENERICS)) {
+                    printf("Found version %lu!\n", version);
                 }
-                assert(found);
-                printf("Found version %lu!\n", version);
 
                 strbuf_append_chars(sb, "_");
                 strbuf_append_uint(sb, version);
@@ -482,30 +499,18 @@ static void _append_type_resolved(CodegenC* codegen, StringBuffer* sb, ResolvedT
         }
 
         case RTK_GENERIC: {
-            int64_t mapped_idx = get_mapped_generic_idx(codegen->generic_map, type->type.generic.name);
-            if (mapped_idx < 0) {
-                println_astnode(*type->src);
-                printf("Couldn't find %s\n", arena_strcpy(codegen->arena, type->type.generic.name).chars);
-                print_generic_map(codegen->arena, codegen->generic_map);
-            }
-            assert(mapped_idx >= 0);
-
-            while (codegen->generic_map->mapped_rtypes[mapped_idx].kind == RTK_GENERIC) {
-                int64_t next_idx = get_mapped_generic_idx(codegen->generic_map, codegen->generic_map->mapped_types[mapped_idx]);
-                while (next_idx >= 0) {
-                    mapped_idx = next_idx;
-                    next_idx = get_mapped_generic_idx(codegen->generic_map, codegen->generic_map->mapped_types[mapped_idx]);
-                }
-            }
+            int64_t mapped_idx = get_concrete_generic_idx(codegen, type);
 
             String mapped = codegen->generic_map->mapped_types[mapped_idx];
 
-            printf("RTK_%d\n", type->kind);
-            printf("<%lu:%s> = %s\n\n",
-                type->type.generic.idx,
-                arena_strcpy(codegen->arena, type->type.generic.name).chars,
-                arena_strcpy(codegen->arena, mapped).chars
-            );
+            if (log_dumps(LOG_DUMP_GENERICS)) {
+                printf("RTK_%d\n", type->kind);
+                printf("<%lu:%s> = %s\n\n",
+                    type->type.generic.idx,
+                    arena_strcpy(codegen->arena, type->type.generic.name).chars,
+                    arena_strcpy(codegen->arena, mapped).chars
+                );
+            }
             strbuf_append_str(sb, mapped);
             break;
         }
@@ -540,12 +545,12 @@ static void _fn_header_decl(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* n
 
     Strings params = {
         .length = 0,
-        .strings = arena_calloc(codegen->arena, node->node.function_header_decl.params.length, sizeof(String)),
+        .strings = arena_calloc(codegen->arena, node->node.function_header_decl->params.length, sizeof(String)),
     };
     {
         StringBuffer sb = strbuf_create(codegen->arena);
 
-        LLNode_FnParam* curr = node->node.function_header_decl.params.head;
+        LLNode_FnParam* curr = node->node.function_header_decl->params.head;
         while (curr) {
             strbuf_append_str(&sb, gen_type(codegen, curr->data.type, type->from_pkg));
             strbuf_append_char(&sb, ' ');
@@ -558,18 +563,213 @@ static void _fn_header_decl(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* n
         }
     }
 
-    String name = node->node.function_header_decl.name;
+    String name = node->node.function_header_decl->name;
 
     ll_node_push(codegen->arena, c_nodes, (IR_C_Node){
         .type = ICNT_FUNCTION_HEADER_DECL,
         .node.function_decl = {
-            .return_type = gen_type(codegen, node->node.function_header_decl.return_type, type->from_pkg),
+            .return_type = gen_type(codegen, node->node.function_header_decl->return_type, type->from_pkg),
             .name = name,
             .params = params,
         },
     });
 }
 
+// gen: {prefix}{suffix}({first}, {value});
+static void push_template_part(CodegenC* codegen, LL_IR_C_Node* c_nodes, char* prefix, char* suffix, IR_C_Node first, IR_C_Node value) {
+    IR_C_Node* target = arena_alloc(codegen->arena, sizeof *target);
+    {
+        StringBuffer sb = strbuf_create(codegen->arena);
+        strbuf_append_chars(&sb, prefix);
+        strbuf_append_chars(&sb, suffix);
+        *target = (IR_C_Node){
+            .type = ICNT_RAW,
+            .node.raw.str = strbuf_to_str(sb),
+        };
+    }
+
+    LL_IR_C_Node args = {0};
+    ll_node_push(codegen->arena, &args, first);
+    ll_node_push(codegen->arena, &args, value);
+
+    ll_node_push(codegen->arena, c_nodes, (IR_C_Node){
+        .type = ICNT_FUNCTION_CALL,
+        .node.function_call = {
+            .target = target,
+            .args = args,
+        },
+    });
+}
+
+// the string parts of a template string are kept with their quotes
+static void push_template_str_part(CodegenC* codegen, LL_IR_C_Node* c_nodes, char* prefix, IR_C_Node first, String part, bool newline) {
+    StringBuffer sb = strbuf_create(codegen->arena);
+    strbuf_append_char(&sb, '"');
+    strbuf_append_str(&sb, (String){
+        .length = part.length - 2,
+        .chars = part.chars + 1,
+    });
+    if (newline) {
+        strbuf_append_chars(&sb, "\\n");
+    }
+    strbuf_append_char(&sb, '"');
+    String str_lit = strbuf_to_str(sb);
+
+    if (str_lit.length > 2) {
+        push_template_part(codegen, c_nodes, prefix, "chars", first, (IR_C_Node){
+            .type = ICNT_RAW,
+            .node.raw.str = str_lit,
+        });
+    }
+}
+
+static void push_template_expr_part(CodegenC* codegen, LL_IR_C_Node* c_nodes, char* prefix, IR_C_Node first, ASTNode* expr, FileType ftype, TransformStage stage) {
+    assert(codegen->packages->types[expr->id.val].type);
+    if (expr->type == ANT_VAR_REF && !expr->node.var_ref.path->child && resolved_type_eq(codegen->packages->types[expr->id.val].type, codegen->packages->string_literal_type)) {
+        push_template_part(codegen, c_nodes, prefix, "str", first, (IR_C_Node){
+            .type = ICNT_RAW,
+            .node.raw = user_var_name(codegen->arena, expr->node.var_ref.path->name, codegen->current_package),
+        });
+        return;
+    }
+
+    LL_IR_C_Node expr_ll = {0};
+
+    ResolvedType* rt = codegen->packages->types[expr->id.val].type;
+    while (true) {
+        assert(rt);
+
+        switch (rt->kind) {
+            case RTK_INT:
+            case RTK_INT8:
+            case RTK_INT16:
+            case RTK_INT32:
+            case RTK_INT64:
+            {
+                fill_nodes(codegen, &expr_ll, expr, ftype, stage, false);
+                assert(expr_ll.length == 1);
+
+                push_template_part(codegen, c_nodes, prefix, "int", first, (IR_C_Node){
+                    .type = ICNT_RAW_WRAP,
+                    .node.raw_wrap = {
+                        .pre = c_str("(int64_t)"),
+                        .wrapped = &expr_ll.head->data,
+                        .post = c_str(""),
+                    },
+                });
+                return;
+            }
+
+            case RTK_UINT:
+            case RTK_UINT8:
+            case RTK_UINT16:
+            case RTK_UINT32:
+            case RTK_UINT64:
+            {
+                fill_nodes(codegen, &expr_ll, expr, ftype, stage, false);
+                assert(expr_ll.length == 1);
+
+                push_template_part(codegen, c_nodes, prefix, "uint", first, (IR_C_Node){
+                    .type = ICNT_RAW_WRAP,
+                    .node.raw_wrap = {
+                        .pre = c_str("(uint64_t)"),
+                        .wrapped = &expr_ll.head->data,
+                        .post = c_str(""),
+                    },
+                });
+                return;
+            }
+
+            case RTK_CHAR: {
+                fill_nodes(codegen, &expr_ll, expr, ftype, stage, false);
+                assert(expr_ll.length == 1);
+
+                push_template_part(codegen, c_nodes, prefix, "char", first, expr_ll.head->data);
+                return;
+            }
+
+            case RTK_BOOL: {
+                fill_nodes(codegen, &expr_ll, expr, ftype, stage, false);
+                assert(expr_ll.length == 1);
+
+                push_template_part(codegen, c_nodes, prefix, "bool", first, expr_ll.head->data);
+                return;
+            }
+
+            case RTK_STRUCT_REF: {
+                assert(resolved_type_eq(codegen->packages->types[expr->id.val].type, codegen->packages->string_literal_type));
+
+                fill_nodes(codegen, &expr_ll, expr, ftype, stage, false);
+                assert(expr_ll.length == 1);
+
+                push_template_part(codegen, c_nodes, prefix, "str", first, expr_ll.head->data);
+                return;
+            }
+
+            case RTK_GENERIC: {
+                rt = codegen->generic_map->mapped_rtypes[get_concrete_generic_idx(codegen, rt)];
+
+                continue;
+            }
+
+            default: printf("TODO: string template RTK_%d\n", codegen->packages->types[expr->id.val].type->kind); assert(false);
+        }
+    }
+}
+
+// gen: {prefix}chars({first}, "..."); {prefix}int({first}, ...); ... // for each part of the template string, in order
+static void fill_template_parts(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node, char* prefix, IR_C_Node first, bool newline, FileType ftype, TransformStage stage) {
+    assert(node->type == ANT_TEMPLATE_STRING);
+
+    size_t const exprs_length = node->node.template_string.template_expr_parts.length;
+
+    push_template_str_part(codegen, c_nodes, prefix, first, node->node.template_string.str_parts.array[0], newline && exprs_length == 0);
+
+    for (size_t i = 0; i < exprs_length; ++i) {
+        push_template_expr_part(codegen, c_nodes, prefix, first, node->node.template_string.template_expr_parts.array + i, ftype, stage);
+        push_template_str_part(codegen, c_nodes, prefix, first, node->node.template_string.str_parts.array[i + 1], newline && i + 1 == exprs_length);
+    }
+}
+
+typedef struct {
+    char* function;
+    char* stream;
+    bool newline;
+} DirectWrite;
+
+// a template string passed straight to one of these is written to its stream part by part,
+// so no StringBuffer is allocated just to be printed and freed
+static DirectWrite const DIRECT_WRITES[] = {
+    { "std_io_print", "stdout", false },
+    { "std_io_println", "stdout", true },
+    { "std_io_eprint", "stderr", false },
+    { "std_io_eprintln", "stderr", true },
+};
+
+static DirectWrite const* find_direct_write(IR_C_Node const* target, ASTNode const* call) {
+    if (target->type != ICNT_RAW || call->node.function_call.args.length != 1 || call->node.function_call.args.array[0].type != ANT_TEMPLATE_STRING) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < sizeof DIRECT_WRITES / sizeof *DIRECT_WRITES; ++i) {
+        if (str_eq(target->node.raw.str, c_str(DIRECT_WRITES[i].function))) {
+            return DIRECT_WRITES + i;
+        }
+    }
+
+    return NULL;
+}
+
+// gen: std_io_fwrite_*(stream, ...); // for each part
+static void fill_template_writes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node, char* stream, bool newline, FileType ftype, TransformStage stage) {
+    codegen->needs_std_io = true;
+
+    fill_template_parts(codegen, c_nodes, node, "std_io_fwrite_", (IR_C_Node){
+        .type = ICNT_RAW,
+        .node.raw.str = c_str(stream),
+    }, newline, ftype, stage);
+}
+
 static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node, FileType ftype, TransformStage stage, bool root_call) {
     assert(codegen);
     assert(c_nodes);
@@ -587,13 +787,14 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
             if (ftype == FT_C || stage != TS_MACROS) {
                 break; // c-files only import their header
             }
-            ResolvedType* type = codegen->packages->types[node->id.val].type;
+            TypeInfo ti = codegen->packages->types[node->id.val];
+            ResolvedType* type = ti.type;
 
             Package* pkg;
             if (type->kind == RTK_NAMESPACE) {
                 pkg = type->type.namespace_;
             } else {
-                pkg = type->from_pkg;
+                pkg = ti.namespace_;
             }
             assert(pkg->ast->type == ANT_FILE_ROOT);
 
@@ -654,12 +855,12 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                         assert(str_type);
                         assert(str_type->src);
                         assert(str_type->src->type == ANT_STRUCT_DECL);
-                        assert(str_type->src->node.struct_decl.maybe_name);
+                        assert(str_type->src->node.struct_decl->maybe_name);
 
                         StringBuffer sb = strbuf_create(codegen->arena);
                         strbuf_append_chars(&sb, "((std_String){");
                         // {
-                        //     String str_struct_name = user_var_name(codegen->arena, *str_type->src->node.struct_decl.maybe_name, str_type->from_pkg);
+                        //     String str_struct_name = user_var_name(codegen->arena, *str_type->src->node.struct_decl->maybe_name, str_type->from_pkg);
                         //     strbuf_append_str(&sb, str_struct_name);
                         // }
                         // strbuf_append_chars(&sb, "){");
@@ -731,13 +932,16 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
         case ANT_TEMPLATE_STRING: {
             codegen->needs_string_template = true;
 
-            String var_name = unique_var_name(codegen->arena);
-            String var_ptr;
+            String var_name = unique_var_name(codegen);
+            IR_C_Node var_ptr;
             {
                 StringBuffer sb = strbuf_create(codegen->arena);
                 strbuf_append_char(&sb, '&');
                 strbuf_append_str(&sb, var_name);
-                var_ptr = strbuf_to_str(sb);
+                var_ptr = (IR_C_Node){
+                    .type = ICNT_RAW,
+                    .node.raw.str = strbuf_to_str(sb),
+                };
             }
 
             // gen: StringBuffer sb = strbuf_default();
@@ -767,331 +971,8 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 });
             }
 
-            // gen: strbuf_append_chars(&sb, "..."); // first string part
-            {
-                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                *append_chars_target = (IR_C_Node){
-                    .type = ICNT_RAW,
-                    .node.raw.str = c_str("std_ds_strbuf_append_chars"),
-                };
-
-                LL_IR_C_Node append_chars_args = {0};
-                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                    .type = ICNT_RAW,
-                    .node.raw.str = var_ptr,
-                });
-
-                StringBuffer sb = strbuf_create(codegen->arena);
-                strbuf_append_char(&sb, '"');
-                strbuf_append_str(&sb, (String){
-                    .length = node->node.template_string.str_parts.array[0].length - 2,
-                    .chars = node->node.template_string.str_parts.array[0].chars + 1,
-                });
-                strbuf_append_char(&sb, '"');
-                String str_lit = strbuf_to_str(sb);
-                
-                if (str_lit.length > 2) {
-                    ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                        .type = ICNT_RAW,
-                        .node.raw.str = str_lit,
-                    });
-
-                    ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                        .type = ICNT_FUNCTION_CALL,
-                        .node.function_call = {
-                            .target = append_chars_target,
-                            .args = append_chars_args,
-                        },
-                    });
-                }
-            }
-
-            size_t i = 1;
-            LLNode_ASTNode* curr = node->node.template_string.template_expr_parts.head;
-            while (curr) {
-                assert(codegen->packages->types[curr->data.id.val].type);
-                if (curr->data.type == ANT_VAR_REF && !curr->data.node.var_ref.path->child && resolved_type_eq(codegen->packages->types[curr->data.id.val].type, codegen->packages->string_literal_type)) {
-                    IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                    *append_chars_target = (IR_C_Node){
-                        .type = ICNT_RAW,
-                        .node.raw.str = c_str("std_ds_strbuf_append_str"),
-                    };
-
-                    LL_IR_C_Node append_chars_args = {0};
-                    ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                        .type = ICNT_RAW,
-                        .node.raw.str = var_ptr,
-                    });
-                    {
-                        ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                            .type = ICNT_RAW,
-                            .node.raw = user_var_name(codegen->arena, curr->data.node.var_ref.path->name, codegen->current_package),
-                        });
-                    }
-
-                    ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                        .type = ICNT_FUNCTION_CALL,
-                        .node.function_call = {
-                            .target = append_chars_target,
-                            .args = append_chars_args,
-                        },
-                    });
-
-                } else {
-                    ResolvedType* rt = codegen->packages->types[curr->data.id.val].type;
-                    while (true) {
-                        assert(rt);
-
-                        switch (rt->kind) {
-                            case RTK_INT:
-                            case RTK_INT8:
-                            case RTK_INT16:
-                            case RTK_INT32:
-                            case RTK_INT64:
-                            {
-                                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                                *append_chars_target = (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = c_str("std_ds_strbuf_append_int"),
-                                };
-
-                                LL_IR_C_Node append_chars_args = {0};
-                                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = var_ptr,
-                                });
-                                {
-                                    LL_IR_C_Node expr_ll = {0};
-                                    fill_nodes(codegen, &expr_ll, &curr->data, ftype, stage, false);
-                                    assert(expr_ll.length == 1);
-
-                                    ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                        .type = ICNT_RAW_WRAP,
-                                        .node.raw_wrap = {
-                                            .pre = c_str("(int64_t)"),
-                                            .wrapped = &expr_ll.head->data,
-                                            .post = c_str(""),
-                                        },
-                                    });
-                                }
-
-                                ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                                    .type = ICNT_FUNCTION_CALL,
-                                    .node.function_call = {
-                                        .target = append_chars_target,
-                                        .args = append_chars_args,
-                                    },
-                                });
-
-                                break;
-                            }
-
-                            case RTK_UINT:
-                            case RTK_UINT8:
-                            case RTK_UINT16:
-                            case RTK_UINT32:
-                            case RTK_UINT64:
-                            {
-                                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                                *append_chars_target = (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = c_str("std_ds_strbuf_append_uint"),
-                                };
-
-                                LL_IR_C_Node append_chars_args = {0};
-                                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = var_ptr,
-                                });
-                                {
-                                    LL_IR_C_Node expr_ll = {0};
-                                    fill_nodes(codegen, &expr_ll, &curr->data, ftype, stage, false);
-                                    assert(expr_ll.length == 1);
-
-                                    ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                        .type = ICNT_RAW_WRAP,
-                                        .node.raw_wrap = {
-                                            .pre = c_str("(uint64_t)"),
-                                            .wrapped = &expr_ll.head->data,
-                                            .post = c_str(""),
-                                        },
-                                    });
-                                }
-
-                                ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                                    .type = ICNT_FUNCTION_CALL,
-                                    .node.function_call = {
-                                        .target = append_chars_target,
-                                        .args = append_chars_args,
-                                    },
-                                });
-
-                                break;
-                            }
-
-                            case RTK_CHAR: {
-                                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                                *append_chars_target = (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = c_str("std_ds_strbuf_append_char"),
-                                };
-
-                                LL_IR_C_Node append_chars_args = {0};
-                                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = var_ptr,
-                                });
-                                {
-                                    LL_IR_C_Node expr_ll = {0};
-                                    fill_nodes(codegen, &expr_ll, &curr->data, ftype, stage, false);
-                                    assert(expr_ll.length == 1);
-
-                                    ll_node_push(codegen->arena, &append_chars_args, expr_ll.head->data);
-                                }
-
-                                ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                                    .type = ICNT_FUNCTION_CALL,
-                                    .node.function_call = {
-                                        .target = append_chars_target,
-                                        .args = append_chars_args,
-                                    },
-                                });
-
-                                break;
-                            }
-
-                            case RTK_BOOL: {
-                                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                                *append_chars_target = (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = c_str("std_ds_strbuf_append_bool"),
-                                };
-
-                                LL_IR_C_Node append_chars_args = {0};
-                                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = var_ptr,
-                                });
-                                {
-                                    LL_IR_C_Node expr_ll = {0};
-                                    fill_nodes(codegen, &expr_ll, &curr->data, ftype, stage, false);
-                                    assert(expr_ll.length == 1);
-
-                                    ll_node_push(codegen->arena, &append_chars_args, expr_ll.head->data);
-                                }
-
-                                ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                                    .type = ICNT_FUNCTION_CALL,
-                                    .node.function_call = {
-                                        .target = append_chars_target,
-                                        .args = append_chars_args,
-                                    },
-                                });
-
-                                break;
-                            }
-
-                            case RTK_STRUCT_REF: {
-                                assert(resolved_type_eq(codegen->packages->types[curr->data.id.val].type, codegen->packages->string_literal_type));
-
-                                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                                *append_chars_target = (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = c_str("std_ds_strbuf_append_str"),
-                                };
-
-                                LL_IR_C_Node append_chars_args = {0};
-                                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                                    .type = ICNT_RAW,
-                                    .node.raw.str = var_ptr,
-                                });
-                                {
-                                    LL_IR_C_Node expr_ll = {0};
-                                    fill_nodes(codegen, &expr_ll, &curr->data, ftype, stage, false);
-                                    assert(expr_ll.length == 1);
-
-                                    ll_node_push(codegen->arena, &append_chars_args, expr_ll.head->data);
-                                }
-
-                                ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                                    .type = ICNT_FUNCTION_CALL,
-                                    .node.function_call = {
-                                        .target = append_chars_target,
-                                        .args = append_chars_args,
-                                    },
-                                });
-
-                                break;
-                            }
-
-                            case RTK_GENERIC: {
-                                int64_t mapped_idx = get_mapped_generic_idx(codegen->generic_map, rt->type.generic.name);
-                                if (mapped_idx < 0) {
-                                    println_astnode(*rt->src);
-                                    printf("Couldn't find %s\n", arena_strcpy(codegen->arena, rt->type.generic.name).chars);
-                                    print_generic_map(codegen->arena, codegen->generic_map);
-                                }
-                                assert(mapped_idx >= 0);
-
-                                while (codegen->generic_map->mapped_rtypes[mapped_idx].kind == RTK_GENERIC) {
-                                    int64_t next_idx = get_mapped_generic_idx(codegen->generic_map, codegen->generic_map->mapped_types[mapped_idx]);
-                                    while (next_idx >= 0) {
-                                        mapped_idx = next_idx;
-                                        next_idx = get_mapped_generic_idx(codegen->generic_map, codegen->generic_map->mapped_types[mapped_idx]);
-                                    }
-                                }
-
-                                rt = codegen->generic_map->mapped_rtypes + mapped_idx;
-
-                                continue;
-                            }
-
-                            default: printf("TODO: string template RTK_%d\n", codegen->packages->types[curr->data.id.val].type->kind); assert(false);
-                        }
-
-                        break; // while (true)
-                    }
-                }
-
-                IR_C_Node* append_chars_target = arena_alloc(codegen->arena, sizeof *append_chars_target);
-                *append_chars_target = (IR_C_Node){
-                    .type = ICNT_RAW,
-                    .node.raw.str = c_str("std_ds_strbuf_append_chars"),
-                };
-
-                LL_IR_C_Node append_chars_args = {0};
-                ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                    .type = ICNT_RAW,
-                    .node.raw.str = var_ptr,
-                });
-
-                StringBuffer sb = strbuf_create(codegen->arena);
-                strbuf_append_char(&sb, '"');
-                strbuf_append_str(&sb, (String){
-                    .length = node->node.template_string.str_parts.array[i].length - 2,
-                    .chars = node->node.template_string.str_parts.array[i].chars + 1,
-                });
-                strbuf_append_char(&sb, '"');
-                String str_lit = strbuf_to_str(sb);
-                
-                if (str_lit.length > 2) {
-                    ll_node_push(codegen->arena, &append_chars_args, (IR_C_Node){
-                        .type = ICNT_RAW,
-                        .node.raw.str = str_lit,
-                    });
-
-                    ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
-                        .type = ICNT_FUNCTION_CALL,
-                        .node.function_call = {
-                            .target = append_chars_target,
-                            .args = append_chars_args,
-                        },
-                    });
-                }
- 
-                i += 1;
-                curr = curr->next;
-            }
+            // gen: strbuf_append_*(&sb, ...); // for each part
+            fill_template_parts(codegen, codegen->stmt_block, node, "std_ds_strbuf_append_", var_ptr, false, ftype, stage);
 
             // gen: strbuf_to_str(sb);
             {
@@ -1191,9 +1072,9 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     child = child->child;
                 }
 
-                ResolvedType* type = codegen->packages->types[node->id.val].type;
+                TypeInfo ti = codegen->packages->types[node->id.val];
 
-                String name = user_var_name(codegen->arena, child->name, type ? type->from_pkg : NULL);
+                String name = user_var_name(codegen->arena, child->name, ti.namespace_);
 
                 ll_node_push(codegen->arena, c_nodes, (IR_C_Node){
                     .type = ICNT_RAW,
@@ -1225,7 +1106,7 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 case UO_PTR_REF: {
                     op = c_str("&");
                     if (node->node.unary_op.right->type == ANT_LITERAL) {
-                        String var_name = unique_var_name(codegen->arena);
+                        String var_name = unique_var_name(codegen);
                         String var_ptr;
                         {
                             StringBuffer sb = strbuf_create(codegen->arena);
@@ -1272,7 +1153,7 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                         });
                         already_done = true;
                     } else if (node->node.unary_op.right->type == ANT_ARRAY_INIT) {
-                        String var_name = unique_var_name(codegen->arena);
+                        String var_name = unique_var_name(codegen);
 
                         LL_IR_C_Node lit_ll = {0};
                         fill_nodes(codegen, &lit_ll, node->node.unary_op.right, ftype, stage, false);
@@ -1403,49 +1284,41 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
             IR_C_Node* target = arena_alloc(codegen->arena, sizeof *target);
             *target = target_ll.head->data;
 
+            DirectWrite const* direct_write = find_direct_write(target, node);
+            if (direct_write) {
+                fill_template_writes(codegen, c_nodes, node->node.function_call.args.array, direct_write->stream, direct_write->newline, ftype, stage);
+                break;
+            }
+
             if (target->type == ICNT_RAW && node->node.function_call.generic_args.length > 0) {
                 size_t version = node->node.function_call.impl_version;
                 {
                     ResolvedType* rt = codegen->packages->types[node->node.function_call.function->id.val].type;
                     if (rt && rt->kind == RTK_FUNCTION_DECL && rt->src) {
-                        LL_GenericImpl impls = codegen->packages->generic_impls_nodes_concrete[rt->src->id.val];
-                        // assert(impls.length > 0);
+                        GenericImpls* impls = codegen->packages->generic_impls_nodes_concrete + rt->src->id.val;
+                        // assert(impls->length > 0);
 
-                        if (impls.length == 1) {
+                        if (impls->length == 1) {
                             version = 0;
-                        } else if (impls.length > 0) {
-                            size_t impl_idx = 0;
-                            LLNode_GenericImpl* curr = impls.head;
-                            while (curr) {
-                                if (curr->data.length == node->node.function_call.generic_args.length) {
-                                    size_t idx = 0;
-                                    LLNode_Type* arg_curr = node->node.function_call.generic_args.head;
-                                    bool match = true;
-                                    while (arg_curr && idx < curr->data.length) {
-                                        TypeInfo* ti = packages_type_by_type(codegen->packages, arg_curr->data.id);
-                                        assert(ti);
-                                        assert(ti->type);
-
-                                        if (!resolved_type_eq(ti->type, curr->data.resolved_types[idx])) {
-                                            match = false;
-                                            break;
-                                        }
-
-                                        idx += 1;
-                                        arg_curr = arg_curr->next;
-                                    }
-                                    if (arg_curr || idx < curr->data.length) {
-                                        match = false;
-                                    }
-
-                                    if (match) {
-                                        version = impl_idx;
-                                        break;
-                                    }
-                                }
-
-                                impl_idx += 1;
-                                curr = curr->next;
+                        } else if (impls->length > 0) {
+                            GenericImpl call_impl = {
+                                .length = 0,
+                                .resolved_types = arena_calloc(codegen->arena, node->node.function_call.generic_args.length, sizeof(ResolvedType*)),
+                            };
+
+                            LLNode_Type* arg_curr = node->node.function_call.generic_args.head;
+                            while (arg_curr) {
+                                TypeInfo* ti = packages_type_by_type(codegen->packages, arg_curr->data.id);
+                                assert(ti);
+                                assert(ti->type);
+
+                                call_impl.resolved_types[call_impl.length++] = ti->type;
+                                arg_curr = arg_curr->next;
+                            }
+
+                            size_t found = generic_impls_find(impls, call_impl);
+                            if (found < impls->length) {
+                                version = found;
                             }
                         }
                     }
@@ -1460,10 +1333,9 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
             
             LL_IR_C_Node args = {0};
             {
-                LLNode_ASTNode* curr = node->node.function_call.args.head;
-                while (curr) {
-                    fill_nodes(codegen, &args, &curr->data, ftype, stage, false);
-                    curr = curr->next;
+                for (size_t i = 0; i < node->node.function_call.args.length; ++i) {
+                    ASTNode* curr = node->node.function_call.args.array + i;
+                    fill_nodes(codegen, &args, curr, ftype, stage, false);
                 }
             }
 
@@ -1495,6 +1367,7 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 },
             });
             codegen->stmt_block->to_defer = arena_alloc(codegen->arena, sizeof *codegen->stmt_block->to_defer);
+            *codegen->stmt_block->to_defer = (LL_IR_C_Node){0};
             break;
         }
 
@@ -1707,9 +1580,9 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 break;
             }
 
-            LL_GenericImpl generic_impls = codegen->packages->generic_impls_nodes_concrete[node->id.val];
+            GenericImpls generic_impls = codegen->packages->generic_impls_nodes_concrete[node->id.val];
 
-            if (node->node.function_decl.header.generic_params.length > 0 && generic_impls.length == 0) {
+            if (node->node.function_decl->header.generic_params.length > 0 && generic_impls.length == 0) {
                 break;
             }
 
@@ -1723,55 +1596,57 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     versions = 1;
                 }
 
-                if (node->node.function_decl.header.generic_params.length == 0) {
+                if (node->node.function_decl->header.generic_params.length == 0) {
                     assert(versions == 1);
                 }
 
                 GenericImplMap* root_map = codegen->generic_map;
 
-                LLNode_GenericImpl* generic_impls_curr = generic_impls.head;
                 for (size_t version = 0; version < versions; ++version) {
                     if (generic_impls.length > 0) {
-                        assert(generic_impls_curr);
+                        assert(version < generic_impls.length);
 
-                        GenericImpl generic_impl = generic_impls_curr->data;
+                        GenericImpl generic_impl = generic_impls.array[version];
 
                         if (generic_impl.length == 0 && versions > 1) {
                             continue;
                         }
 
-                        GenericImplMap map = {
+                        // kept in the arena, as codegen->generic_map points to it past this block
+                        GenericImplMap* map = arena_alloc(codegen->arena, sizeof *map);
+                        *map = (GenericImplMap){
                             .parent = root_map,
-                            .length = node->node.function_decl.header.generic_params.length,
-                            .generic_names = arena_calloc(codegen->arena, node->node.function_decl.header.generic_params.length, sizeof(String)),
-                            .mapped_types = arena_calloc(codegen->arena, node->node.function_decl.header.generic_params.length, sizeof(String)),
-                            .mapped_rtypes = arena_calloc(codegen->arena, node->node.function_decl.header.generic_params.length, sizeof(ResolvedType)),
+                            .length = node->node.function_decl->header.generic_params.length,
+                            .generic_names = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(String)),
+                            .generic_symbols = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(Symbol)),
+                            .mapped_types = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(String)),
+                            .mapped_rtypes = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(ResolvedType*)),
                         };
                         {
                             ResolvedType* curr = generic_impl.resolved_types[0];
-                            for (size_t i = 0; curr && i < node->node.function_decl.header.generic_params.length; ++i) {
-                                map.generic_names[i] = node->node.function_decl.header.generic_params.array[i];
-                                map.mapped_types[i] = gen_type_resolved(codegen, curr);
-                                map.mapped_rtypes[i] = *curr;
+                            for (size_t i = 0; curr && i < node->node.function_decl->header.generic_params.length; ++i) {
+                                map->generic_names[i] = node->node.function_decl->header.generic_params.array[i];
+                                map->generic_symbols[i] = intern(map->generic_names[i]);
+                                map->mapped_types[i] = gen_type_resolved(codegen, curr);
+                                map->mapped_rtypes[i] = curr;
                                 curr = generic_impl.resolved_types[i + 1];
                             }
                         }
-                        codegen->generic_map = &map;
+                        codegen->generic_map = map;
                     }
 
                     Strings params = {
                         .length = 0,
-                        .strings = arena_calloc(codegen->arena, node->node.function_decl.header.params.length, sizeof(String)),
+                        .strings = arena_calloc(codegen->arena, node->node.function_decl->header.params.length, sizeof(String)),
                     };
                     {
                         StringBuffer sb = strbuf_create(codegen->arena);
 
-                        LLNode_FnParam* curr = node->node.function_decl.header.params.head;
+                        LLNode_FnParam* curr = node->node.function_decl->header.params.head;
                         while (curr) {
                             TypeInfo* curr_ti = packages_type_by_type(codegen->packages, curr->data.type.id);
                             assert(curr_ti);
                             assert(curr_ti->type);
-                            assert(curr_ti->type->from_pkg);
 
                             // strbuf_append_str(&sb, gen_type(codegen, curr->data.type, curr_ti->type->from_pkg));
                             strbuf_append_str(&sb, gen_type_resolved(codegen, curr_ti->type));
@@ -1787,7 +1662,7 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
 
                     String return_type;
                     {
-                        TypeInfo* ti = packages_type_by_type(codegen->packages, node->node.function_decl.header.return_type.id);
+                        TypeInfo* ti = packages_type_by_type(codegen->packages, node->node.function_decl->header.return_type.id);
                         assert(ti);
                         assert(ti->type);
 
@@ -1796,17 +1671,17 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     }
 
                     String name;
-                    if (node->node.function_decl.header.is_main) {
+                    if (node->node.function_decl->header.is_main) {
                         name = c_str("_main");
                     } else {
                         name = user_var_name(
                             codegen->arena,
-                            node->node.function_decl.header.name,
+                            node->node.function_decl->header.name,
                             type->from_pkg
                         );
                     }
 
-                    if (node->node.function_decl.header.generic_params.length > 0) {
+                    if (node->node.function_decl->header.generic_params.length > 0) {
                         StringBuffer sb = strbuf_create_with_capacity(codegen->arena, name.length + 3);
                         strbuf_append_str(&sb, name);
                         strbuf_append_chars(&sb, "_");
@@ -1824,9 +1699,6 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     });
 
                     codegen->generic_map = root_map;
-                    if (generic_impls_curr) {
-                        generic_impls_curr = generic_impls_curr->next;
-                    }
                 }
                 break;
             }
@@ -1844,55 +1716,56 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 versions = 1;
             }
 
-            if (node->node.function_decl.header.generic_params.length == 0) {
+            if (node->node.function_decl->header.generic_params.length == 0) {
                 assert(versions == 1);
             }
 
             GenericImplMap* root_map = codegen->generic_map;
 
-            LLNode_GenericImpl* generic_impls_curr = generic_impls.head;
             for (size_t version = 0; version < versions; ++version) {
                 if (generic_impls.length > 0) {
-                    assert(generic_impls_curr);
+                    assert(version < generic_impls.length);
 
-                    GenericImpl generic_impl = generic_impls_curr->data;
+                    GenericImpl generic_impl = generic_impls.array[version];
 
                     if (generic_impl.length == 0 && versions > 1) {
                         continue;
                     }
 
-                    GenericImplMap map = {
+                    GenericImplMap* map = arena_alloc(codegen->arena, sizeof *map);
+                    *map = (GenericImplMap){
                         .parent = root_map,
-                        .length = node->node.function_decl.header.generic_params.length,
-                        .generic_names = arena_calloc(codegen->arena, node->node.function_decl.header.generic_params.length, sizeof(String)),
-                        .mapped_types = arena_calloc(codegen->arena, node->node.function_decl.header.generic_params.length, sizeof(String)),
-                        .mapped_rtypes = arena_calloc(codegen->arena, node->node.function_decl.header.generic_params.length, sizeof(ResolvedType)),
+                        .length = node->node.function_decl->header.generic_params.length,
+                        .generic_names = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(String)),
+                        .generic_symbols = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(Symbol)),
+                        .mapped_types = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(String)),
+                        .mapped_rtypes = arena_calloc(codegen->arena, node->node.function_decl->header.generic_params.length, sizeof(ResolvedType*)),
                     };
                     {
                         ResolvedType* curr = generic_impl.resolved_types[0];
-                        for (size_t i = 0; curr && i < node->node.function_decl.header.generic_params.length; ++i) {
-                            map.generic_names[i] = node->node.function_decl.header.generic_params.array[i];
-                            map.mapped_types[i] = gen_type_resolved(codegen, curr);
-                            map.mapped_rtypes[i] = *curr;
+                        for (size_t i = 0; curr && i < node->node.function_decl->header.generic_params.length; ++i) {
+                            map->generic_names[i] = node->node.function_decl->header.generic_params.array[i];
+                            map->generic_symbols[i] = intern(map->generic_names[i]);
+                            map->mapped_types[i] = gen_type_resolved(codegen, curr);
+                            map->mapped_rtypes[i] = curr;
                             curr = generic_impl.resolved_types[i + 1];
                         }
                     }
-                    codegen->generic_map = &map;
+                    codegen->generic_map = map;
                 }
 
                 Strings params = {
                     .length = 0,
-                    .strings = arena_calloc(codegen->arena, node->node.function_decl.header.params.length, sizeof(String)),
+                    .strings = arena_calloc(codegen->arena, node->node.function_decl->header.params.length, sizeof(String)),
                 };
                 {
                     StringBuffer sb = strbuf_create(codegen->arena);
 
-                    LLNode_FnParam* curr = node->node.function_decl.header.params.head;
+                    LLNode_FnParam* curr = node->node.function_decl->header.params.head;
                     while (curr) {
                         TypeInfo* curr_ti = packages_type_by_type(codegen->packages, curr->data.type.id);
                         assert(curr_ti);
-                        assert(curr_ti->type);
-                        assert(curr_ti->type->from_pkg);
+                            assert(curr_ti->type);
 
                         // strbuf_append_str(&sb, gen_type(codegen, curr->data.type, curr_ti->type->from_pkg));
                         strbuf_append_str(&sb, gen_type_resolved(codegen, curr_ti->type));
@@ -1913,17 +1786,16 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
 
                 codegen->stmt_block = &statements;
                 {
-                    LLNode_ASTNode* curr = node->node.function_decl.stmts.head;
-                    while (curr) {
-                        fill_nodes(codegen, &statements, &curr->data, ftype, stage, false);
-                        curr = curr->next;
+                    for (size_t i = 0; i < node->node.function_decl->stmts.length; ++i) {
+                        ASTNode* curr = node->node.function_decl->stmts.array + i;
+                        fill_nodes(codegen, &statements, curr, ftype, stage, false);
                     }
                 }
                 codegen->stmt_block = NULL;
 
                 String return_type;
                 {
-                    TypeInfo* ti = packages_type_by_type(codegen->packages, node->node.function_decl.header.return_type.id);
+                    TypeInfo* ti = packages_type_by_type(codegen->packages, node->node.function_decl->header.return_type.id);
                     assert(ti);
                     assert(ti->type);
 
@@ -1931,17 +1803,17 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 }
 
                 String name;
-                if (node->node.function_decl.header.is_main) {
+                if (node->node.function_decl->header.is_main) {
                     name = c_str("_main");
                 } else {
                     name = user_var_name(
                         codegen->arena,
-                        node->node.function_decl.header.name,
+                        node->node.function_decl->header.name,
                         type->from_pkg
                     );
                 }
 
-                if (node->node.function_decl.header.generic_params.length > 0) {
+                if (node->node.function_decl->header.generic_params.length > 0) {
                     StringBuffer sb = strbuf_create_with_capacity(codegen->arena, name.length + 3);
                     strbuf_append_str(&sb, name);
                     strbuf_append_chars(&sb, "_");
@@ -1959,10 +1831,6 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     },
                 });
                 codegen->generic_map = root_map;
-
-                if (generic_impls_curr) {
-                    generic_impls_curr = generic_impls_curr->next;
-                }
             }
             break;
         }
@@ -1971,11 +1839,11 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
             if (root_call && (ftype == FT_C || stage != TS_TYPES)) {
                 break;
             }
-            assert(node->node.struct_decl.maybe_name);
+            assert(node->node.struct_decl->maybe_name);
 
-            LL_GenericImpl generic_impls = codegen->packages->generic_impls_nodes_concrete[node->id.val];
+            GenericImpls generic_impls = codegen->packages->generic_impls_nodes_concrete[node->id.val];
 
-            if (node->node.struct_decl.generic_params.length > 0 && generic_impls.length == 0) {
+            if (node->node.struct_decl->generic_params.length > 0 && generic_impls.length == 0) {
                 break;
             }
 
@@ -1988,63 +1856,68 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 versions = 1;
             }
 
-            if (node->node.struct_decl.generic_params.length == 0) {
+            if (node->node.struct_decl->generic_params.length == 0) {
                 assert(versions == 1);
             }
 
             GenericImplMap* root_map = codegen->generic_map;
 
-            LLNode_GenericImpl* generic_impls_curr = generic_impls.head;
-            printf("struct %s has %lu versions.\n",
-                arena_strcpy(codegen->arena, *node->node.struct_decl.maybe_name).chars,
-                versions
-            );
+            bool const dump = log_dumps(LOG_DUMP_GENERICS);
+            if (dump) {
+                printf("struct %s has %lu versions.\n",
+                    arena_strcpy(codegen->arena, *node->node.struct_decl->maybe_name).chars,
+                    versions
+                );
+            }
             for (size_t version = 0; version < versions; ++version) {
-                printf("Version %lu\n", version);
+                if (dump) {
+                    printf("Version %lu\n", version);
+                }
                 if (generic_impls.length > 0) {
-                    assert(generic_impls_curr);
+                    assert(version < generic_impls.length);
 
-                    GenericImpl generic_impl = generic_impls_curr->data;
+                    GenericImpl generic_impl = generic_impls.array[version];
 
                     if (generic_impl.length == 0 && versions > 1) {
-                        printf("Ignoring version %lu\n", version);
-                        codegen->generic_map = root_map;
-
-                        if (generic_impls_curr) {
-                            generic_impls_curr = generic_impls_curr->next;
+                        if (dump) {
+                            printf("Ignoring version %lu\n", version);
                         }
+                        codegen->generic_map = root_map;
                         continue;
                     }
 
-                    GenericImplMap map = {
+                    GenericImplMap* map = arena_alloc(codegen->arena, sizeof *map);
+                    *map = (GenericImplMap){
                         .parent = root_map,
-                        .length = node->node.struct_decl.generic_params.length,
-                        .generic_names = arena_calloc(codegen->arena, node->node.struct_decl.generic_params.length, sizeof(String)),
-                        .mapped_types = arena_calloc(codegen->arena, node->node.struct_decl.generic_params.length, sizeof(String)),
-                        .mapped_rtypes = arena_calloc(codegen->arena, node->node.struct_decl.generic_params.length, sizeof(ResolvedType)),
+                        .length = node->node.struct_decl->generic_params.length,
+                        .generic_names = arena_calloc(codegen->arena, node->node.struct_decl->generic_params.length, sizeof(String)),
+                        .generic_symbols = arena_calloc(codegen->arena, node->node.struct_decl->generic_params.length, sizeof(Symbol)),
+                        .mapped_types = arena_calloc(codegen->arena, node->node.struct_decl->generic_params.length, sizeof(String)),
+                        .mapped_rtypes = arena_calloc(codegen->arena, node->node.struct_decl->generic_params.length, sizeof(ResolvedType*)),
                     };
                     {
                         ResolvedType* curr = generic_impl.resolved_types[0];
-                        for (size_t i = 0; curr && i < node->node.struct_decl.generic_params.length; ++i) {
-                            map.generic_names[i] = node->node.struct_decl.generic_params.array[i];
-                            map.mapped_types[i] = gen_type_resolved(codegen, curr);
-                            map.mapped_rtypes[i] = *curr;
+                        for (size_t i = 0; curr && i < node->node.struct_decl->generic_params.length; ++i) {
+                            map->generic_names[i] = node->node.struct_decl->generic_params.array[i];
+                            map->generic_symbols[i] = intern(map->generic_names[i]);
+                            map->mapped_types[i] = gen_type_resolved(codegen, curr);
+                            map->mapped_rtypes[i] = curr;
 
                             curr = generic_impl.resolved_types[i + 1];
                         }
                     }
-                    codegen->generic_map = &map;
+                    codegen->generic_map = map;
                 }
 
                 Strings fields = {
                     .length = 0,
-                    .strings = arena_calloc(codegen->arena, node->node.struct_decl.fields.length, sizeof(String)),
+                    .strings = arena_calloc(codegen->arena, node->node.struct_decl->fields.length, sizeof(String)),
                 };
                 {
                     StringBuffer sb = strbuf_create(codegen->arena);
 
                     size_t i = 0;
-                    LLNode_StructField* curr = node->node.struct_decl.fields.head;
+                    LLNode_StructField* curr = node->node.struct_decl->fields.head;
                     bool ok = true;
                     while (curr) {
                         if (type->type.struct_decl.fields[i].type->kind == RTK_GENERIC && !get_mapped_generic(codegen->generic_map, type->type.struct_decl.fields[i].type->type.generic.name)) {
@@ -2054,10 +1927,12 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                         
                         String type_str = gen_type_resolved(codegen, type->type.struct_decl.fields[i].type);
 
-                        printf(".%s = %s\n",
-                            arena_strcpy(codegen->arena, type->type.struct_decl.fields[i].name).chars,
-                            arena_strcpy(codegen->arena, type_str).chars
-                        );
+                        if (dump) {
+                            printf(".%s = %s\n",
+                                arena_strcpy(codegen->arena, type->type.struct_decl.fields[i].name).chars,
+                                arena_strcpy(codegen->arena, type_str).chars
+                            );
+                        }
 
                         if (version > 0 && str_eq(type_str, c_str("struct main_Foo_0"))) {
                             printf("RTK_%d\n", type->type.struct_decl.fields[i].type->kind);
@@ -2076,22 +1951,18 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     }
                     if (!ok) {
                         codegen->generic_map = root_map;
-
-                        if (generic_impls_curr) {
-                            generic_impls_curr = generic_impls_curr->next;
-                        }
                         continue;
                     }
                 }
 
-                assert(node->node.struct_decl.maybe_name);
+                assert(node->node.struct_decl->maybe_name);
                 String name = user_var_name(
                     codegen->arena,
-                    *node->node.struct_decl.maybe_name,
+                    *node->node.struct_decl->maybe_name,
                     type->from_pkg
                 );
 
-                if (node->node.struct_decl.generic_params.length > 0) {
+                if (node->node.struct_decl->generic_params.length > 0) {
                     StringBuffer sb = strbuf_create_with_capacity(codegen->arena, name.length + 3);
                     strbuf_append_str(&sb, name);
                     strbuf_append_chars(&sb, "_");
@@ -2107,13 +1978,9 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                     },
                 });
                 codegen->generic_map = root_map;
-
-                if (generic_impls_curr) {
-                    generic_impls_curr = generic_impls_curr->next;
-                }
             }
 
-            // if (str_eq(*node->node.struct_decl.maybe_name, c_str("Result"))) {
+            // if (str_eq(*node->node.struct_decl->maybe_name, c_str("Result"))) {
             //     assert(false);
             // }
 
@@ -2136,7 +2003,16 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
         }
 
         case ANT_CRASH: {
-            if (node->node.crash.maybe_expr) {
+            if (node->node.crash.maybe_expr && node->node.crash.maybe_expr->type == ANT_TEMPLATE_STRING) {
+                codegen->needs_std = true;
+
+                fill_template_writes(codegen, codegen->stmt_block, node->node.crash.maybe_expr, "stderr", true, ftype, stage);
+
+                ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
+                    .type = ICNT_RAW,
+                    .node.raw.str = c_str("std_exit(1);\n"),
+                });
+            } else if (node->node.crash.maybe_expr) {
                 codegen->needs_std = true;
                 codegen->needs_std_io = true;
 
@@ -2217,12 +2093,10 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 .to_defer = codegen->stmt_block->to_defer,
             };
 
-            LLNode_ASTNode* curr = node->node.while_.block->stmts.head;
             LL_IR_C_Node* prev_block = codegen->stmt_block;
             codegen->stmt_block = &then;
-            while (curr) {
-                fill_nodes(codegen, &then, &curr->data, ftype, stage, false);
-                curr = curr->next;
+            for (size_t i = 0; i < node->node.while_.block->stmts.length; ++i) {
+                fill_nodes(codegen, &then, node->node.while_.block->stmts.array + i, ftype, stage, false);
             }
             codegen->stmt_block = prev_block;
 
@@ -2252,7 +2126,7 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
 
             String iter_type = gen_type_resolved(codegen, codegen->packages->types[node->node.foreach.iterable->id.val].type);
 
-            String var_range_name = unique_var_name(codegen->arena);
+            String var_range_name = unique_var_name(codegen);
 
             ll_node_push(codegen->arena, codegen->stmt_block, (IR_C_Node){
                 .type = ICNT_VAR_DECL,
@@ -2266,7 +2140,7 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
             String var_i_name = user_var_name(
                 codegen->arena,
                 node->node.foreach.var.lhs.name,
-                rt->from_pkg
+                codegen->current_package
             );
 
             IR_C_Node* for_init = arena_alloc(codegen->arena, sizeof *for_init);
@@ -2320,12 +2194,10 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 .to_defer = codegen->stmt_block->to_defer,
             };
 
-            LLNode_ASTNode* curr = node->node.foreach.block->stmts.head;
             LL_IR_C_Node* prev_block = codegen->stmt_block;
             codegen->stmt_block = &then;
-            while (curr) {
-                fill_nodes(codegen, &then, &curr->data, ftype, stage, false);
-                curr = curr->next;
+            for (size_t i = 0; i < node->node.foreach.block->stmts.length; ++i) {
+                fill_nodes(codegen, &then, node->node.foreach.block->stmts.array + i, ftype, stage, false);
             }
             codegen->stmt_block = prev_block;
 
@@ -2388,12 +2260,10 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
                 .to_defer = codegen->stmt_block->to_defer,
             };
 
-            LLNode_ASTNode* curr = node->node.if_.block->stmts.head;
             LL_IR_C_Node* prev_block = codegen->stmt_block;
             codegen->stmt_block = &then;
-            while (curr) {
-                fill_nodes(codegen, &then, &curr->data, ftype, stage, false);
-                curr = curr->next;
+            for (size_t i = 0; i < node->node.if_.block->stmts.length; ++i) {
+                fill_nodes(codegen, &then, node->node.if_.block->stmts.array + i, ftype, stage, false);
             }
             codegen->stmt_block = prev_block;
 
@@ -2439,10 +2309,9 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
             LL_IR_C_Node* prev_block = codegen->stmt_block;
             codegen->stmt_block = &then;
 
-            LLNode_ASTNode* curr = node->node.statement_block.stmts.head;
-            while (curr) {
-                fill_nodes(codegen, &then, &curr->data, ftype, stage, false);
-                curr = curr->next;
+            for (size_t i = 0; i < node->node.statement_block.stmts.length; ++i) {
+                ASTNode* curr = node->node.statement_block.stmts.array + i;
+                fill_nodes(codegen, &then, curr, ftype, stage, false);
             }
             codegen->stmt_block = prev_block;
 
@@ -2466,10 +2335,9 @@ static void fill_nodes(CodegenC* codegen, LL_IR_C_Node* c_nodes, ASTNode* node,
 
         case ANT_TUPLE: {
             LL_IR_C_Node exprs = {0};
-            LLNode_ASTNode* curr = node->node.tuple.exprs.head;
-            while (curr) {
-                fill_nodes(codegen, &exprs, &curr->data, ftype, stage, false);
-                curr = curr->next;
+            for (size_t i = 0; i < node->node.tuple.exprs.length; ++i) {
+                ASTNode* curr = node->node.tuple.exprs.array + i;
+                fill_nodes(codegen, &exprs, curr, ftype, stage, false);
             }
 
             if (exprs.length == 1) {
@@ -2531,6 +2399,7 @@ static LL_IR_C_Node transform_to_nodes(CodegenC* codegen, Package* package, File
     assert(package);
 
     codegen->current_package = package;
+    codegen->next_temp_id = 0;
 
     LL_IR_C_Node nodes = {0};
 
@@ -2571,10 +2440,12 @@ static LL_IR_C_Node transform_to_nodes(CodegenC* codegen, Package* package, File
 
     for (TransformStage stage = 0; stage < TS_COUNT; ++stage) {
         assert(package->ast->type == ANT_FILE_ROOT);
-        LLNode_ASTNode* curr = package->ast->node.file_root.nodes.head;
-        while (curr) {
-            fill_nodes(codegen, &nodes, &curr->data, ftype, stage, true);
-            curr = curr->next;
+        for (size_t i = 0; i < package->ast->node.file_root.nodes.length; ++i) {
+            ASTNode* curr = package->ast->node.file_root.nodes.array + i;
+            if (codegen->reachability && !reachability_keeps(codegen->reachability, curr)) {
+                continue;
+            }
+            fill_nodes(codegen, &nodes, curr, ftype, stage, true);
         }
     }
 
@@ -2691,22 +2562,22 @@ static LL_IR_C_Node transform_to_nodes(CodegenC* codegen, Package* package, File
     return nodes;
 }
 
-static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
+static void append_ir_node(FileWriter* out, IR_C_Node* node, size_t indent) {
     switch (node->type) {
         case ICNT_RAW: {
-            strbuf_append_str(sb, node->node.raw.str);
+            file_writer_write_str(out, node->node.raw.str);
             break;
         }
 
         case ICNT_RAW_WRAP: {
-            strbuf_append_str(sb, node->node.raw_wrap.pre);
-            append_ir_node(sb, node->node.raw_wrap.wrapped, indent);
-            strbuf_append_str(sb, node->node.raw_wrap.post);
+            file_writer_write_str(out, node->node.raw_wrap.pre);
+            append_ir_node(out, node->node.raw_wrap.wrapped, indent);
+            file_writer_write_str(out, node->node.raw_wrap.post);
             break;
         }
 
         case ICNT_BLOCK: {
-            strbuf_append_chars(sb, "{\n");
+            file_writer_write_chars(out, "{\n");
             indent += 1;
 
             LL_IR_C_Node block = node->node.block.nodes;
@@ -2714,13 +2585,13 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
             size_t idx = 0;
             bool is_defers = false;
             while (curr) {
-                for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                append_ir_node(sb, &curr->data, indent);
-                if (sb->chars[sb->length - 1] != ';' && sb->chars[sb->length - 1] != '\n') {
-                    if (sb->chars[sb->length - 1] != '\n') {
-                        strbuf_append_chars(sb, ";\n");
+                for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                append_ir_node(out, &curr->data, indent);
+                if (out->last != ';' && out->last != '\n') {
+                    if (out->last != '\n') {
+                        file_writer_write_chars(out, ";\n");
                     } else {
-                        strbuf_append_char(sb, ';');
+                        file_writer_write_char(out, ';');
                     }
                 }
 
@@ -2739,113 +2610,113 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
             }
 
             indent -= 1;
-            for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-            strbuf_append_chars(sb, "}\n");
+            for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+            file_writer_write_chars(out, "}\n");
 
             break;
         }
 
         case ICNT_MACRO_IFNDEF: {
-            strbuf_append_chars(sb, "#ifndef ");
-            strbuf_append_str(sb, node->node.ifndef.condition);
+            file_writer_write_chars(out, "#ifndef ");
+            file_writer_write_str(out, node->node.ifndef.condition);
             break;
         }
 
         case ICNT_MACRO_ENDIF: {
-            strbuf_append_chars(sb, "#endif");
+            file_writer_write_chars(out, "#endif");
             break;
         }
 
         case ICNT_MACRO_DEFINE: {
-            strbuf_append_chars(sb, "#define ");
-            strbuf_append_str(sb, node->node.define.name);
+            file_writer_write_chars(out, "#define ");
+            file_writer_write_str(out, node->node.define.name);
 
             if (node->node.define.maybe_value) {
-                strbuf_append_char(sb, ' ');
-                strbuf_append_str(sb, *node->node.define.maybe_value);
+                file_writer_write_char(out, ' ');
+                file_writer_write_str(out, *node->node.define.maybe_value);
             }
 
             break;
         }
 
         case ICNT_MACRO_INCLUDE: {
-            strbuf_append_chars(sb, "#include ");
+            file_writer_write_chars(out, "#include ");
             if (node->node.include.is_local) {
-                strbuf_append_char(sb, '"');
+                file_writer_write_char(out, '"');
             } else {
                 // already in string
-                // strbuf_append_char(sb, '<');
+                // file_writer_write_char(out, '<');
             }
 
-            strbuf_append_str(sb, node->node.include.file);
+            file_writer_write_str(out, node->node.include.file);
 
             if (node->node.include.is_local) {
-                strbuf_append_char(sb, '"');
+                file_writer_write_char(out, '"');
             } else {
                 // already in string
-                // strbuf_append_char(sb, '>');
+                // file_writer_write_char(out, '>');
             }
             break;
         }
 
         case ICNT_ARRAY_INIT: {
-            strbuf_append_char(sb, '{');
+            file_writer_write_char(out, '{');
             for (size_t i = 0; i < node->node.array_init.elems_length; ++i) {
                 if (node->node.array_init.indicies[i].type != ICNT_COUNT) {
-                    strbuf_append_char(sb, '[');
-                    append_ir_node(sb, node->node.array_init.indicies + i, indent);
-                    strbuf_append_chars(sb, "] = ");
+                    file_writer_write_char(out, '[');
+                    append_ir_node(out, node->node.array_init.indicies + i, indent);
+                    file_writer_write_chars(out, "] = ");
                 }
-                append_ir_node(sb, node->node.array_init.elems + i, indent);
+                append_ir_node(out, node->node.array_init.elems + i, indent);
 
                 if (i + 1 < node->node.array_init.elems_length) {
-                    strbuf_append_chars(sb, ", ");
+                    file_writer_write_chars(out, ", ");
                 }
             }
-            strbuf_append_char(sb, '}');
+            file_writer_write_char(out, '}');
             break;
         }
 
         case ICNT_GET_FIELD: {
-            append_ir_node(sb, node->node.get_field.root, indent);
+            append_ir_node(out, node->node.get_field.root, indent);
             if (node->node.get_field.is_ptr) {
-                strbuf_append_chars(sb, "->");
+                file_writer_write_chars(out, "->");
             } else {
-                strbuf_append_char(sb, '.');
+                file_writer_write_char(out, '.');
             }
-            strbuf_append_str(sb, node->node.get_field.name);
+            file_writer_write_str(out, node->node.get_field.name);
             break;
         }
 
         case ICNT_SIZEOF_EXPR: {
-            strbuf_append_chars(sb, "sizeof(");
-            append_ir_node(sb, node->node.sizeof_expr.expr, indent);
-            strbuf_append_char(sb, ')');
+            file_writer_write_chars(out, "sizeof(");
+            append_ir_node(out, node->node.sizeof_expr.expr, indent);
+            file_writer_write_char(out, ')');
             break;
         }
 
         case ICNT_SIZEOF_TYPE: {
-            strbuf_append_chars(sb, "sizeof(");
-            strbuf_append_str(sb, node->node.sizeof_type.type);
-            strbuf_append_char(sb, ')');
+            file_writer_write_chars(out, "sizeof(");
+            file_writer_write_str(out, node->node.sizeof_type.type);
+            file_writer_write_char(out, ')');
             break;
         }
 
         case ICNT_FUNCTION_CALL: {
-            append_ir_node(sb, node->node.function_call.target, indent);
-            strbuf_append_char(sb, '(');
+            append_ir_node(out, node->node.function_call.target, indent);
+            file_writer_write_char(out, '(');
             {
                 LLNode_IR_C_Node* curr = node->node.function_call.args.head;
                 while (curr) {
-                    append_ir_node(sb, &curr->data, indent);
+                    append_ir_node(out, &curr->data, indent);
                     curr = curr->next;
 
                     if (curr) {
-                        strbuf_append_chars(sb, ", ");
+                        file_writer_write_chars(out, ", ");
                     }
                 }
             }
-            strbuf_append_char(sb, ')');
+            file_writer_write_char(out, ')');
             break;
         }
 
@@ -2866,12 +2737,12 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
                 }
 
                 while (curr) {
-                    append_ir_node(sb, &curr->data, indent);
-                    if (sb->chars[sb->length - 1] != ';' && sb->chars[sb->length - 1] != '\n') {
-                        if (sb->chars[sb->length - 1] != '\n') {
-                            strbuf_append_chars(sb, ";\n");
+                    append_ir_node(out, &curr->data, indent);
+                    if (out->last != ';' && out->last != '\n') {
+                        if (out->last != '\n') {
+                            file_writer_write_chars(out, ";\n");
                         } else {
-                            strbuf_append_char(sb, ';');
+                            file_writer_write_char(out, ';');
                         }
                     }
                     curr = curr->next;
@@ -2887,93 +2758,93 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
                             break;
                         }
                     }
-                    for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
+                    for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
                     if (should_break) {
                         break;
                     }
                 }
             }
 
-            strbuf_append_chars(sb, "return");
+            file_writer_write_chars(out, "return");
             if (node->node.return_.expr) {
-                strbuf_append_char(sb, ' ');
-                append_ir_node(sb, node->node.return_.expr, indent);
+                file_writer_write_char(out, ' ');
+                append_ir_node(out, node->node.return_.expr, indent);
             }
             break;
         }
 
         case ICNT_BINARY_OP: {
-            append_ir_node(sb, node->node.binary_op.lhs, indent);
-            strbuf_append_char(sb, ' ');
-            strbuf_append_str(sb, node->node.binary_op.op);
-            strbuf_append_char(sb, ' ');
-            append_ir_node(sb, node->node.binary_op.rhs, indent);
+            append_ir_node(out, node->node.binary_op.lhs, indent);
+            file_writer_write_char(out, ' ');
+            file_writer_write_str(out, node->node.binary_op.op);
+            file_writer_write_char(out, ' ');
+            append_ir_node(out, node->node.binary_op.rhs, indent);
             break;
         }
 
         case ICNT_VAR_DECL: {
-            strbuf_append_str(sb, node->node.var_decl.type);
-            strbuf_append_char(sb, ' ');
-            strbuf_append_str(sb, node->node.var_decl.name);
+            file_writer_write_str(out, node->node.var_decl.type);
+            file_writer_write_char(out, ' ');
+            file_writer_write_str(out, node->node.var_decl.name);
 
             if (node->node.var_decl.init) {
-                strbuf_append_chars(sb, " = ");
-                append_ir_node(sb, node->node.var_decl.init, indent);
+                file_writer_write_chars(out, " = ");
+                append_ir_node(out, node->node.var_decl.init, indent);
             }
             
             break;
         }
 
         case ICNT_FUNCTION_HEADER_DECL: {
-            strbuf_append_str(sb, node->node.function_header_decl.return_type);
-            strbuf_append_char(sb, ' ');
-            strbuf_append_str(sb, node->node.function_header_decl.name);
-            strbuf_append_char(sb, '(');
+            file_writer_write_str(out, node->node.function_header_decl.return_type);
+            file_writer_write_char(out, ' ');
+            file_writer_write_str(out, node->node.function_header_decl.name);
+            file_writer_write_char(out, '(');
             if (node->node.function_header_decl.params.length == 0) {
-                strbuf_append_chars(sb, "void");
+                file_writer_write_chars(out, "void");
             } else {
                 for (size_t i = 0; i < node->node.function_header_decl.params.length; ++i) {
-                    strbuf_append_str(sb, node->node.function_header_decl.params.strings[i]);
+                    file_writer_write_str(out, node->node.function_header_decl.params.strings[i]);
 
                     if (i + 1 < node->node.function_header_decl.params.length) {
-                        strbuf_append_chars(sb, ", ");
+                        file_writer_write_chars(out, ", ");
                     }
                 }
             }
-            strbuf_append_chars(sb, ");");
+            file_writer_write_chars(out, ");");
             break;
         }
 
         case ICNT_FUNCTION_DECL: {
-            strbuf_append_str(sb, node->node.function_decl.return_type);
-            strbuf_append_char(sb, ' ');
-            strbuf_append_str(sb, node->node.function_decl.name);
-            strbuf_append_char(sb, '(');
+            file_writer_write_str(out, node->node.function_decl.return_type);
+            file_writer_write_char(out, ' ');
+            file_writer_write_str(out, node->node.function_decl.name);
+            file_writer_write_char(out, '(');
             if (node->node.function_decl.params.length == 0) {
-                strbuf_append_chars(sb, "void");
+                file_writer_write_chars(out, "void");
             } else {
                 for (size_t i = 0; i < node->node.function_decl.params.length; ++i) {
-                    strbuf_append_str(sb, node->node.function_decl.params.strings[i]);
+                    file_writer_write_str(out, node->node.function_decl.params.strings[i]);
 
                     if (i + 1 < node->node.function_decl.params.length) {
-                        strbuf_append_chars(sb, ", ");
+                        file_writer_write_chars(out, ", ");
                     }
                 }
             }
-            strbuf_append_chars(sb, ") {\n");
+            file_writer_write_chars(out, ") {\n");
             {
                 LL_IR_C_Node block = node->node.function_decl.statements;
                 LLNode_IR_C_Node* curr = block.head;
                 size_t idx = 0;
                 indent += 1;
                 while (curr) {
-                    for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                    append_ir_node(sb, &curr->data, indent);
-                    if (sb->chars[sb->length - 1] != ';' && sb->chars[sb->length - 1] != '\n') {
-                        if (sb->chars[sb->length - 1] != '\n') {
-                            strbuf_append_chars(sb, ";\n");
+                    for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                    append_ir_node(out, &curr->data, indent);
+                    if (out->last != ';' && out->last != '\n') {
+                        if (out->last != '\n') {
+                            file_writer_write_chars(out, ";\n");
                         } else {
-                            strbuf_append_char(sb, ';');
+                            file_writer_write_char(out, ';');
                         }
                     }
                     curr = curr->next;
@@ -2990,77 +2861,77 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
                 }
                 indent -= 1;
             }
-            strbuf_append_char(sb, '}');
+            file_writer_write_char(out, '}');
             break;
         }
 
         case ICNT_STRUCT_DECL: {
-            strbuf_append_chars(sb, "typedef struct ");
-            strbuf_append_str(sb, node->node.struct_decl.name);
-            strbuf_append_chars(sb, " {\n");
+            file_writer_write_chars(out, "typedef struct ");
+            file_writer_write_str(out, node->node.struct_decl.name);
+            file_writer_write_chars(out, " {\n");
             indent += 1;
             for (size_t i = 0; i < node->node.struct_decl.fields.length; ++i) {
-                for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                strbuf_append_str(sb, node->node.struct_decl.fields.strings[i]);
-                strbuf_append_chars(sb, ";\n");
+                for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                file_writer_write_str(out, node->node.struct_decl.fields.strings[i]);
+                file_writer_write_chars(out, ";\n");
             }
             indent -= 1;
-            strbuf_append_chars(sb, "} ");
-            strbuf_append_str(sb, node->node.struct_decl.name);
-            strbuf_append_char(sb, ';');
+            file_writer_write_chars(out, "} ");
+            file_writer_write_str(out, node->node.struct_decl.name);
+            file_writer_write_char(out, ';');
             break;
         }
 
         case ICNT_TYPEDEF_DECL: {
-            strbuf_append_chars(sb, "typedef ");
-            strbuf_append_str(sb, node->node.typedef_decl.type);
-            strbuf_append_char(sb, ' ');
-            strbuf_append_str(sb, node->node.typedef_decl.name);
-            strbuf_append_char(sb, ';');
+            file_writer_write_chars(out, "typedef ");
+            file_writer_write_str(out, node->node.typedef_decl.type);
+            file_writer_write_char(out, ' ');
+            file_writer_write_str(out, node->node.typedef_decl.name);
+            file_writer_write_char(out, ';');
             break;
         }
 
         case ICNT_INDEX: {
-            append_ir_node(sb, node->node.index.root, indent);
-            strbuf_append_char(sb, '[');
-            append_ir_node(sb, node->node.index.value, indent);
-            strbuf_append_char(sb, ']');
+            append_ir_node(out, node->node.index.root, indent);
+            file_writer_write_char(out, '[');
+            append_ir_node(out, node->node.index.value, indent);
+            file_writer_write_char(out, ']');
             break;
         }
 
         case ICNT_STRUCT_INIT: {
-            strbuf_append_char(sb, '(');
-            strbuf_append_str(sb, node->node.struct_init.type);
-            strbuf_append_chars(sb, "){ ");
+            file_writer_write_char(out, '(');
+            file_writer_write_str(out, node->node.struct_init.type);
+            file_writer_write_chars(out, "){ ");
             LLNode_IR_C_Node* curr = node->node.struct_init.fields.head;
             while (curr) {
-                append_ir_node(sb, &curr->data, indent);
+                append_ir_node(out, &curr->data, indent);
                 curr = curr->next;
                 if (curr) {
-                    strbuf_append_chars(sb, ", ");
+                    file_writer_write_chars(out, ", ");
                 }
             }
-            strbuf_append_chars(sb, " }");
+            file_writer_write_chars(out, " }");
             break;
         }
 
         case ICNT_IF: {
-            strbuf_append_chars(sb, "if (");
-            append_ir_node(sb, node->node.if_.cond, indent);
-            strbuf_append_chars(sb, ") {\n");
+            file_writer_write_chars(out, "if (");
+            append_ir_node(out, node->node.if_.cond, indent);
+            file_writer_write_chars(out, ") {\n");
             LL_IR_C_Node block = node->node.if_.then;
             LLNode_IR_C_Node* curr = block.head;
             size_t idx = 0;
             indent += 1;
             bool is_defers = false;
             while (curr) {
-                for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                append_ir_node(sb, &curr->data, indent);
-                if (sb->chars[sb->length - 1] != ';' && sb->chars[sb->length - 1] != '\n') {
-                    if (sb->chars[sb->length - 1] != '\n') {
-                        strbuf_append_chars(sb, ";\n");
+                for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                append_ir_node(out, &curr->data, indent);
+                if (out->last != ';' && out->last != '\n') {
+                    if (out->last != '\n') {
+                        file_writer_write_chars(out, ";\n");
                     } else {
-                        strbuf_append_char(sb, ';');
+                        file_writer_write_char(out, ';');
                     }
                 }
                 curr = curr->next;
@@ -3077,43 +2948,43 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
                 }
             }
             indent -= 1;
-            for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-            strbuf_append_chars(sb, "}");
+            for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+            file_writer_write_chars(out, "}");
             if (node->node.if_.else_) {
-                strbuf_append_chars(sb, " else ");
+                file_writer_write_chars(out, " else ");
                 if (node->node.if_.else_->type == ICNT_IF) {
-                    append_ir_node(sb, node->node.if_.else_, indent);
+                    append_ir_node(out, node->node.if_.else_, indent);
                 } else {
-                    strbuf_append_chars(sb, "{\n");
+                    file_writer_write_chars(out, "{\n");
                     indent += 1;
-                    append_ir_node(sb, node->node.if_.else_, indent);
+                    append_ir_node(out, node->node.if_.else_, indent);
                     indent -= 1;
-                    for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                    strbuf_append_chars(sb, "}");
+                    for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                    file_writer_write_chars(out, "}");
                 }
             }
-            strbuf_append_char(sb, '\n');
+            file_writer_write_char(out, '\n');
             break;
         }
 
         case ICNT_WHILE: {
-            strbuf_append_chars(sb, "while (");
-            append_ir_node(sb, node->node.while_.cond, indent);
-            strbuf_append_chars(sb, ") {\n");
+            file_writer_write_chars(out, "while (");
+            append_ir_node(out, node->node.while_.cond, indent);
+            file_writer_write_chars(out, ") {\n");
             LL_IR_C_Node block = node->node.while_.then;
             LLNode_IR_C_Node* curr = block.head;
             size_t idx = 0;
             indent += 1;
             bool is_defers = false;
             while (curr) {
-                for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                append_ir_node(sb, &curr->data, indent);
+                for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                append_ir_node(out, &curr->data, indent);
 
-                if (sb->chars[sb->length - 1] != ';' && sb->chars[sb->length - 1] != '\n') {
-                    if (sb->chars[sb->length - 1] != '\n') {
-                        strbuf_append_chars(sb, ";\n");
+                if (out->last != ';' && out->last != '\n') {
+                    if (out->last != '\n') {
+                        file_writer_write_chars(out, ";\n");
                     } else {
-                        strbuf_append_char(sb, ';');
+                        file_writer_write_char(out, ';');
                     }
                 }
                 curr = curr->next;
@@ -3130,33 +3001,33 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
                 }
             }
             indent -= 1;
-            for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-            strbuf_append_chars(sb, "}");
+            for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+            file_writer_write_chars(out, "}");
             break;
         }
 
         case ICNT_FOR: {
-            strbuf_append_chars(sb, "for (");
-            append_ir_node(sb, node->node.for_.init, indent);
-            strbuf_append_chars(sb, "; ");
-            append_ir_node(sb, node->node.for_.cond, indent);
-            strbuf_append_chars(sb, "; ");
-            append_ir_node(sb, node->node.for_.step, indent);
-            strbuf_append_chars(sb, ") {\n");
+            file_writer_write_chars(out, "for (");
+            append_ir_node(out, node->node.for_.init, indent);
+            file_writer_write_chars(out, "; ");
+            append_ir_node(out, node->node.for_.cond, indent);
+            file_writer_write_chars(out, "; ");
+            append_ir_node(out, node->node.for_.step, indent);
+            file_writer_write_chars(out, ") {\n");
             LL_IR_C_Node block = node->node.for_.then;
             LLNode_IR_C_Node* curr = block.head;
             size_t idx = 0;
             indent += 1;
             bool is_defers = false;
             while (curr) {
-                for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-                append_ir_node(sb, &curr->data, indent);
+                for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+                append_ir_node(out, &curr->data, indent);
 
-                if (sb->chars[sb->length - 1] != ';' && sb->chars[sb->length - 1] != '\n') {
-                    if (sb->chars[sb->length - 1] != '\n') {
-                        strbuf_append_chars(sb, ";\n");
+                if (out->last != ';' && out->last != '\n') {
+                    if (out->last != '\n') {
+                        file_writer_write_chars(out, ";\n");
                     } else {
-                        strbuf_append_char(sb, ';');
+                        file_writer_write_char(out, ';');
                     }
                 }
                 curr = curr->next;
@@ -3173,76 +3044,206 @@ static void append_ir_node(StringBuffer* sb, IR_C_Node* node, size_t indent) {
                 }
             }
             indent -= 1;
-            for (size_t idnt = 0; idnt < indent; ++idnt) { strbuf_append_chars(sb, "    "); }
-            strbuf_append_chars(sb, "}");
+            for (size_t idnt = 0; idnt < indent; ++idnt) { file_writer_write_chars(out, "    "); }
+            file_writer_write_chars(out, "}");
             break;
         }
 
-        default: printf("%s\n---\nTODO: gen [%d]\n", strbuf_to_str(*sb).chars, node->type); assert(false);
+        default: fprintf(stderr, "TODO: gen [%d] in \"%s\"\n", node->type, out->path); assert(false);
     }
 }
 
-static void append_ir_file(StringBuffer* sb, IR_C_File* file) {
+static void append_ir_file(FileWriter* out, IR_C_File* file) {
     LLNode_IR_C_Node* curr = file->nodes.head;
     while (curr) {
         bool is_macro = ICNT_MACRO_IFNDEF <= curr->data.type && curr->data.type <= ICNT_MACRO_ENDIF;
-        append_ir_node(sb, &curr->data, 0);
-        if (!is_macro && sb->chars[sb->length - 1] != ';') {
-            strbuf_append_char(sb, ';');
+        append_ir_node(out, &curr->data, 0);
+        if (!is_macro && out->last != ';') {
+            file_writer_write_char(out, ';');
         }
-        strbuf_append_char(sb, '\n');
+        file_writer_write_char(out, '\n');
         curr = curr->next;
     }
 }
 
-CodegenC codegen_c_create(Arena* arena, Packages* packages) {
-    IR_C_File* files = arena_calloc(arena, packages->count * 2, sizeof *files);
+// writes the C of `file` into `<build_dir>/<file->name>`, a buffer at a time
+static void emit_file(CodegenC* codegen, String build_dir, IR_C_File* file) {
+    StringBuffer path = strbuf_create(codegen->arena);
+    strbuf_append_str(&path, build_dir);
+    strbuf_append_char(&path, '/');
+    strbuf_append_str(&path, file->name);
+
+    FileWriter writer;
+    file_writer_open(&writer, strbuf_to_strcpy(path), codegen->echo);
+    append_ir_file(&writer, file);
+    file_writer_close(&writer);
+}
 
+CodegenC codegen_c_create(Arena* arena, Packages* packages) {
     return (CodegenC){
         .arena = arena,
         .packages = packages,
-        .ir = {
-            .files_length = 0,
-            .files = files,
-        },
+        .cache = NULL,
+        .reachability = NULL,
+        .echo = NULL,
+        .jobs = 1,
 
         .current_package = NULL,
         .generic_map = NULL,
         .stmt_block = NULL,
+        .next_temp_id = 0,
 
         .seen_file_separator = false,
         .prev_block = BT_OTHER,
     };
 }
 
-GeneratedFiles generate_c_code(CodegenC* codegen) {    
-    for (size_t bi = 0; bi < codegen->packages->lookup_length; ++bi) {
-        ArrayList_Package* bucket = codegen->packages->lookup_buckets + bi;
+// the files a package becomes: its .c, and its .h unless it has main
+static size_t package_files(Arena* arena, Package* package, IR_C_File files[2], FileType ftypes[2]) {
+    files[0] = (IR_C_File){ .name = gen_c_file_path(arena, package->full_name) };
+    ftypes[0] = package->is_entry ? FT_MAIN : FT_C;
+    if (package->is_entry) {
+        return 1;
+    }
 
-        for (size_t pi = 0; pi < bucket->length; ++pi) {
-            Package* package = bucket->array + pi;
-            printf("Transforming package \"%s\"...\n",
-                package->full_name ? package_path_to_str(codegen->arena, package->full_name).chars : "<main>"
-            );
+    files[1] = (IR_C_File){ .name = gen_header_file_path(arena, package->full_name) };
+    ftypes[1] = FT_HEADER;
+    return 2;
+}
 
-            DirectiveCHeader* c_header = get_c_header(package);
-            if (c_header) {
-                continue;
-            }
-            FileType c_ftype = package->is_entry ? FT_MAIN : FT_C;
+static void generate_package(CodegenC* codegen, String build_dir, Package* package) {
+    Arena* arena = codegen->arena;
+    // IR of the file being generated, freed once it is written.
+    // Freed rather than reset, as the IR relies on fresh regions for zeroed fields.
+    Arena file_arena = {0};
+
+    IR_C_File files[2];
+    FileType ftypes[2];
+    size_t files_length = package_files(arena, package, files, ftypes);
+
+    for (size_t fi = 0; fi < files_length; ++fi) {
+        codegen->arena = &file_arena;
+        files[fi].nodes = transform_to_nodes(codegen, package, ftypes[fi]);
+        emit_file(codegen, build_dir, files + fi);
+        codegen->arena = arena;
+        arena_free(&file_arena);
+    }
+}
+
+typedef struct {
+    CodegenC codegen;
+
+    Package** packages;
+    size_t packages_length;
+    String build_dir;
+
+    pthread_mutex_t* lock;
+    size_t* next;
+} CodegenCWorker;
+
+static void* codegen_c_worker_run(void* arg) {
+    CodegenCWorker* worker = arg;
+
+    while (true) {
+        pthread_mutex_lock(worker->lock);
+        size_t i = *worker->next;
+        *worker->next += 1;
+        pthread_mutex_unlock(worker->lock);
+
+        if (i >= worker->packages_length) {
+            break;
+        }
+
+        generate_package(&worker->codegen, worker->build_dir, worker->packages[i]);
+    }
 
-            IR_C_File* file = codegen->ir.files + codegen->ir.files_length;
-            codegen->ir.files_length += 1;
+    return NULL;
+}
 
-            file->name = gen_c_file_path(codegen->arena, package->full_name);
-            file->nodes = transform_to_nodes(codegen, package, c_ftype);
+// Each package only reads what type resolution left behind and writes its own files,
+// so packages are generated by workers that each have a copy of the codegen state.
+static void generate_packages(CodegenC* codegen, String build_dir, Package** packages, size_t packages_length) {
+    size_t jobs = codegen->jobs;
+    if (jobs > packages_length) {
+        jobs = packages_length;
+    }
+    // dumps are written as they are generated, so they stay in order
+    if (codegen->echo || log_dumps(LOG_DUMP_GENERICS)) {
+        jobs = 1;
+    }
 
-            if (c_ftype == FT_C) {
-                file = codegen->ir.files + codegen->ir.files_length;
-                codegen->ir.files_length += 1;
+    if (jobs <= 1) {
+        for (size_t i = 0; i < packages_length; ++i) {
+            generate_package(codegen, build_dir, packages[i]);
+        }
+        return;
+    }
 
-                file->name = gen_header_file_path(codegen->arena, package->full_name);
-                file->nodes = transform_to_nodes(codegen, package, FT_HEADER);
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+    size_t next = 0;
+
+    Arena* worker_arenas = arena_calloc(codegen->arena, jobs, sizeof *worker_arenas);
+    CodegenCWorker* workers = arena_calloc(codegen->arena, jobs, sizeof *workers);
+    pthread_t* threads = arena_calloc(codegen->arena, jobs, sizeof *threads);
+
+    for (size_t i = 0; i < jobs; ++i) {
+        CodegenC worker_codegen = *codegen;
+        worker_codegen.arena = worker_arenas + i;
+
+        workers[i] = (CodegenCWorker){
+            .codegen = worker_codegen,
+            .packages = packages,
+            .packages_length = packages_length,
+            .build_dir = build_dir,
+            .lock = &lock,
+            .next = &next,
+        };
+        if (pthread_create(threads + i, NULL, codegen_c_worker_run, workers + i) != 0) {
+            fprintf(stderr, "Could not start codegen worker thread.\n");
+            exit(71);
+        }
+    }
+
+    for (size_t i = 0; i < jobs; ++i) {
+        pthread_join(threads[i], NULL);
+        arena_free(worker_arenas + i);
+    }
+
+    pthread_mutex_destroy(&lock);
+}
+
+void generate_c_code(CodegenC* codegen, String build_dir) {
+    Arena* arena = codegen->arena;
+
+    // the cache is only touched here, so workers never share it
+    size_t packages_length = 0;
+    Package** packages = arena_calloc(arena, codegen->packages->count, sizeof *packages);
+    for (size_t pi = 0; pi < codegen->packages->count; ++pi) {
+        Package* package = codegen->packages->list[pi];
+        log_verbose("Transforming package \"%s\"...\n",
+            package->full_name ? package_path_to_str(arena, package->full_name).chars : "<main>"
+        );
+
+        DirectiveCHeader* c_header = get_c_header(package);
+        if (c_header) {
+            continue;
+        }
+        if (codegen->cache && build_cache_reuse(codegen->cache, package)) {
+            continue;
+        }
+        packages[packages_length++] = package;
+    }
+
+    generate_packages(codegen, build_dir, packages, packages_length);
+
+    if (codegen->cache) {
+        for (size_t i = 0; i < packages_length; ++i) {
+            IR_C_File files[2];
+            FileType ftypes[2];
+            size_t files_length = package_files(arena, packages[i], files, ftypes);
+            for (size_t fi = 0; fi < files_length; ++fi) {
+                build_cache_generated(codegen->cache, packages[i], files[fi].name);
             }
         }
     }
@@ -3303,26 +3304,13 @@ GeneratedFiles generate_c_code(CodegenC* codegen) {
                 .node.endif._ = NULL,
             });
         }
-        codegen->ir.files[codegen->ir.files_length++] = (IR_C_File){
+        IR_C_File file = {
             .name = c_str("_.h"),
             .nodes = common,
         };
+        emit_file(codegen, build_dir, &file);
+        if (codegen->cache) {
+            build_cache_generated(codegen->cache, NULL, file.name);
+        }
     }
-
-    GeneratedFiles files = {
-        .length = codegen->ir.files_length,
-        .files = arena_calloc(codegen->arena, codegen->ir.files_length, sizeof(GeneratedFile)),
-    };
-    StringBuffer sb = strbuf_create(codegen->arena);
-    for (size_t i = 0; i < codegen->ir.files_length; ++i) {
-        GeneratedFile* file = files.files + i;
-        file->filepath = codegen->ir.files[i].name;
-
-        append_ir_file(&sb, codegen->ir.files + i);
-
-        file->content = strbuf_to_strcpy(sb);
-        strbuf_reset(&sb);
-    }
-
-    return files;
 }
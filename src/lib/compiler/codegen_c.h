@@ -1,7 +1,9 @@
 #ifndef quill_codegen_c_h
 #define quill_codegen_c_h
 
+#include "./build_cache.h"
 #include "./package.h"
+#include "./reachability.h"
 #include "../utils/utils.h"
 
 typedef enum {
@@ -216,28 +218,32 @@ typedef struct {
     LL_IR_C_Node nodes;
 } IR_C_File;
 
-typedef struct {
-    size_t files_length;
-    IR_C_File* files;
-} IR_C;
-
 typedef struct GenericImplMap {
     struct GenericImplMap* parent;
     size_t length;
     String* generic_names;
+    Symbol* generic_symbols;
     String* mapped_types;
-    ResolvedType* mapped_rtypes;
+    ResolvedType** mapped_rtypes;
 } GenericImplMap;
 
 typedef struct {
     Arena* arena;
     Packages* packages;
-
-    IR_C ir;
+    // optional: packages it can reuse are skipped
+    BuildCache* cache;
+    // optional: decls it doesn't reach are left out
+    Reachability const* reachability;
+    // optional: generated C is also written here
+    FILE* echo;
+    // how many packages are generated at once
+    size_t jobs;
 
     Package* current_package;
     GenericImplMap* generic_map;
     LL_IR_C_Node* stmt_block;
+    // numbers the temporaries of the file being generated
+    size_t next_temp_id;
 
     bool seen_file_separator;
     bool needs_std;
@@ -247,17 +253,9 @@ typedef struct {
     BlockType prev_block;
 } CodegenC;
 
-typedef struct {
-    String filepath;
-    String content;
-} GeneratedFile;
-
-typedef struct {
-    size_t length;
-    GeneratedFile* files;
-} GeneratedFiles;
-
 CodegenC codegen_c_create(Arena* arena, Packages* packages);
-GeneratedFiles generate_c_code(CodegenC* codegen);
+
+// writes the C of every package that isn't reused into build_dir, one file at a time
+void generate_c_code(CodegenC* codegen, String build_dir);
 
 #endif
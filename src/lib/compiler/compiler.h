@@ -3,10 +3,16 @@
 
 #include "./analyzer.h"
 #include "./args.h"
+#include "./ast_cache.h"
+#include "./build_cache.h"
 #include "./codegen_c.h"
+#include "./frontend.h"
 #include "./lexer.h"
+#include "./monomorphizer.h"
 #include "./package.h"
+#include "./package_graph.h"
 #include "./parser.h"
+#include "./reachability.h"
 #include "./token.h"
 #include "./type_resolver.h"
 
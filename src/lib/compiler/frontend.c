@@ -0,0 +1,432 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "./frontend.h"
+#include "./build_cache.h"
+#include "./ast_cache.h"
+#include "./lexer.h"
+#include "./parser.h"
+#include "../utils/utils.h"
+
+#define MODULE_EXTENSION ".ql"
+
+typedef struct {
+    Frontend* frontend;
+    Arena* arena;
+
+    pthread_mutex_t* lock;
+    pthread_cond_t* changed;
+    size_t* next_source;
+    size_t* busy;
+} FrontendWorker;
+
+static uint64_t hash_name(String name) {
+    return fingerprint_chars(FNV_OFFSET_BASIS, name);
+}
+
+static ParsedSource* push_source(Frontend* const frontend, String const path) {
+    if (frontend->parsed_length >= frontend->parsed_capacity) {
+        size_t prev_cap = frontend->parsed_capacity;
+        frontend->parsed_capacity = prev_cap > 0 ? prev_cap * 2 : 8;
+        frontend->parsed = arena_realloc(frontend->arena, frontend->parsed, sizeof(ParsedSource*) * prev_cap, sizeof(ParsedSource*) * frontend->parsed_capacity);
+    }
+
+    ParsedSource* const source = arena_calloc(frontend->arena, 1, sizeof *source);
+    source->path = path;
+
+    frontend->parsed[frontend->parsed_length++] = source;
+    return source;
+}
+
+// true if the name wasn't requested before
+static bool request_package(Frontend* const frontend, String const name) {
+    if ((frontend->requested_length + 1) * 2 > frontend->requested_capacity) {
+        size_t const prev_cap = frontend->requested_capacity;
+        String* const prev = frontend->requested;
+
+        frontend->requested_capacity = prev_cap > 0 ? prev_cap * 2 : 32;
+        frontend->requested = arena_calloc(frontend->arena, frontend->requested_capacity, sizeof(String));
+
+        for (size_t i = 0; i < prev_cap; ++i) {
+            if (!prev[i].chars) {
+                continue;
+            }
+
+            size_t slot = hash_name(prev[i]) & (frontend->requested_capacity - 1);
+            while (frontend->requested[slot].chars) {
+                slot = (slot + 1) & (frontend->requested_capacity - 1);
+            }
+            frontend->requested[slot] = prev[i];
+        }
+    }
+
+    size_t slot = hash_name(name) & (frontend->requested_capacity - 1);
+    while (frontend->requested[slot].chars) {
+        if (str_eq(frontend->requested[slot], name)) {
+            return false;
+        }
+        slot = (slot + 1) & (frontend->requested_capacity - 1);
+    }
+
+    frontend->requested[slot] = name;
+    frontend->requested_length += 1;
+    return true;
+}
+
+static String module_file(Arena* const arena, String const root, String const name, String const file) {
+    StringBuffer sb = strbuf_create(arena);
+    strbuf_append_str(&sb, root);
+    if (root.length > 0 && root.chars[root.length - 1] != '/') {
+        strbuf_append_char(&sb, '/');
+    }
+    strbuf_append_str(&sb, name);
+    if (file.length > 0) {
+        strbuf_append_char(&sb, '/');
+        strbuf_append_str(&sb, file);
+    }
+    strbuf_append_chars(&sb, MODULE_EXTENSION);
+    return strbuf_to_strcpy(sb);
+}
+
+String frontend_find_module(Arena* const arena, Strings const module_paths, String const name) {
+    String last = name;
+    for (size_t i = name.length; i > 0; --i) {
+        if (name.chars[i - 1] == '/') {
+            last = (String){ .length = name.length - i, .chars = name.chars + i };
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < module_paths.length; ++i) {
+        String const root = module_paths.strings[i];
+
+        String path = module_file(arena, root, name, (String){0});
+        if (file_exists(path)) {
+            return path;
+        }
+
+        // a package that also has packages under it, like std next to std/io
+        path = module_file(arena, root, name, last);
+        if (file_exists(path)) {
+            return path;
+        }
+    }
+
+    return (String){0};
+}
+
+static void request_module(Frontend* const frontend, String const name) {
+    if (!request_package(frontend, name)) {
+        return;
+    }
+
+    // one that is nowhere to be found is reported once types are resolved
+    String const path = frontend_find_module(frontend->arena, frontend->module_paths, name);
+    if (path.length > 0) {
+        push_source(frontend, path);
+    }
+}
+
+static void parse_source(Arena* const arena, Frontend const* const frontend, ParsedSource* const source) {
+    String const chars = file_read(arena, source->path);
+    source->source_hash = build_cache_source_hash(chars);
+
+    if (frontend->ast_cache_dir.length > 0) {
+        source->cache_path = ast_cache_path(arena, frontend->ast_cache_dir, source->path);
+        if (ast_cache_load(arena, source->cache_path, source->source_hash, source)) {
+            source->from_cache = true;
+            return;
+        }
+    }
+
+    Lexer lexer = lexer_create(arena, chars);
+    Parser parser = parser_create(arena, &lexer);
+
+    ASTNodeResult const ast_res = parser_parse(&parser);
+    astres_assert(ast_res);
+
+    source->ast = (ASTNode*)ast_res.res.ast;
+    source->had_error = parser.had_error;
+    source->uses_string_templates = parser.uses_string_templates;
+    source->node_ids_length = parser.next_node_id;
+    source->type_ids_length = parser.next_type_id;
+
+    if (parser.package) {
+        source->package_name = parser.package->node.package.package_path;
+    }
+
+    // written before the ids are shifted, as they depend on which files come before
+    if (source->cache_path.length > 0 && !source->had_error) {
+        ast_cache_write(arena, source->cache_path, source->source_hash, source);
+    }
+}
+
+static void collect_imports(Arena* const arena, ParsedSource* const source) {
+    ArrayList_ASTNode const nodes = source->ast->node.file_root.nodes;
+
+    source->package_key = source->package_name ? package_path_to_str(arena, source->package_name) : (String){0};
+
+    size_t imports_capacity = 1;
+    for (size_t i = 0; i < nodes.length; ++i) {
+        if (nodes.array[i].type == ANT_IMPORT) {
+            imports_capacity += 1;
+        }
+    }
+
+    source->imports_length = 0;
+    source->imports = arena_calloc(arena, imports_capacity, sizeof(String));
+
+    for (size_t i = 0; i < nodes.length; ++i) {
+        ASTNode* const node = nodes.array + i;
+        if (node->type != ANT_IMPORT) {
+            continue;
+        }
+
+        // relative to a package that isn't there, which is reported once types are resolved
+        if (node->node.import.type != IT_DEFAULT && !source->package_name) {
+            continue;
+        }
+
+        ImportPath* const path = import_path_expand(arena, &node->node.import, source->package_name);
+        PackagePath* const dependency = import_path_to_package_path(arena, path);
+        if (dependency) {
+            source->imports[source->imports_length++] = package_path_to_str(arena, dependency);
+        }
+    }
+
+    if (source->uses_string_templates) {
+        source->imports[source->imports_length++] = c_str(RUNTIME_PACKAGES[RP_STD_DS]);
+    }
+}
+
+// called with the lock held, if any
+static void discover_imports(Frontend* const frontend, ParsedSource const* const source) {
+    if (source->package_key.length > 0) {
+        request_package(frontend, source->package_key);
+    }
+
+    if (frontend->module_paths.length == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < source->imports_length; ++i) {
+        request_module(frontend, source->imports[i]);
+    }
+}
+
+static void* frontend_worker_run(void* const arg) {
+    FrontendWorker* const worker = arg;
+    Frontend* const frontend = worker->frontend;
+
+    pthread_mutex_lock(worker->lock);
+    while (true) {
+        if (*worker->next_source < frontend->parsed_length) {
+            ParsedSource* const source = frontend->parsed[*worker->next_source];
+            *worker->next_source += 1;
+            *worker->busy += 1;
+            pthread_mutex_unlock(worker->lock);
+
+            parse_source(worker->arena, frontend, source);
+            collect_imports(worker->arena, source);
+
+            pthread_mutex_lock(worker->lock);
+            discover_imports(frontend, source);
+            *worker->busy -= 1;
+            pthread_cond_broadcast(worker->changed);
+        } else if (*worker->busy > 0) {
+            // a file still being parsed may import more
+            pthread_cond_wait(worker->changed, worker->lock);
+        } else {
+            break;
+        }
+    }
+    pthread_mutex_unlock(worker->lock);
+
+    return NULL;
+}
+
+static size_t lookup_source(size_t const* const by_name, size_t const capacity, ParsedSource* const* const parsed, String const name) {
+    size_t slot = hash_name(name) & (capacity - 1);
+    while (by_name[slot]) {
+        if (str_eq(parsed[by_name[slot] - 1]->package_key, name)) {
+            return by_name[slot] - 1;
+        }
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return SIZE_MAX;
+}
+
+// The order only depends on the files, not on which worker found what first.
+static void order_sources(Frontend* const frontend) {
+    size_t const parsed_length = frontend->parsed_length;
+
+    // package name => index + 1 in parsed, where a path given wins over a file found for the same package
+    size_t capacity = 16;
+    while (capacity < parsed_length * 2) {
+        capacity *= 2;
+    }
+    size_t* const by_name = arena_calloc(frontend->arena, capacity, sizeof(size_t));
+
+    for (size_t i = 0; i < parsed_length; ++i) {
+        String const name = frontend->parsed[i]->package_key;
+        if (name.length == 0 || lookup_source(by_name, capacity, frontend->parsed, name) != SIZE_MAX) {
+            continue;
+        }
+
+        size_t slot = hash_name(name) & (capacity - 1);
+        while (by_name[slot]) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        by_name[slot] = i + 1;
+    }
+
+    bool* const placed = arena_calloc(frontend->arena, parsed_length, sizeof(bool));
+    size_t* const order = arena_calloc(frontend->arena, parsed_length, sizeof(size_t));
+    size_t order_length = 0;
+
+    for (size_t i = 0; i < frontend->listed_length; ++i) {
+        placed[i] = true;
+        order[order_length++] = i;
+    }
+
+    for (RuntimePackage r = 0; r < RP_ALWAYS_IMPORTED_COUNT; ++r) {
+        size_t const idx = lookup_source(by_name, capacity, frontend->parsed, c_str(RUNTIME_PACKAGES[r]));
+        if (idx != SIZE_MAX && !placed[idx]) {
+            placed[idx] = true;
+            order[order_length++] = idx;
+        }
+    }
+
+    for (size_t o = 0; o < order_length; ++o) {
+        ParsedSource const* const source = frontend->parsed[order[o]];
+        for (size_t i = 0; i < source->imports_length; ++i) {
+            size_t const idx = lookup_source(by_name, capacity, frontend->parsed, source->imports[i]);
+            if (idx != SIZE_MAX && !placed[idx]) {
+                placed[idx] = true;
+                order[order_length++] = idx;
+            }
+        }
+    }
+
+    frontend->sources_length = order_length;
+    frontend->sources = arena_calloc(frontend->arena, order_length, sizeof(ParsedSource));
+    for (size_t o = 0; o < order_length; ++o) {
+        frontend->sources[o] = *frontend->parsed[order[o]];
+    }
+}
+
+Frontend frontend_create(Arena* const arena, Strings const paths, Strings const module_paths, String const ast_cache_dir, size_t const jobs) {
+    assert(jobs > 0);
+
+    Frontend frontend = {
+        .arena = arena,
+        .jobs = jobs,
+
+        .worker_arenas = arena_calloc(arena, jobs, sizeof(Arena)),
+
+        .module_paths = module_paths,
+        .ast_cache_dir = ast_cache_dir,
+
+        .parsed_length = 0,
+        .parsed_capacity = 0,
+        .parsed = NULL,
+        .listed_length = paths.length,
+
+        .requested_length = 0,
+        .requested_capacity = 0,
+        .requested = NULL,
+
+        .sources_length = 0,
+        .sources = NULL,
+
+        .next_node_id = 0,
+        .next_type_id = 0,
+    };
+
+    for (size_t i = 0; i < paths.length; ++i) {
+        push_source(&frontend, paths.strings[i])->listed = true;
+    }
+
+    if (module_paths.length > 0) {
+        for (RuntimePackage r = 0; r < RP_ALWAYS_IMPORTED_COUNT; ++r) {
+            request_module(&frontend, c_str(RUNTIME_PACKAGES[r]));
+        }
+    }
+
+    return frontend;
+}
+
+void frontend_parse(Frontend* const frontend) {
+    // shared lookup tables must be ready before any worker starts lexing
+    lexer_init();
+
+    size_t jobs = frontend->jobs;
+    if (frontend->module_paths.length == 0 && jobs > frontend->parsed_length) {
+        jobs = frontend->parsed_length;
+    }
+
+    if (jobs <= 1) {
+        for (size_t i = 0; i < frontend->parsed_length; ++i) {
+            parse_source(frontend->worker_arenas, frontend, frontend->parsed[i]);
+            collect_imports(frontend->worker_arenas, frontend->parsed[i]);
+            discover_imports(frontend, frontend->parsed[i]);
+        }
+    } else {
+        pthread_mutex_t lock;
+        pthread_mutex_init(&lock, NULL);
+        pthread_cond_t changed;
+        pthread_cond_init(&changed, NULL);
+        size_t next_source = 0;
+        size_t busy = 0;
+
+        FrontendWorker* const workers = arena_calloc(frontend->arena, jobs, sizeof *workers);
+        pthread_t* const threads = arena_calloc(frontend->arena, jobs, sizeof *threads);
+
+        for (size_t i = 0; i < jobs; ++i) {
+            workers[i] = (FrontendWorker){
+                .frontend = frontend,
+                .arena = frontend->worker_arenas + i,
+                .lock = &lock,
+                .changed = &changed,
+                .next_source = &next_source,
+                .busy = &busy,
+            };
+            if (pthread_create(threads + i, NULL, frontend_worker_run, workers + i) != 0) {
+                fprintf(stderr, "Could not start front end worker thread.\n");
+                exit(71);
+            }
+        }
+
+        for (size_t i = 0; i < jobs; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+
+        pthread_cond_destroy(&changed);
+        pthread_mutex_destroy(&lock);
+    }
+
+    order_sources(frontend);
+
+    // stable merge: ids follow the order of the sources
+    for (size_t i = 0; i < frontend->sources_length; ++i) {
+        ParsedSource* const source = frontend->sources + i;
+
+        ast_shift_ids(source->ast, frontend->next_node_id, frontend->next_type_id);
+        source->decls = decl_index_create(frontend->arena, source->ast->node.file_root);
+
+        frontend->next_node_id += source->node_ids_length;
+        frontend->next_type_id += source->type_ids_length;
+    }
+}
+
+void frontend_free(Frontend* const frontend) {
+    for (size_t i = 0; i < frontend->parsed_length; ++i) {
+        ast_cache_unmap(frontend->parsed[i]);
+    }
+
+    for (size_t i = 0; i < frontend->jobs; ++i) {
+        arena_free(frontend->worker_arenas + i);
+    }
+}
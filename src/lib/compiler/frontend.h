@@ -0,0 +1,89 @@
+#ifndef quill_frontend_h
+#define quill_frontend_h
+
+#include "./ast.h"
+#include "../utils/utils.h"
+
+typedef struct {
+    String path;
+
+    ASTNode* ast;
+    PackagePath* package_name;
+    bool had_error;
+    bool uses_string_templates;
+
+    // built once the ids are shifted
+    DeclIndex decls;
+
+    // ids used by this file's parser, which starts counting from 0
+    size_t node_ids_length;
+    size_t type_ids_length;
+
+    // given as a path, rather than found as an import
+    bool listed;
+
+    // names of the packages this file needs, like "std/io", in the order they are imported
+    String package_key;
+    size_t imports_length;
+    String* imports;
+
+    // the AST is loaded from, or written to, the AST cache file at cache_path
+    String cache_path;
+    uint64_t source_hash;
+
+    // the AST was read from the cache, whose mapping it points into
+    bool from_cache;
+    void* mapped;
+    size_t mapped_length;
+} ParsedSource;
+
+// Lexes and parses every source path, on `jobs` threads, along with every package
+// they import that isn't one of them. Those are looked up in each of the module paths,
+// as `<module path>/a/b.ql` or `<module path>/a/b/b.ql` for `import a/b`, and parsed
+// as soon as they are found. Packages that codegen calls into are found the same way.
+//
+// Each worker allocates into its own arena. Afterwards the sources are put in order:
+// the paths given, then breadth first through their imports. The ids of each file
+// are shifted past those of the files before it, so they come out the same as parsing
+// the files one after another.
+// A source with an up to date AST cache file is loaded from it instead of being lexed.
+typedef struct {
+    Arena* arena;
+    size_t jobs;
+
+    Arena* worker_arenas;
+
+    Strings module_paths;
+    // where parsed ASTs are cached, or empty to always parse
+    String ast_cache_dir;
+
+    // every file parsed, the paths given first, then the ones found as they are found
+    size_t parsed_length;
+    size_t parsed_capacity;
+    ParsedSource** parsed;
+    size_t listed_length;
+
+    // open-addressed set of package names that are given or were looked up
+    size_t requested_length;
+    size_t requested_capacity;
+    String* requested;
+
+    // the parsed files that are given or imported, in order
+    size_t sources_length;
+    ParsedSource* sources;
+
+    size_t next_node_id;
+    size_t next_type_id;
+} Frontend;
+
+Frontend frontend_create(Arena* const arena, Strings const paths, Strings const module_paths, String const ast_cache_dir, size_t const jobs);
+
+void frontend_parse(Frontend* const frontend);
+
+// Path of the file for the package `name` in the first of the module paths that has it,
+// or empty if none does.
+String frontend_find_module(Arena* const arena, Strings const module_paths, String const name);
+
+void frontend_free(Frontend* const frontend);
+
+#endif
@@ -1,5 +1,11 @@
 #include <string.h>
 
+#if defined(__GNUC__) && defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__GNUC__) && defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 #include "./compiler.h"
 #include "../utils/utils.h"
 #include "token.h"
@@ -9,8 +15,7 @@ typedef struct {
     TokenType const type;
 } KeywordMatch;
 
-static const size_t KEYWORD_MATCHES_LEN = 42;
-static const KeywordMatch KEYWORD_MATCHES[KEYWORD_MATCHES_LEN] = {
+static const KeywordMatch KEYWORD_MATCHES[] = {
     { "break", TT_BREAK },
     { "continue", TT_CONTINUE },
     { "CRASH", TT_CRASH },
@@ -56,6 +61,26 @@ static const KeywordMatch KEYWORD_MATCHES[KEYWORD_MATCHES_LEN] = {
     { "float32", TT_FLOAT32 },
     { "float64", TT_FLOAT64 },
 };
+#define KEYWORD_MATCHES_LEN (sizeof KEYWORD_MATCHES / sizeof *KEYWORD_MATCHES)
+
+// Perfect hash over KEYWORD_MATCHES, built once from the table above.
+// The hash only looks at the length and 3 sampled chars, and the seed is
+// searched for at startup until every keyword lands in its own slot.
+#define KEYWORD_HASH_SLOTS 128
+#define KEYWORD_HASH_MAX_SEED (1 << 16)
+
+#define FNV32_PRIME 16777619U
+
+typedef struct {
+    bool initialized;
+    uint32_t seed;
+
+    // index + 1 into KEYWORD_MATCHES, 0 for an empty slot
+    uint8_t slots[KEYWORD_HASH_SLOTS];
+    size_t pattern_lens[KEYWORD_MATCHES_LEN];
+} KeywordTable;
+
+static KeywordTable keyword_table = {0};
 
 typedef struct {
     bool ok;
@@ -92,15 +117,35 @@ static bool char_is_digit(char const c) {
 static Token lexer_token_create(Lexer const* const lexer, TokenType const type) {
     return (Token) {
         .type = type,
+        .symbol = SYMBOL_NONE,
         .start = lexer->start,
         .length = lexer->current - lexer->start,
         .line = lexer->line,
     };
 }
 
-static Token lexer_token_error(Lexer const* const lexer, char* message) {
+typedef enum {
+    LE_UNTERMINATED_CHARS,
+    LE_UNTERMINATED_STRING,
+    LE_UNTERMINATED_TEMPLATE_STRING,
+    LE_UNEXPECTED_CHARS,
+    LE_COUNT,
+} LexerError;
+
+static char* const LEXER_ERROR_MESSAGES[LE_COUNT] = {
+    [LE_UNTERMINATED_CHARS] = "Unterminated char(s)",
+    [LE_UNTERMINATED_STRING] = "Unterminated string",
+    [LE_UNTERMINATED_TEMPLATE_STRING] = "Unterminated template string",
+    [LE_UNEXPECTED_CHARS] = "Unexpected character(s).",
+};
+
+static Token lexer_token_error(Lexer* const lexer, LexerError const error) {
+    char* const message = LEXER_ERROR_MESSAGES[error];
+    lexer->error = (uint8_t)error;
+
     return (Token) {
         .type = TT_ERROR,
+        .symbol = SYMBOL_NONE,
         .start = message,
         .length = strlen(message),
         .line = lexer->line,
@@ -141,89 +186,217 @@ static bool lexer_match_char(Lexer* const lexer, char const expected) {
     return true;
 }
 
+typedef enum {
+    SK_BLANK,         // stop at the first byte that isn't ' ', '\r', '\t' or '\n'
+    SK_LINE_COMMENT,  // stop at the next '\n'
+    SK_BLOCK_COMMENT, // stop at the next '*' or '/'
+} SkipKind;
+
+static bool skip_is_stop(SkipKind const kind, char const c) {
+    switch (kind) {
+        case SK_BLANK: return c != ' ' && c != '\r' && c != '\t' && c != '\n';
+        case SK_LINE_COMMENT: return c == '\n' || c == '\0';
+        case SK_BLOCK_COMMENT: return c == '*' || c == '/' || c == '\0';
+    }
+    return true;
+}
+
+#if defined(__GNUC__) && defined(__AVX2__)
+    #define SKIP_VEC_WIDTH 32
+    #define SKIP_VEC_FULL_MASK 0xFFFFFFFFU
+    typedef __m256i SkipVec;
+    #define skip_vec_load(ptr) _mm256_loadu_si256((__m256i const*)(ptr))
+    #define skip_vec_splat(c) _mm256_set1_epi8(c)
+    #define skip_vec_eq(a, b) _mm256_cmpeq_epi8(a, b)
+    #define skip_vec_or(a, b) _mm256_or_si256(a, b)
+    #define skip_vec_mask(v) ((uint32_t)_mm256_movemask_epi8(v))
+#elif defined(__GNUC__) && defined(__SSE2__)
+    #define SKIP_VEC_WIDTH 16
+    #define SKIP_VEC_FULL_MASK 0xFFFFU
+    typedef __m128i SkipVec;
+    #define skip_vec_load(ptr) _mm_loadu_si128((__m128i const*)(ptr))
+    #define skip_vec_splat(c) _mm_set1_epi8(c)
+    #define skip_vec_eq(a, b) _mm_cmpeq_epi8(a, b)
+    #define skip_vec_or(a, b) _mm_or_si128(a, b)
+    #define skip_vec_mask(v) ((uint32_t)_mm_movemask_epi8(v))
+#endif
+
+// Advances lexer->current to the first stop byte for `kind` (or the end of
+// the source), adding every newline it steps over to lexer->line.
+static void lexer_skip(Lexer* const lexer, SkipKind const kind) {
+    char* cursor = lexer->current;
+    size_t newlines = 0;
+
+#ifdef SKIP_VEC_WIDTH
+    SkipVec const newline = skip_vec_splat('\n');
+    SkipVec const nul = skip_vec_splat('\0');
+
+    while (lexer->end - cursor >= SKIP_VEC_WIDTH) {
+        SkipVec const chunk = skip_vec_load(cursor);
+        uint32_t const newline_mask = skip_vec_mask(skip_vec_eq(chunk, newline));
+
+        uint32_t stop_mask = 0;
+        switch (kind) {
+            case SK_BLANK: {
+                SkipVec const blank = skip_vec_or(
+                    skip_vec_or(skip_vec_eq(chunk, skip_vec_splat(' ')), skip_vec_eq(chunk, skip_vec_splat('\t'))),
+                    skip_vec_or(skip_vec_eq(chunk, skip_vec_splat('\r')), skip_vec_eq(chunk, newline))
+                );
+                stop_mask = ~skip_vec_mask(blank) & SKIP_VEC_FULL_MASK;
+                break;
+            }
+            case SK_LINE_COMMENT:
+                stop_mask = newline_mask | skip_vec_mask(skip_vec_eq(chunk, nul));
+                break;
+            case SK_BLOCK_COMMENT:
+                stop_mask = skip_vec_mask(skip_vec_or(
+                    skip_vec_or(skip_vec_eq(chunk, skip_vec_splat('*')), skip_vec_eq(chunk, skip_vec_splat('/'))),
+                    skip_vec_eq(chunk, nul)
+                ));
+                break;
+        }
+
+        if (stop_mask != 0) {
+            unsigned const offset = (unsigned)__builtin_ctz(stop_mask);
+            newlines += (size_t)__builtin_popcount(newline_mask & ((1U << offset) - 1));
+            lexer->current = cursor + offset;
+            lexer->line += newlines;
+            return;
+        }
+
+        newlines += (size_t)__builtin_popcount(newline_mask);
+        cursor += SKIP_VEC_WIDTH;
+    }
+#endif
+
+    while (cursor < lexer->end && !skip_is_stop(kind, *cursor)) {
+        if (*cursor == '\n') {
+            newlines += 1;
+        }
+        cursor += 1;
+    }
+
+    lexer->current = cursor;
+    lexer->line += newlines;
+}
+
 static void lexer_skip_whitespace(Lexer* const lexer) {
     while (true) {
-        switch (lexer_peek(lexer)) {
-            case ' ':
-            case '\r':
-            case '\t':
-                lexer_advance(lexer);
-                break;
-            case '\n':
-                lexer->line += 1;
-                lexer_advance(lexer);
+        lexer_skip(lexer, SK_BLANK);
+
+        if (lexer_peek(lexer) != '/') {
+            return;
+        }
+
+        switch (lexer_peek_next(lexer)) {
+            case '/': {
+                // a line comment goes until the end of the line
+                lexer_skip(lexer, SK_LINE_COMMENT);
                 break;
-            case '/':
-                switch (lexer_peek_next(lexer)) {
-                    case '/': {
-                        // a line comment goes until the end of the line
-                        while (lexer_peek(lexer) != '\n' && !lexer_is_at_end(lexer)) {
-                            lexer_advance(lexer);
-                        }
+            }
+
+            case '*': {
+                lexer->multiline_comment_nest += 1;
+                lexer_advance(lexer); // '/'
+                lexer_advance(lexer); // '*'
+
+                while (true) {
+                    lexer_skip(lexer, SK_BLOCK_COMMENT);
+
+                    if (lexer_is_at_end(lexer)) {
                         break;
                     }
 
-                    case '*': {
+                    if (lexer_peek(lexer) == '/' && lexer_peek_next(lexer) == '*') {
                         lexer->multiline_comment_nest += 1;
                         lexer_advance(lexer); // '/'
                         lexer_advance(lexer); // '*'
+                        continue;
+                    }
+
+                    if (lexer_peek(lexer) == '*' && lexer_peek_next(lexer) == '/') {
+                        lexer->multiline_comment_nest -= 1;
+                        lexer_advance(lexer); // '*'
+                        lexer_advance(lexer); // '/'
 
-                        while (true) {
-                            if (lexer_is_at_end(lexer)) {
-                                break;
-                            }
-
-                            if (lexer_peek(lexer) == '\n') {
-                                lexer->line += 1;
-                            }
-
-                            if (lexer_peek(lexer) == '/' && lexer_peek_next(lexer) == '*') {
-                                lexer->multiline_comment_nest += 1;
-                                lexer_advance(lexer); // '/'
-                                lexer_advance(lexer); // '*'
-                                continue;
-                            }
-
-                            if (lexer_peek(lexer) == '*' && lexer_peek_next(lexer) == '/') {
-                                lexer->multiline_comment_nest -= 1;
-                                lexer_advance(lexer); // '*'
-                                lexer_advance(lexer); // '/'
-
-                                if (lexer->multiline_comment_nest == 0) {
-                                    break;
-                                } else {
-                                    continue;
-                                }
-                            }
-
-                            lexer_advance(lexer);
+                        if (lexer->multiline_comment_nest == 0) {
+                            break;
+                        } else {
+                            continue;
                         }
-                        break;
                     }
 
-                    default: return;
+                    lexer_advance(lexer);
                 }
                 break;
-            default:
-                return;
+            }
+
+            default: return;
         }
     }
 }
 
-static MaybeToken lexer_scan_keyword_maybe(Lexer* const lexer) {
-    for (size_t i = 0; i < KEYWORD_MATCHES_LEN; ++i) {
-        KeywordMatch const keyword = KEYWORD_MATCHES[i];
+static size_t keyword_hash(uint32_t const seed, char const* const chars, size_t const length) {
+    uint32_t hash = (uint32_t)length * seed;
+    hash = (hash ^ (uint8_t)chars[0]) * FNV32_PRIME;
+    hash = (hash ^ (uint8_t)chars[length / 2]) * FNV32_PRIME;
+    hash = (hash ^ (uint8_t)chars[length - 1]) * FNV32_PRIME;
+    return (hash ^ (hash >> 15)) & (KEYWORD_HASH_SLOTS - 1);
+}
 
-        size_t const keyword_len = strlen(keyword.pattern);
+static bool keyword_table_try_seed(KeywordTable* const table, uint32_t const seed) {
+    memset(table->slots, 0, sizeof table->slots);
 
-        if ((size_t)(lexer->current - lexer->start) == keyword_len
-            && memcmp(lexer->start, keyword.pattern, keyword_len) == 0
-        ) {
-            return maybetoken_some(lexer_token_create(lexer, keyword.type));
+    for (size_t i = 0; i < KEYWORD_MATCHES_LEN; ++i) {
+        size_t const slot = keyword_hash(seed, KEYWORD_MATCHES[i].pattern, table->pattern_lens[i]);
+        if (table->slots[slot] != 0) {
+            return false;
         }
+        table->slots[slot] = (uint8_t)(i + 1);
+    }
+
+    table->seed = seed;
+    return true;
+}
+
+static void keyword_table_init(KeywordTable* const table) {
+    if (table->initialized) {
+        return;
+    }
+
+    assert(KEYWORD_MATCHES_LEN < UINT8_MAX);
+    assert(KEYWORD_MATCHES_LEN <= KEYWORD_HASH_SLOTS);
+
+    for (size_t i = 0; i < KEYWORD_MATCHES_LEN; ++i) {
+        table->pattern_lens[i] = strlen(KEYWORD_MATCHES[i].pattern);
+    }
+
+    uint32_t seed = 1;
+    while (seed < KEYWORD_HASH_MAX_SEED && !keyword_table_try_seed(table, seed)) {
+        seed += 1;
+    }
+    assert(seed < KEYWORD_HASH_MAX_SEED); // no perfect hash; grow KEYWORD_HASH_SLOTS
+
+    table->initialized = true;
+}
+
+static MaybeToken lexer_scan_keyword_maybe(Lexer* const lexer) {
+    KeywordTable const* const table = &keyword_table;
+    assert(table->initialized);
+
+    size_t const length = lexer->current - lexer->start;
+
+    size_t const slot = table->slots[keyword_hash(table->seed, lexer->start, length)];
+    if (slot == 0) {
+        return maybetoken_none();
     }
 
-    return maybetoken_none();
+    size_t const i = slot - 1;
+    if (table->pattern_lens[i] != length || memcmp(lexer->start, KEYWORD_MATCHES[i].pattern, length) != 0) {
+        return maybetoken_none();
+    }
+
+    return maybetoken_some(lexer_token_create(lexer, KEYWORD_MATCHES[i].type));
 }
 
 static Token lexer_scan_keyword_or_identifier(Lexer* const lexer) {
@@ -241,7 +414,9 @@ static Token lexer_scan_keyword_or_identifier(Lexer* const lexer) {
     }
 
     // fallback to identifier
-    return lexer_token_create(lexer, TT_IDENTIFIER);
+    Token token = lexer_token_create(lexer, TT_IDENTIFIER);
+    token.symbol = intern((String){ .length = token.length, .chars = token.start });
+    return token;
 }
 
 static Token lexer_scan_at_or_compiler_directive(Lexer* const lexer) {
@@ -284,14 +459,14 @@ static Token lexer_scan_chars(Lexer* const lexer) {
     while (lexer_peek(lexer) != '\'' && !lexer_is_at_end(lexer)) {
         if (lexer_peek(lexer) == '\n') {
             lexer->line += 1;
-            return lexer_token_error(lexer, "Unterminated char(s)");
+            return lexer_token_error(lexer, LE_UNTERMINATED_CHARS);
         }
 
         char const _ = lexer_advance(lexer);
     }
 
     if (lexer_is_at_end(lexer)) {
-        return lexer_token_error(lexer, "Unterminated char(s)");
+        return lexer_token_error(lexer, LE_UNTERMINATED_CHARS);
     }
 
     char _ = lexer_advance(lexer);
@@ -303,14 +478,14 @@ static Token lexer_scan_string(Lexer* const lexer) {
     while (lexer_peek(lexer) != '"' && !lexer_is_at_end(lexer)) {
         if (lexer_peek(lexer) == '\n') {
             lexer->line += 1;
-            return lexer_token_error(lexer, "Unterminated string");
+            return lexer_token_error(lexer, LE_UNTERMINATED_STRING);
         }
 
         char const _ = lexer_advance(lexer);
     }
 
     if (lexer_is_at_end(lexer)) {
-        return lexer_token_error(lexer, "Unterminated string");
+        return lexer_token_error(lexer, LE_UNTERMINATED_STRING);
     }
 
     char _ = lexer_advance(lexer);
@@ -332,7 +507,7 @@ static Token lexer_scan_template_string_start(Lexer* const lexer) {
     }
 
     if (lexer_is_at_end(lexer)) {
-        return lexer_token_error(lexer, "Unterminated template string");
+        return lexer_token_error(lexer, LE_UNTERMINATED_TEMPLATE_STRING);
     }
 
     char c = lexer_advance(lexer);
@@ -359,7 +534,7 @@ static Token lexer_scan_template_string_cont(Lexer* const lexer) {
     }
 
     if (lexer_is_at_end(lexer)) {
-        return lexer_token_error(lexer, "Unterminated string");
+        return lexer_token_error(lexer, LE_UNTERMINATED_STRING);
     }
 
     char c = lexer_advance(lexer);
@@ -470,18 +645,28 @@ static Token lexer_scan_token(Lexer* const lexer) {
         );
     }
 
-    return lexer_token_error(lexer, "Unexpected character(s).");
+    return lexer_token_error(lexer, LE_UNEXPECTED_CHARS);
+}
+
+void lexer_init(void) {
+    keyword_table_init(&keyword_table);
 }
 
 Lexer lexer_create(Arena* const arena, String const source) {
+    lexer_init();
+
     return (Lexer){
         .arena = arena,
+        .source = source.chars,
         .start = source.chars,
         .current = source.chars,
+        .end = source.chars + source.length,
         .line = 1,
 
         .template_string_nest = 0,
         .multiline_comment_nest = 0,
+
+        .error = 0,
     };
 }
 
@@ -495,3 +680,166 @@ ScanResult lexer_scan(Lexer* const lexer) {
 
     return scanres_ok(tokens);
 }
+
+#define INITIAL_TOKEN_STREAM_CAPACITY 64
+
+static void token_stream_alloc_ring(TokenStream* const stream, size_t const capacity) {
+    Arena* const arena = stream->lexer->arena;
+
+    stream->kinds = arena_alloc(arena, capacity * sizeof *stream->kinds);
+    stream->symbols = arena_alloc(arena, capacity * sizeof *stream->symbols);
+    stream->offsets = arena_alloc(arena, capacity * sizeof *stream->offsets);
+    stream->lengths = arena_alloc(arena, capacity * sizeof *stream->lengths);
+    stream->capacity = capacity;
+}
+
+TokenStream token_stream_create(Lexer* const lexer) {
+    assert(TT_COUNT <= UINT8_MAX);
+    assert(lexer->end - lexer->source < UINT32_MAX);
+
+    TokenStream stream = {
+        .lexer = lexer,
+        .base = 0,
+        .length = 0,
+
+        .newlines = NULL,
+        .newlines_length = 0,
+        .has_newlines = false,
+    };
+    token_stream_alloc_ring(&stream, INITIAL_TOKEN_STREAM_CAPACITY);
+
+    return stream;
+}
+
+static void token_stream_grow(TokenStream* const stream) {
+    TokenStream const prev = *stream;
+    token_stream_alloc_ring(stream, prev.capacity * 2);
+
+    for (size_t i = prev.base; i < prev.base + prev.length; ++i) {
+        size_t const from = i & (prev.capacity - 1);
+        size_t const to = i & (stream->capacity - 1);
+
+        stream->kinds[to] = prev.kinds[from];
+        stream->symbols[to] = prev.symbols[from];
+        stream->offsets[to] = prev.offsets[from];
+        stream->lengths[to] = prev.lengths[from];
+    }
+}
+
+static void token_stream_pull(TokenStream* const stream) {
+    if (stream->length == stream->capacity) {
+        token_stream_grow(stream);
+    }
+
+    Lexer* const lexer = stream->lexer;
+    size_t const slot = (stream->base + stream->length) & (stream->capacity - 1);
+
+    // at the end of the source this keeps producing TT_EOF
+    Token const token = lexer_scan_token(lexer);
+
+    stream->kinds[slot] = (uint8_t)token.type;
+    stream->symbols[slot] = token.symbol;
+    if (token.type == TT_ERROR) {
+        // error tokens don't point into the source, keep the message and line instead
+        assert(lexer->error < LE_COUNT);
+        stream->offsets[slot] = lexer->error;
+        stream->lengths[slot] = (uint32_t)token.line;
+    } else {
+        stream->offsets[slot] = (uint32_t)(token.start - lexer->source);
+        stream->lengths[slot] = (uint32_t)token.length;
+    }
+
+    stream->length += 1;
+}
+
+Token token_stream_at(TokenStream* const stream, size_t const index) {
+    assert(index >= stream->base); // token was already released
+
+    while (index >= stream->base + stream->length) {
+        token_stream_pull(stream);
+    }
+
+    size_t const slot = index & (stream->capacity - 1);
+    TokenType const type = stream->kinds[slot];
+
+    if (type == TT_ERROR) {
+        char* const message = LEXER_ERROR_MESSAGES[stream->offsets[slot]];
+
+        return (Token){
+            .type = type,
+            .symbol = SYMBOL_NONE,
+            .start = message,
+            .length = strlen(message),
+            .line = stream->lengths[slot],
+        };
+    }
+
+    return (Token){
+        .type = type,
+        .symbol = stream->symbols[slot],
+        .start = stream->lexer->source + stream->offsets[slot],
+        .length = stream->lengths[slot],
+        .line = 0, // see token_stream_line
+    };
+}
+
+void token_stream_set_type(TokenStream* const stream, size_t const index, TokenType const type) {
+    assert(index >= stream->base && index < stream->base + stream->length);
+    stream->kinds[index & (stream->capacity - 1)] = (uint8_t)type;
+}
+
+static void token_stream_build_newlines(TokenStream* const stream) {
+    char const* const source = stream->lexer->source;
+    char const* const end = stream->lexer->end;
+
+    size_t count = 0;
+    for (char const* c = source; (c = memchr(c, '\n', end - c)); ++c) {
+        count += 1;
+    }
+
+    stream->newlines = arena_alloc(stream->lexer->arena, (count + 1) * sizeof *stream->newlines);
+    stream->newlines_length = 0;
+    for (char const* c = source; (c = memchr(c, '\n', end - c)); ++c) {
+        stream->newlines[stream->newlines_length++] = (uint32_t)(c - source);
+    }
+
+    stream->has_newlines = true;
+}
+
+size_t token_stream_line(TokenStream* const stream, Token const* const token) {
+    if (token->line != 0) {
+        return token->line;
+    }
+
+    if (!stream->has_newlines) {
+        token_stream_build_newlines(stream);
+    }
+
+    // line = 1 + number of newlines before the token
+    uint32_t const offset = (uint32_t)(token->start - stream->lexer->source);
+    size_t low = 0;
+    size_t high = stream->newlines_length;
+    while (low < high) {
+        size_t const mid = low + (high - low) / 2;
+        if (stream->newlines[mid] < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low + 1;
+}
+void token_stream_release(TokenStream* const stream, size_t const index) {
+    if (index <= stream->base) {
+        return;
+    }
+
+    size_t released = index - stream->base;
+    if (released > stream->length) {
+        released = stream->length;
+    }
+
+    stream->base += released;
+    stream->length -= released;
+}
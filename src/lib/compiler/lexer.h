@@ -7,12 +7,17 @@
 typedef struct {
     Arena* arena;
 
+    char* source;
     char* start;
     char* current;
+    char* end;
     size_t line;
 
     size_t template_string_nest;
     size_t multiline_comment_nest;
+
+    // which error the last TT_ERROR token was
+    uint8_t error;
 } Lexer;
 
 typedef struct {
@@ -26,8 +31,46 @@ typedef struct {
 #define scanres_assert(scanres) \
     if (!scanres.ok) { err_print(scanres.res.err); assert(scanres.ok); }
 
+// Tokens pulled from a lexer on demand. Every token from `base` onward is
+// kept (in a ring indexed by absolute token index), so a reader can rewind
+// to anything it hasn't released yet.
+//
+// Tokens are stored compactly as parallel arrays of kind, symbol, source
+// offset and length. Lines aren't stored; token_stream_line works them out from
+// the newline offsets of the source, which are only collected once asked.
+typedef struct {
+    Lexer* lexer;
+
+    uint8_t* kinds;
+    Symbol* symbols;
+    uint32_t* offsets;
+    uint32_t* lengths;
+    size_t capacity; // power of 2
+    size_t base;
+    size_t length;
+
+    uint32_t* newlines;
+    size_t newlines_length;
+    bool has_newlines;
+} TokenStream;
+
+// builds the lexer's shared tables; lexer_create does this too,
+// but it has to happen once up front before lexing on several threads
+void lexer_init(void);
+
 Lexer lexer_create(Arena* const arena, String const source);
 
 ScanResult lexer_scan(Lexer* const lexer);
 
+TokenStream token_stream_create(Lexer* const lexer);
+
+Token token_stream_at(TokenStream* const stream, size_t const index);
+
+void token_stream_set_type(TokenStream* const stream, size_t const index, TokenType const type);
+
+size_t token_stream_line(TokenStream* const stream, Token const* const token);
+
+// drops every token before `index`
+void token_stream_release(TokenStream* const stream, size_t const index);
+
 #endif
@@ -0,0 +1,258 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sysexits.h>
+
+#include "./monomorphizer.h"
+
+#define INITIAL_INSTANCES_CAPACITY 32
+
+// parent of the instances from concrete raw impls, which start a chain
+#define ROOT_INSTANCE SIZE_MAX
+
+// A raw impl that uses the generic params of `owner`, ie. `some<T>()` inside of `fn arr_get<T>`.
+// Every instantiation of the owner instantiates `decl_id` with the owner's args substituted in.
+typedef struct Template {
+    struct Template* next;
+    size_t decl_id;
+    GenericImpl raw;
+} Template;
+
+typedef struct {
+    size_t decl_id;
+    size_t version;
+    size_t depth;
+
+    // instance that caused this one, or ROOT_INSTANCE for instances from concrete raw impls
+    size_t parent;
+} Instance;
+
+typedef struct {
+    Arena* arena;
+    Packages* packages;
+
+    // decl node id => templates owned by that decl
+    Template** templates;
+
+    // doubles as the worklist: instances are processed in the order they were found
+    size_t instances_capacity;
+    size_t instances_length;
+    Instance* instances;
+} Monomorphizer;
+
+static ASTNode* decl_node(Packages* packages, size_t decl_id) {
+    TypeInfo* ti = packages_type_by_node(packages, (NodeId){decl_id});
+    assert(ti);
+    assert(ti->type);
+    assert(ti->type->src);
+    return ti->type->src;
+}
+
+static void print_decl_name(FILE* out, Packages* packages, size_t decl_id) {
+    ASTNode* decl = decl_node(packages, decl_id);
+    switch (decl->type) {
+        case ANT_STRUCT_DECL: {
+            String name = *decl->node.struct_decl->maybe_name;
+            fprintf(out, "%.*s", (int)name.length, name.chars);
+            break;
+        }
+        case ANT_FUNCTION_DECL: {
+            String name = decl->node.function_decl->header.name;
+            fprintf(out, "%.*s", (int)name.length, name.chars);
+            break;
+        }
+        default: {
+            fprintf(out, "<node %lu>", decl_id);
+            break;
+        }
+    }
+}
+
+static void report_depth_exceeded(Monomorphizer* mono, size_t decl_id, size_t parent) {
+    fprintf(stderr, "Generic instantiation of ");
+    print_decl_name(stderr, mono->packages, decl_id);
+    fprintf(stderr, " is nested more than %d levels deep:\n", MAX_INSTANTIATION_DEPTH);
+
+    while (parent != ROOT_INSTANCE) {
+        assert(parent < mono->instances_length);
+        Instance instance = mono->instances[parent];
+        fprintf(stderr, "  instantiated by ");
+        print_decl_name(stderr, mono->packages, instance.decl_id);
+        fprintf(stderr, "\n");
+        parent = instance.parent;
+    }
+
+    exit(EX_DATAERR);
+}
+
+static void add_instance(Monomorphizer* mono, size_t decl_id, GenericImpl args, size_t depth, size_t parent) {
+    GenericImpls* concrete = mono->packages->generic_impls_nodes_concrete + decl_id;
+
+    size_t prev_length = concrete->length;
+    size_t version = generic_impls_add(mono->arena, concrete, args);
+    if (concrete->length == prev_length) {
+        // already instantiated, so its templates were already applied too
+        return;
+    }
+
+    if (depth > MAX_INSTANTIATION_DEPTH) {
+        report_depth_exceeded(mono, decl_id, parent);
+    }
+
+    if (mono->instances_length >= mono->instances_capacity) {
+        size_t prev_cap = mono->instances_capacity;
+        mono->instances_capacity = prev_cap * 2;
+        mono->instances = arena_realloc(mono->arena, mono->instances, sizeof(Instance) * prev_cap, sizeof(Instance) * mono->instances_capacity);
+    }
+
+    mono->instances[mono->instances_length++] = (Instance){
+        .decl_id = decl_id,
+        .version = version,
+        .depth = depth,
+        .parent = parent,
+    };
+}
+
+// the decl whose generic params the raw impl uses, or generic_impls_nodes_length if it has none
+static size_t find_owner(Packages* packages, GenericImpl raw) {
+    size_t owner = packages->generic_impls_nodes_length;
+
+    for (size_t i = 0; i < raw.length; ++i) {
+        ResolvedType* rt = raw.resolved_types[i];
+        if (rt->kind != RTK_GENERIC) {
+            continue;
+        }
+
+        assert(rt->src);
+        assert(owner == packages->generic_impls_nodes_length || owner == rt->src->id.val);
+        owner = rt->src->id.val;
+    }
+
+    return owner;
+}
+
+static void apply_template(Monomorphizer* mono, Template* template, size_t parent) {
+    Instance instance = mono->instances[parent];
+    GenericImpl args = mono->packages->generic_impls_nodes_concrete[instance.decl_id].array[instance.version];
+
+    GenericImpl impl = {
+        .length = template->raw.length,
+        .resolved_types = arena_calloc(mono->arena, template->raw.length, sizeof(ResolvedType*)),
+    };
+    for (size_t i = 0; i < template->raw.length; ++i) {
+        ResolvedType* rt = template->raw.resolved_types[i];
+        if (rt->kind == RTK_GENERIC) {
+            assert(rt->src->id.val == instance.decl_id);
+            assert(rt->type.generic.idx < args.length);
+            rt = args.resolved_types[rt->type.generic.idx];
+        }
+        impl.resolved_types[i] = rt;
+    }
+
+    add_instance(mono, template->decl_id, impl, instance.depth + 1, parent);
+}
+
+// every version of every generic decl, with the args it was instantiated with
+static void dump_instantiations(Packages* packages) {
+    for (size_t decl_id = 0; decl_id < packages->generic_impls_nodes_length; ++decl_id) {
+        GenericImpls const* impls = packages->generic_impls_nodes_concrete + decl_id;
+        if (impls->length == 0) {
+            continue;
+        }
+
+        print_decl_name(stdout, packages, decl_id);
+        printf(":\n");
+        for (size_t version = 0; version < impls->length; ++version) {
+            GenericImpl const impl = impls->array[version];
+            printf("- _%lu <", version);
+            for (size_t i = 0; i < impl.length; ++i) {
+                if (i > 0) {
+                    printf(", ");
+                }
+                print_resolved_type(impl.resolved_types[i]);
+            }
+            printf(">\n");
+        }
+    }
+}
+
+void monomorphize(Packages* packages) {
+    assert(packages->generic_impls_nodes_concrete);
+
+    Monomorphizer mono = {
+        .arena = packages->arena,
+        .packages = packages,
+
+        .templates = arena_calloc(packages->arena, packages->generic_impls_nodes_length > 0 ? packages->generic_impls_nodes_length : 1, sizeof(Template*)),
+
+        .instances_capacity = INITIAL_INSTANCES_CAPACITY,
+        .instances_length = 0,
+        .instances = arena_calloc(packages->arena, INITIAL_INSTANCES_CAPACITY, sizeof(Instance)),
+    };
+
+    // seed the worklist with the concrete raw impls, and file the rest under the decl they depend on
+    Template** template_tails = arena_calloc(packages->arena, packages->generic_impls_nodes_length > 0 ? packages->generic_impls_nodes_length : 1, sizeof(Template*));
+    size_t templates_count = 0;
+
+    for (size_t decl_id = 0; decl_id < packages->generic_impls_nodes_length; ++decl_id) {
+        GenericImpls* raw_impls = packages->generic_impls_nodes_raw + decl_id;
+
+        for (size_t i = 0; i < raw_impls->length; ++i) {
+            GenericImpl raw = raw_impls->array[i];
+            if (raw.length == 0) {
+                continue;
+            }
+
+            size_t owner = find_owner(packages, raw);
+            if (owner == packages->generic_impls_nodes_length) {
+                add_instance(&mono, decl_id, raw, 0, ROOT_INSTANCE);
+                continue;
+            }
+
+            Template* template = arena_alloc(packages->arena, sizeof *template);
+            *template = (Template){
+                .next = NULL,
+                .decl_id = decl_id,
+                .raw = raw,
+            };
+            if (template_tails[owner]) {
+                template_tails[owner]->next = template;
+            } else {
+                mono.templates[owner] = template;
+            }
+            template_tails[owner] = template;
+            templates_count += 1;
+        }
+    }
+
+    size_t max_depth = 0;
+    for (size_t i = 0; i < mono.instances_length; ++i) {
+        if (mono.instances[i].depth > max_depth) {
+            max_depth = mono.instances[i].depth;
+        }
+
+        Template* template = mono.templates[mono.instances[i].decl_id];
+        while (template) {
+            apply_template(&mono, template, i);
+            template = template->next;
+        }
+    }
+
+    size_t decls_count = 0;
+    for (size_t decl_id = 0; decl_id < packages->generic_impls_nodes_length; ++decl_id) {
+        if (packages->generic_impls_nodes_concrete[decl_id].length > 0) {
+            decls_count += 1;
+        }
+    }
+
+    if (log_dumps(LOG_DUMP_GENERICS)) {
+        printf("Monomorphized %lu generic decls into %lu instantiations from %lu templates (max depth %lu)\n",
+            decls_count,
+            mono.instances_length,
+            templates_count,
+            max_depth
+        );
+        dump_instantiations(packages);
+        printf("\n");
+    }
+}
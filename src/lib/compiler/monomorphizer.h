@@ -0,0 +1,15 @@
+#ifndef quill_monomorphizer_h
+#define quill_monomorphizer_h
+
+#include "./package.h"
+#include "../utils/utils.h"
+
+// longest chain of instantiations where each one is caused by the one before it
+#define MAX_INSTANTIATION_DEPTH 64
+
+// Fills packages->generic_impls_nodes_concrete from the raw impls registered during type resolution.
+// Each (decl, concrete args) pair is instantiated once, from a worklist, so the work is linear in the
+// number of distinct instantiations.
+void monomorphize(Packages* packages);
+
+#endif
@@ -5,102 +5,137 @@
 #include "./ast.h"
 #include "resolved_type.h"
 
-#define INITIAL_PACKAGES_CAPACITY 1
-#define HASHTABLE_BUCKETS 16
-
-#define FNV_OFFSET_BASIS 14695981039346656037ULL
-#define FNV_PRIME 1099511628211ULL
-
-static ArrayList_Package arraylist_package_create_with_capacity(Arena* arena, size_t const capacity) {
-    Package* array = arena_alloc(arena, capacity * sizeof(Package));
-
-    return (ArrayList_Package){
-        .capacity = capacity,
-        .length = 0,
-
-        .array = array,
-    };
+#define INITIAL_PACKAGES_CAPACITY 16
+#define INITIAL_GENERIC_IMPLS_INDEX_CAPACITY 8
+
+char* const RUNTIME_PACKAGES[RP_COUNT] = {
+    [RP_STD] = "std",
+    [RP_STD_IO] = "std/io",
+    [RP_STD_DS] = "std/ds",
+};
+
+RuntimeDecl const RUNTIME_DECLS[] = {
+    { RP_STD, "args" },
+    { RP_STD, "assert" },
+    { RP_STD, "exit" },
+    { RP_STD_IO, "eprintln" },
+    { RP_STD_IO, "fwrite_chars" },
+    { RP_STD_IO, "fwrite_str" },
+    { RP_STD_IO, "fwrite_int" },
+    { RP_STD_IO, "fwrite_uint" },
+    { RP_STD_IO, "fwrite_char" },
+    { RP_STD_IO, "fwrite_bool" },
+    { RP_STD_DS, "StringBuffer" },
+    { RP_STD_DS, "strbuf_default" },
+    { RP_STD_DS, "strbuf_append_chars" },
+    { RP_STD_DS, "strbuf_append_str" },
+    { RP_STD_DS, "strbuf_append_int" },
+    { RP_STD_DS, "strbuf_append_uint" },
+    { RP_STD_DS, "strbuf_append_char" },
+    { RP_STD_DS, "strbuf_append_bool" },
+    { RP_STD_DS, "strbuf_as_str" },
+    { RP_STD_DS, "strbuf_free" },
+};
+
+size_t const RUNTIME_DECLS_LENGTH = sizeof RUNTIME_DECLS / sizeof *RUNTIME_DECLS;
+
+bool is_runtime_package(String name) {
+    for (RuntimePackage p = 0; p < RP_ALWAYS_IMPORTED_COUNT; ++p) {
+        if (str_eq(name, c_str(RUNTIME_PACKAGES[p]))) {
+            return true;
+        }
+    }
+    return false;
 }
 
-static ArrayList_Package arraylist_package_create(Arena* arena) {
-    return arraylist_package_create_with_capacity(arena, INITIAL_PACKAGES_CAPACITY);
+static size_t hash_name(PackagePath* name) {
+    size_t hash = FNV_OFFSET_BASIS;
+    PackagePath* curr = name;
+    while (curr) {
+        hash = fingerprint_chars(hash, curr->name);
+        // so a/bc and ab/c differ
+        hash = fingerprint_chars(hash, c_str("/"));
+        curr = curr->child;
+    }
+    return hash;
 }
 
-static void arraylist_package_push(Arena* arena, ArrayList_Package* const list, Package const package) {
-    if (list->length >= list->capacity) {
-        size_t prev_cap = list->capacity;
-        list->capacity = list->length * 2;
-        list->array = arena_realloc(arena, list->array, sizeof(Package) * prev_cap, sizeof(Package) * list->capacity);
+static size_t* packages_slot(Packages const* packages, PackagePath* name) {
+    size_t mask = packages->lookup_capacity - 1;
+    size_t slot = hash_name(name) & mask;
+
+    while (packages->lookup[slot]) {
+        if (package_path_eq(packages->list[packages->lookup[slot] - 1]->full_name, name)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
     }
 
-    list->array[list->length] = package;
-    list->length += 1;
+    return packages->lookup + slot;
 }
 
-static size_t hash_name(PackagePath* name) {
-    if (!name) { return 0; }
+static void packages_grow(Packages* packages) {
+    size_t prev_cap = packages->capacity;
+    packages->capacity = prev_cap * 2;
+    packages->list = arena_realloc(packages->arena, packages->list, sizeof(Package*) * prev_cap, sizeof(Package*) * packages->capacity);
 
-    // FNV-1a
-    size_t hash = FNV_OFFSET_BASIS;
-    PackagePath* curr = name;
-    while (curr) {
-        for (size_t i = 0; i < curr->name.length; ++i) {
-            char c = curr->name.chars[i];
-            hash ^= c;
-            hash *= FNV_PRIME;
+    // keep the lookup at most half full
+    packages->lookup_capacity = packages->capacity * 2;
+    packages->lookup = arena_calloc(packages->arena, packages->lookup_capacity, sizeof(size_t));
+
+    // names are distinct, so each lands in the first empty slot of its probe
+    for (size_t i = 0; i < packages->count; ++i) {
+        size_t slot = hash_name(packages->list[i]->full_name) & (packages->lookup_capacity - 1);
+        while (packages->lookup[slot]) {
+            slot = (slot + 1) & (packages->lookup_capacity - 1);
         }
-        curr = curr->child;
+        packages->lookup[slot] = i + 1;
     }
-
-    // map to bucket index
-    // note: reserve index 0 for no package name
-    hash %= HASHTABLE_BUCKETS - 1;
-    return 1 + hash;
 }
 
 Package* packages_resolve_or_create(Packages* packages, PackagePath* name) {
-    size_t idx = hash_name(name);
-    ArrayList_Package* bucket = packages->lookup_buckets + idx;
-    if (bucket->array == NULL) {
-        *bucket = arraylist_package_create(packages->arena);
+    size_t* slot = packages_slot(packages, name);
+    if (*slot) {
+        return packages->list[*slot - 1];
     }
 
-    for (size_t i = 0; i < bucket->length; ++i) {
-        if (package_path_eq(bucket->array[i].full_name, name)) {
-            return bucket->array + i;
-        }
+    if (packages->count >= packages->capacity) {
+        packages_grow(packages);
+        slot = packages_slot(packages, name);
     }
-    arraylist_package_push(packages->arena, bucket, (Package){
+
+    Package* package = arena_alloc(packages->arena, sizeof *package);
+    *package = (Package){
+        .id = packages->count,
         .full_name = name,
         .ast = NULL,
-    });
+    };
+
+    packages->list[packages->count] = package;
     packages->count += 1;
+    *slot = packages->count;
 
-    return bucket->array + (bucket->length - 1);
+    return package;
 }
 
 Package* packages_resolve(Packages* packages, PackagePath* name) {
-    size_t idx = hash_name(name);
-    ArrayList_Package* bucket = packages->lookup_buckets + idx;
-    if (bucket->array == NULL) {
+    size_t slot = *packages_slot(packages, name);
+    if (!slot) {
         return NULL;
     }
-
-    for (size_t i = 0; i < bucket->length; ++i) {
-        if (package_path_eq(bucket->array[i].full_name, name)) {
-            return bucket->array + i;
-        }
-    }
-
-    return NULL;
+    return packages->list[slot - 1];
 }
 
 Packages packages_create(Arena* arena) {
     return (Packages){
         .arena = arena,
 
-        .lookup_length = HASHTABLE_BUCKETS,
-        .lookup_buckets = arena_calloc(arena, HASHTABLE_BUCKETS, sizeof(ArrayList_Package)),
+        .count = 0,
+        .capacity = INITIAL_PACKAGES_CAPACITY,
+        .list = arena_calloc(arena, INITIAL_PACKAGES_CAPACITY, sizeof(Package*)),
+
+        .lookup_capacity = INITIAL_PACKAGES_CAPACITY * 2,
+        .lookup = arena_calloc(arena, INITIAL_PACKAGES_CAPACITY * 2, sizeof(size_t)),
 
         .types_length = 0,
         .types = NULL,
@@ -109,12 +144,28 @@ Packages packages_create(Arena* arena) {
         .generic_impls_nodes_raw = NULL,
         .generic_impls_nodes_concrete = NULL,
 
-        .count = 0,
+        .type_table = resolved_type_table_create(arena),
 
         .string_literal_type = NULL,
     };
 }
 
+uint64_t fingerprint_mix(uint64_t fingerprint, uint64_t value) {
+    for (size_t i = 0; i < sizeof value; ++i) {
+        fingerprint ^= (value >> (i * 8)) & 0xff;
+        fingerprint *= FNV_PRIME;
+    }
+    return fingerprint;
+}
+
+uint64_t fingerprint_chars(uint64_t fingerprint, String chars) {
+    for (size_t i = 0; i < chars.length; ++i) {
+        fingerprint ^= (unsigned char)chars.chars[i];
+        fingerprint *= FNV_PRIME;
+    }
+    return fingerprint;
+}
+
 TypeInfo* packages_type_by_node(Packages* packages, NodeId node_id) {
     return packages->types + node_id.val;
 }
@@ -123,22 +174,94 @@ TypeInfo* packages_type_by_type(Packages* packages, TypeId type_id) {
     return packages->types + (packages->types_length - 1 - type_id.val);
 }
 
-void ll_generic_impls_push(Arena* arena, LL_GenericImpl* generic_impls, GenericImpl generic_impl) {
-    LLNode_GenericImpl* node = arena_alloc(arena, sizeof *generic_impls->tail);
-    *node = (LLNode_GenericImpl){
-        .data = generic_impl,
-        .next = NULL,
-    };
+static uint64_t hash_generic_impl(GenericImpl generic_impl) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < generic_impl.length; ++i) {
+        hash = fingerprint_mix(hash, resolved_type_eq_hash(generic_impl.resolved_types[i]));
+    }
+    return hash;
+}
+
+static bool generic_impl_eq(GenericImpl a, GenericImpl b) {
+    if (a.length != b.length) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.length; ++i) {
+        if (!resolved_type_eq(a.resolved_types[i], b.resolved_types[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t* generic_impls_slot(GenericImpls const* generic_impls, GenericImpl generic_impl) {
+    size_t mask = generic_impls->index_capacity - 1;
+    size_t slot = hash_generic_impl(generic_impl) & mask;
+
+    while (generic_impls->index[slot]) {
+        GenericImpl other = generic_impls->array[generic_impls->index[slot] - 1];
+        if (generic_impl_eq(generic_impl, other)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return generic_impls->index + slot;
+}
+
+static void generic_impls_grow_index(Arena* arena, GenericImpls* generic_impls) {
+    size_t capacity = generic_impls->index_capacity > 0 ? generic_impls->index_capacity * 2 : INITIAL_GENERIC_IMPLS_INDEX_CAPACITY;
+
+    generic_impls->index_capacity = capacity;
+    generic_impls->index = arena_calloc(arena, capacity, sizeof(size_t));
+
+    // versions are distinct, so each lands in the first empty slot of its probe
+    for (size_t i = 0; i < generic_impls->length; ++i) {
+        size_t slot = hash_generic_impl(generic_impls->array[i]) & (capacity - 1);
+        while (generic_impls->index[slot]) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        generic_impls->index[slot] = i + 1;
+    }
+}
+
+size_t generic_impls_find(GenericImpls const* generic_impls, GenericImpl generic_impl) {
+    if (generic_impls->index_capacity == 0) {
+        return generic_impls->length;
+    }
+
+    size_t version = *generic_impls_slot(generic_impls, generic_impl);
+    if (version == 0) {
+        return generic_impls->length;
+    }
+    return version - 1;
+}
+
+size_t generic_impls_add(Arena* arena, GenericImpls* generic_impls, GenericImpl generic_impl) {
+    // keep the index at most half full
+    if ((generic_impls->length + 1) * 2 > generic_impls->index_capacity) {
+        generic_impls_grow_index(arena, generic_impls);
+    }
+
+    size_t* slot = generic_impls_slot(generic_impls, generic_impl);
+    if (*slot) {
+        return *slot - 1;
+    }
 
-    if (!generic_impls->head) {
-        generic_impls->head = node;
-        generic_impls->tail = node;
-    } else {
-        generic_impls->tail->next = node;
-        generic_impls->tail = node;
+    if (generic_impls->length >= generic_impls->capacity) {
+        size_t prev_cap = generic_impls->capacity;
+        generic_impls->capacity = prev_cap > 0 ? prev_cap * 2 : 1;
+        generic_impls->array = arena_realloc(arena, generic_impls->array, sizeof(GenericImpl) * prev_cap, sizeof(GenericImpl) * generic_impls->capacity);
     }
 
+    size_t version = generic_impls->length;
+    generic_impls->array[version] = generic_impl;
     generic_impls->length += 1;
+    *slot = version + 1;
+
+    return version;
 }
 
 void packages_register_generic_impl(Packages* packages, ASTNode* src, size_t resolved_types_length, ResolvedType** resolved_types) {
@@ -155,31 +278,11 @@ void packages_register_generic_impl(Packages* packages, ASTNode* src, size_t res
     //     return;
     // }
 
-    LL_GenericImpl* generic_impls = packages->generic_impls_nodes_raw + src->id.val;
+    GenericImpls* generic_impls = packages->generic_impls_nodes_raw + src->id.val;
     assert(generic_impls);
+    assert(generic_impls->length == 0 || generic_impls->array[0].length == resolved_types_length);
 
-    LLNode_GenericImpl* curr = generic_impls->head;
-    while (curr) {
-        assert(curr->data.length == resolved_types_length);
-        assert(curr->data.length > 0);
-
-        bool is_same = true;
-
-        for (size_t i = 0; i < curr->data.length; ++i) {
-            if (!resolved_type_eq(resolved_types[i], curr->data.resolved_types[i])) {
-                is_same = false;
-                break;
-            }
-        }
-
-        if (is_same) {
-            return;
-        }
-
-        curr = curr->next;
-    }
-
-    ll_generic_impls_push(packages->arena, generic_impls, (GenericImpl){
+    generic_impls_add(packages->arena, generic_impls, (GenericImpl){
         .length = resolved_types_length,
         .resolved_types = resolved_types,
     });
@@ -192,8 +295,8 @@ void packages_register_generic_impl(Packages* packages, ASTNode* src, size_t res
     //     }
 
     //     if (src->type == ANT_STRUCT_DECL) {
-    //         assert(src->node.struct_decl.generic_params.length > idx);
-    //         String param = src->node.struct_decl.generic_params.array[idx];
+    //         assert(src->node.struct_decl->generic_params.length > idx);
+    //         String param = src->node.struct_decl->generic_params.array[idx];
 
     //         println_astnode(*src);
     //         printf("Uses: \n\n");
@@ -213,11 +316,11 @@ void packages_register_generic_impl(Packages* packages, ASTNode* src, size_t res
     //         Arena arena = {0};
     //         printf("\n\nAs <%s>\n----\n", arena_strcpy(&arena, param).chars);
     //     } else if (src->type == ANT_FUNCTION_DECL) {
-    //         assert(src->node.function_decl.header.generic_params.length > idx);
-    //         String param = src->node.function_decl.header.generic_params.array[idx];
+    //         assert(src->node.function_decl->header.generic_params.length > idx);
+    //         String param = src->node.function_decl->header.generic_params.array[idx];
 
     //         assert(rt->src->type == ANT_FUNCTION_CALL);
-    //         assert(rt->src->node.function_call.generic_args.length == src->node.function_decl.header.generic_params.length);
+    //         assert(rt->src->node.function_call.generic_args.length == src->node.function_decl->header.generic_params.length);
 
     //         size_t i = 0;
     //         LLNode_Type* curr = rt->src->node.function_call.generic_args.head;
@@ -5,11 +5,35 @@
 #include "./resolved_type.h"
 #include "../utils/utils.h"
 
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+// Packages that codegen includes and calls into without the program importing them.
+typedef enum {
+    // imported by every program, so these go before RP_ALWAYS_IMPORTED_COUNT
+    RP_STD,
+    RP_STD_IO,
+    RP_ALWAYS_IMPORTED_COUNT,
+
+    // template strings are built with this package's string buffer,
+    // so it's only needed by files that use them
+    RP_STD_DS = RP_ALWAYS_IMPORTED_COUNT,
+    RP_COUNT
+} RuntimePackage;
+
+extern char* const RUNTIME_PACKAGES[RP_COUNT];
+
+// what codegen refers to by name, rather than through a resolved node
 typedef struct {
-    size_t capacity;
-    size_t length;
-    Package* array;
-} ArrayList_Package;
+    RuntimePackage package;
+    char* name;
+} RuntimeDecl;
+
+extern RuntimeDecl const RUNTIME_DECLS[];
+extern size_t const RUNTIME_DECLS_LENGTH;
+
+// true for the runtime packages that every program gets, not the template string one
+bool is_runtime_package(String name);
 
 typedef enum {
     TIS_UNKNOWN,
@@ -21,6 +45,9 @@ typedef enum {
 typedef struct {
     TypeInfoStatus status;
     ResolvedType* type;
+
+    // package a namespaced reference or import resolved into
+    Package* namespace_;
 } TypeInfo;
 
 typedef struct {
@@ -28,33 +55,41 @@ typedef struct {
     ResolvedType** resolved_types;
 } GenericImpl;
 
-typedef struct LLNode_GenericImpl {
-    struct LLNode_GenericImpl* next;
-    GenericImpl data;
-} LLNode_GenericImpl;
-
+// Instantiations of one generic decl. The version of an instantiation is
+// its index in `array`, and `index` finds it from its argument types.
 typedef struct {
+    size_t capacity;
     size_t length;
-    LLNode_GenericImpl* head;
-    LLNode_GenericImpl* tail;
-} LL_GenericImpl;
+    GenericImpl* array;
+
+    // open-addressed, linear probing: version + 1, 0 for empty
+    size_t index_capacity;
+    size_t* index;
+} GenericImpls;
 
 typedef struct {
     Arena* arena;
 
+    // in the order they were added: a package's id is its index here.
+    // Packages are allocated one by one, so handles stay valid as more are added.
     size_t count;
+    size_t capacity;
+    Package** list;
 
-    // HashTable<String, Package>
-    size_t lookup_length;
-    ArrayList_Package* lookup_buckets;
+    // open-addressed, linear probing on the full name: id + 1, 0 for empty
+    size_t lookup_capacity;
+    size_t* lookup;
 
     // AST Node ID indexes into type info
     size_t types_length;
     TypeInfo* types;
 
     size_t generic_impls_nodes_length;
-    LL_GenericImpl* generic_impls_nodes_raw;
-    LL_GenericImpl* generic_impls_nodes_concrete;
+    GenericImpls* generic_impls_nodes_raw;
+    GenericImpls* generic_impls_nodes_concrete;
+
+    // canonical instances of value-like resolved types
+    ResolvedTypeTable type_table;
 
     ResolvedType* string_literal_type;
     ResolvedType* string_template_type;
@@ -65,11 +100,19 @@ Packages packages_create(Arena* arena);
 Package* packages_resolve(Packages* packages, PackagePath* name);
 Package* packages_resolve_or_create(Packages* packages, PackagePath* name);
 
+// FNV-1a over the bytes of `value`
+uint64_t fingerprint_mix(uint64_t fingerprint, uint64_t value);
+uint64_t fingerprint_chars(uint64_t fingerprint, String chars);
+
 TypeInfo* packages_type_by_node(Packages* packages, NodeId node_id);
 TypeInfo* packages_type_by_type(Packages* packages, TypeId type_id);
 
 void packages_register_generic_impl(Packages* packages, ASTNode* src, size_t resolved_types_length, ResolvedType** resolved_types);
 
-void ll_generic_impls_push(Arena* arena, LL_GenericImpl* generic_impls, GenericImpl generic_impl);
+// returns the version of an equal instantiation, or generic_impls->length if there is none
+size_t generic_impls_find(GenericImpls const* generic_impls, GenericImpl generic_impl);
+
+// adds the instantiation unless an equal one exists, and returns its version
+size_t generic_impls_add(Arena* arena, GenericImpls* generic_impls, GenericImpl generic_impl);
 
 #endif
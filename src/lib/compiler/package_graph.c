@@ -0,0 +1,196 @@
+#include <stdio.h>
+
+#include "./package_graph.h"
+
+#define INITIAL_EDGES_CAPACITY 8
+
+PackageGraph package_graph_create(Arena* arena, Package** packages, size_t packages_length) {
+    // keep the index at most half full
+    size_t index_capacity = 1;
+    while (index_capacity < packages_length * 2) {
+        index_capacity *= 2;
+    }
+
+    PackageGraph graph = {
+        .arena = arena,
+
+        .packages_length = packages_length,
+        .packages = packages,
+
+        .index_capacity = index_capacity,
+        .index_keys = arena_calloc(arena, index_capacity, sizeof(size_t)),
+        .index_values = arena_calloc(arena, index_capacity, sizeof(size_t)),
+
+        .edges_capacity = INITIAL_EDGES_CAPACITY,
+        .edges_length = 0,
+        .edge_importers = arena_calloc(arena, INITIAL_EDGES_CAPACITY, sizeof(size_t)),
+        .edge_imports = arena_calloc(arena, INITIAL_EDGES_CAPACITY, sizeof(size_t)),
+
+        .import_offsets = NULL,
+        .imports = NULL,
+        .importer_offsets = NULL,
+        .importers = NULL,
+    };
+
+    for (size_t i = 0; i < packages_length; ++i) {
+        assert(packages[i]->ast);
+
+        size_t key = packages[i]->ast->id.val + 1;
+        size_t slot = key & (index_capacity - 1);
+        while (graph.index_keys[slot]) {
+            assert(graph.index_keys[slot] != key);
+            slot = (slot + 1) & (index_capacity - 1);
+        }
+
+        graph.index_keys[slot] = key;
+        graph.index_values[slot] = i;
+    }
+
+    return graph;
+}
+
+size_t package_graph_index(PackageGraph const* graph, Package const* package) {
+    assert(package->ast);
+
+    size_t key = package->ast->id.val + 1;
+    size_t slot = key & (graph->index_capacity - 1);
+    while (graph->index_keys[slot]) {
+        if (graph->index_keys[slot] == key) {
+            return graph->index_values[slot];
+        }
+        slot = (slot + 1) & (graph->index_capacity - 1);
+    }
+
+    return graph->packages_length;
+}
+
+void package_graph_add_import(PackageGraph* graph, size_t importer_idx, size_t import_idx) {
+    assert(importer_idx < graph->packages_length);
+    assert(import_idx < graph->packages_length);
+    assert(!graph->import_offsets);
+
+    if (graph->edges_length >= graph->edges_capacity) {
+        size_t prev_cap = graph->edges_capacity;
+        graph->edges_capacity = prev_cap * 2;
+        graph->edge_importers = arena_realloc(graph->arena, graph->edge_importers, sizeof(size_t) * prev_cap, sizeof(size_t) * graph->edges_capacity);
+        graph->edge_imports = arena_realloc(graph->arena, graph->edge_imports, sizeof(size_t) * prev_cap, sizeof(size_t) * graph->edges_capacity);
+    }
+
+    graph->edge_importers[graph->edges_length] = importer_idx;
+    graph->edge_imports[graph->edges_length] = import_idx;
+    graph->edges_length += 1;
+}
+
+// counting sort of the edges by `keys`, stable so each row keeps import order
+static void build_rows(Arena* arena, size_t packages_length, size_t edges_length, size_t const* keys, size_t const* values, size_t** out_offsets, size_t** out_rows) {
+    size_t* offsets = arena_calloc(arena, packages_length + 1, sizeof *offsets);
+    size_t* rows = arena_calloc(arena, edges_length > 0 ? edges_length : 1, sizeof *rows);
+
+    for (size_t i = 0; i < edges_length; ++i) {
+        offsets[keys[i] + 1] += 1;
+    }
+    for (size_t i = 0; i < packages_length; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    size_t* cursors = arena_memcpy(arena, offsets, sizeof(*offsets) * packages_length);
+    for (size_t i = 0; i < edges_length; ++i) {
+        rows[cursors[keys[i]]++] = values[i];
+    }
+
+    *out_offsets = offsets;
+    *out_rows = rows;
+}
+
+void package_graph_build(PackageGraph* graph) {
+    build_rows(graph->arena, graph->packages_length, graph->edges_length, graph->edge_importers, graph->edge_imports, &graph->import_offsets, &graph->imports);
+    build_rows(graph->arena, graph->packages_length, graph->edges_length, graph->edge_imports, graph->edge_importers, &graph->importer_offsets, &graph->importers);
+}
+
+// Every package left unsorted still imports another unsorted package,
+// so following those imports from any of them must loop back.
+static void find_cycle(PackageGraph const* graph, size_t const* in_degree, PackageCycle* cycle) {
+    size_t const unvisited = graph->packages_length;
+
+    size_t* path = arena_calloc(graph->arena, graph->packages_length + 1, sizeof *path);
+    size_t* position = arena_calloc(graph->arena, graph->packages_length, sizeof *position);
+    for (size_t i = 0; i < graph->packages_length; ++i) {
+        position[i] = unvisited;
+    }
+
+    size_t curr = 0;
+    while (in_degree[curr] == 0) {
+        curr += 1;
+        assert(curr < graph->packages_length);
+    }
+
+    size_t path_length = 0;
+    while (position[curr] == unvisited) {
+        position[curr] = path_length;
+        path[path_length++] = curr;
+
+        size_t next = unvisited;
+        for (size_t e = graph->import_offsets[curr]; e < graph->import_offsets[curr + 1]; ++e) {
+            if (in_degree[graph->imports[e]] > 0) {
+                next = graph->imports[e];
+                break;
+            }
+        }
+        assert(next != unvisited);
+        curr = next;
+    }
+    path[path_length++] = curr;
+
+    cycle->length = path_length - position[curr];
+    cycle->package_idxs = path + position[curr];
+}
+
+bool package_graph_sort(PackageGraph const* graph, size_t* order, PackageCycle* cycle) {
+    assert(graph->import_offsets);
+
+    // number of imports not yet sorted, for each package
+    size_t* in_degree = arena_calloc(graph->arena, graph->packages_length > 0 ? graph->packages_length : 1, sizeof *in_degree);
+    for (size_t i = 0; i < graph->packages_length; ++i) {
+        in_degree[i] = graph->import_offsets[i + 1] - graph->import_offsets[i];
+    }
+
+    // order doubles as the queue: sorted packages are popped from the front as their importers are pushed
+    size_t queue_start = 0;
+    size_t queue_end = 0;
+
+    for (size_t i = 0; i < graph->packages_length; ++i) {
+        if (in_degree[i] == 0) {
+            order[queue_end++] = i;
+        }
+    }
+
+    while (queue_start < queue_end) {
+        size_t pkg = order[queue_start++];
+
+        for (size_t e = graph->importer_offsets[pkg]; e < graph->importer_offsets[pkg + 1]; ++e) {
+            size_t importer = graph->importers[e];
+
+            in_degree[importer] -= 1;
+            if (in_degree[importer] == 0) {
+                order[queue_end++] = importer;
+            }
+        }
+    }
+
+    if (queue_end == graph->packages_length) {
+        return true;
+    }
+
+    find_cycle(graph, in_degree, cycle);
+    return false;
+}
+
+String package_graph_name(PackageGraph const* graph, size_t package_idx) {
+    assert(package_idx < graph->packages_length);
+
+    PackagePath* full_name = graph->packages[package_idx]->full_name;
+    if (!full_name) {
+        return c_str("<main>");
+    }
+    return package_path_to_str(graph->arena, full_name);
+}
@@ -0,0 +1,54 @@
+#ifndef quill_package_graph_h
+#define quill_package_graph_h
+
+#include "./package.h"
+#include "../utils/utils.h"
+
+// Import graph between packages, stored as compressed sparse rows.
+// Edges are added in import order, and a package that imports another
+// several times gets one edge per import.
+typedef struct {
+    Arena* arena;
+
+    size_t packages_length;
+    Package** packages;
+
+    // open-addressed, linear probing: file root node id + 1 => package index
+    size_t index_capacity;
+    size_t* index_keys;
+    size_t* index_values;
+
+    size_t edges_capacity;
+    size_t edges_length;
+    size_t* edge_importers;
+    size_t* edge_imports;
+
+    // filled by package_graph_build:
+    // package i imports imports[import_offsets[i]..import_offsets[i + 1]]
+    // and is imported by importers[importer_offsets[i]..importer_offsets[i + 1]]
+    size_t* import_offsets;
+    size_t* imports;
+    size_t* importer_offsets;
+    size_t* importers;
+} PackageGraph;
+
+typedef struct {
+    size_t length;
+    size_t* package_idxs;
+} PackageCycle;
+
+PackageGraph package_graph_create(Arena* arena, Package** packages, size_t packages_length);
+
+// returns packages_length if the package is not in the graph
+size_t package_graph_index(PackageGraph const* graph, Package const* package);
+
+void package_graph_add_import(PackageGraph* graph, size_t importer_idx, size_t import_idx);
+void package_graph_build(PackageGraph* graph);
+
+// Kahn's algorithm: fills order with dependencies before their dependents.
+// Returns false and fills cycle, starting and ending on the same package, if there is an import cycle.
+bool package_graph_sort(PackageGraph const* graph, size_t* order, PackageCycle* cycle);
+
+String package_graph_name(PackageGraph const* graph, size_t package_idx);
+
+#endif
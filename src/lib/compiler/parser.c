@@ -24,6 +24,60 @@ static ASTNodeStatementBlock parser_parse_stmt_block(Parser* const parser);
 static ParseResult parser_parse_simple_expr(Parser* const parser, LL_Directive const directives);
 static ParseResult parser_parse_expr(Parser* const parser, LL_Directive const directives);
 
+// how tightly an operator binds to its left operand, higher binds tighter
+typedef enum {
+    BP_NONE,
+    BP_RANGE,
+    BP_BOOL_OR,
+    BP_BOOL_AND,
+    BP_BIT_OR,
+    BP_BIT_XOR,
+    BP_BIT_AND,
+    BP_EQUALITY,
+    BP_COMPARISON,
+    BP_TERM,
+    BP_FACTOR,
+    BP_PREFIX,
+    BP_POSTFIX,
+} BindingPower;
+
+static BindingPower const INFIX_BINDING_POWERS[TT_COUNT] = {
+    [TT_DOT_DOT] = BP_RANGE,
+    [TT_DOT_DOT_EQUAL] = BP_RANGE,
+
+    [TT_PIPE_PIPE] = BP_BOOL_OR,
+    [TT_AMPERSAND_AMPERSAND] = BP_BOOL_AND,
+
+    [TT_PIPE] = BP_BIT_OR,
+    [TT_CARET] = BP_BIT_XOR,
+    [TT_AMPERSAND] = BP_BIT_AND,
+
+    [TT_EQUAL_EQUAL] = BP_EQUALITY,
+    [TT_BANG_EQUAL] = BP_EQUALITY,
+
+    // (`<` is bumped to BP_POSTFIX when it opens generic args of a call)
+    [TT_LESS] = BP_COMPARISON,
+    [TT_LESS_EQUAL] = BP_COMPARISON,
+    [TT_GREATER] = BP_COMPARISON,
+    [TT_GREATER_EQUAL] = BP_COMPARISON,
+
+    [TT_PLUS] = BP_TERM,
+    [TT_MINUS] = BP_TERM,
+
+    [TT_STAR] = BP_FACTOR,
+    [TT_SLASH] = BP_FACTOR,
+    [TT_PERCENT] = BP_FACTOR,
+
+    [TT_PLUS_PLUS] = BP_POSTFIX,
+    [TT_MINUS_MINUS] = BP_POSTFIX,
+    [TT_LEFT_PAREN] = BP_POSTFIX,
+    [TT_LEFT_BRACKET] = BP_POSTFIX,
+    [TT_DOT] = BP_POSTFIX,
+    [TT_MINUS_GREATER] = BP_POSTFIX,
+};
+
+static ParseResult parser_parse_expr_bp(Parser* const parser, LL_Directive const directives, BindingPower const min_bp);
+
 typedef struct {
     char const* const pattern;
     DirectiveType const type;
@@ -167,8 +221,8 @@ void debug_token_type(TokenType token_type) {
     }
 }
 
-static void debug_token(Parser const* const parser, Token token) {
-    printf("<line %lu> Token[", token.line);
+static void debug_token(Parser* const parser, Token token) {
+    printf("<line %lu> Token[", token_stream_line(&parser->stream, &token));
     debug_token_type(token.type);
 
     char* cstr = arena_memcpy(parser->arena, token.start, token.length + 1);
@@ -204,17 +258,21 @@ static ASTNodeResult astres_err(Error const err) {
     return (ASTNodeResult){ .ok = false, .res.err = err };
 }
 
-static bool parser_is_at_end(Parser const* const parser) {
-    return parser->tokens.array[parser->cursor_current].type == TT_EOF;
+static Token parser_token_at(Parser* const parser, size_t const index) {
+    return token_stream_at(&parser->stream, index);
+}
+
+static bool parser_is_at_end(Parser* const parser) {
+    return parser_token_at(parser, parser->cursor_current).type == TT_EOF;
 }
 
 
-static Token parser_peek_prev(Parser const* const parser) {
-    return parser->tokens.array[parser->cursor_current - 1];
+static Token parser_peek_prev(Parser* const parser) {
+    return parser_token_at(parser, parser->cursor_current - 1);
 }
 
 static Token parser_peek(Parser* parser) {
-    return parser->tokens.array[parser->cursor_current];
+    return parser_token_at(parser, parser->cursor_current);
 }
 
 static Token parser_peek_next(Parser* parser) {
@@ -222,7 +280,7 @@ static Token parser_peek_next(Parser* parser) {
         return parser_peek(parser);
     }
 
-    return parser->tokens.array[parser->cursor_current + 1];
+    return parser_token_at(parser, parser->cursor_current + 1);
 }
 
 static void error_at(Parser* const parser, Token const* const token, char const* const message) {
@@ -232,7 +290,7 @@ static void error_at(Parser* const parser, Token const* const token, char const*
     
     parser->panic_mode = true;
 
-    fprintf(stderr, "[line %lu] Error", token->line);
+    fprintf(stderr, "[line %lu] Error", token_stream_line(&parser->stream, token));
 
     if (token->type == TT_EOF) {
         fprintf(stderr, " at end");
@@ -259,7 +317,7 @@ static void error_at_current(Parser* const parser, char const* const message) {
 }
 
 static Token parser_advance(Parser* const parser) {
-    Token current = parser->tokens.array[parser->cursor_current];
+    Token current = parser_token_at(parser, parser->cursor_current);
     parser->cursor_current += 1;
     return current;
 }
@@ -289,6 +347,7 @@ static StaticPath* parser_parse_static_path(Parser* const parser) {
 
     StaticPath* path = arena_alloc(parser->arena, sizeof *path);
     path->name = name;
+    path->symbol = ident.symbol;
     path->child = NULL;
 
     if (parser_peek(parser).type != TT_COLON_COLON) {
@@ -315,6 +374,7 @@ static PackagePath* parser_parse_package_path(Parser* const parser) {
 
     PackagePath* path = arena_alloc(parser->arena, sizeof *path);
     path->name = name;
+    path->symbol = ident.symbol;
     path->child = NULL;
 
     if (parser_peek(parser).type != TT_SLASH) {
@@ -621,7 +681,7 @@ static Type* parser_parse_type_wrap(Parser* const parser, Type* type) {
                 parser_advance(parser);
             }
             if (parser_peek(parser).type == TT_GREATER_GREATER) {
-                parser->tokens.array[parser->cursor_current].type = TT_GREATER;
+                token_stream_set_type(&parser->stream, parser->cursor_current, TT_GREATER);
             } else {
                 assert(parser_consume(parser, TT_GREATER, "Expected '>' to close generic type"));
             }
@@ -637,7 +697,8 @@ static Type* parser_parse_type_wrap(Parser* const parser, Type* type) {
                 if (!(t.type == TT_LITERAL_NUMBER || t.type == TT_LITERAL_CHAR || t.type == TT_TRUE || t.type == TT_FALSE)) {
                     return NULL;
                 }
-                explicit_size = parser->tokens.array + parser->cursor_current;
+                explicit_size = arena_alloc(parser->arena, sizeof *explicit_size);
+                *explicit_size = t;
                 parser_advance(parser);
             }
             assert(parser_consume(parser, TT_RIGHT_BRACKET, "Exptected ']'"));
@@ -699,7 +760,7 @@ static Type* parser_parse_type(Parser* const parser) {
                 }
 
                 if (parser_peek(parser).type == TT_GREATER_GREATER) {
-                    parser->tokens.array[parser->cursor_current].type = TT_GREATER;
+                    token_stream_set_type(&parser->stream, parser->cursor_current, TT_GREATER);
                 } else {
                     assert(parser_consume(parser, TT_GREATER, "Expected '>' to close generic args"));
                 }
@@ -986,6 +1047,7 @@ static ParseResult parser_parse_struct_decl(Parser* const parser, LL_Directive c
         ll_field_push(parser->arena, &fields, (StructField){
             .type = type,
             .name = name,
+            .symbol = t.symbol,
         });
 
         parser_advance(parser);
@@ -1004,15 +1066,18 @@ static ParseResult parser_parse_struct_decl(Parser* const parser, LL_Directive c
         generic_impls = arraylist_typells_create(parser->arena);
     }
 
+    ASTNodeStructDecl* const struct_decl = arena_alloc(parser->arena, sizeof *struct_decl);
+    *struct_decl = (ASTNodeStructDecl){
+        .maybe_name = m_name,
+        .fields = fields,
+        .generic_params = generic_params,
+        .generic_impls = generic_impls,
+    };
+
     return parseres_ok((ASTNode){
         .id = { parser->next_node_id++ },
         .type = ANT_STRUCT_DECL,
-        .node.struct_decl = {
-            .maybe_name = m_name,
-            .fields = fields,
-            .generic_params = generic_params,
-            .generic_impls = generic_impls,
-        },
+        .node.struct_decl = struct_decl,
         .directives = directives,
     });
 }
@@ -1075,6 +1140,7 @@ static ParseResult parser_parse_lit_str_template(Parser* const parser, LL_Direct
 
             arraylist_string_push(&str_parts, strbuf_to_str(sb));
             parser_advance(parser);
+            parser->uses_string_templates = true;
 
             return parseres_ok((ASTNode){
                 .id = { parser->next_node_id++ },
@@ -1088,7 +1154,7 @@ static ParseResult parser_parse_lit_str_template(Parser* const parser, LL_Direct
         }
 
         case TT_LITERAL_STRING_TEMPLATE_START: {
-            LL_ASTNode expr_parts = {0};
+            ArrayList_ASTNode expr_parts = {0};
             ArrayList_String str_parts = arraylist_string_create(parser->arena);
 
             StringBuffer sb = strbuf_create(parser->arena);
@@ -1111,7 +1177,7 @@ static ParseResult parser_parse_lit_str_template(Parser* const parser, LL_Direct
                 ParseResult expr_res = parser_parse_expr(parser, (LL_Directive){0});
                 assert(expr_res.status == PRS_OK);
 
-                ll_ast_push(parser->arena, &expr_parts, expr_res.node);
+                arraylist_ast_push(parser->arena, &expr_parts, expr_res.node);
 
                 t = parser_peek(parser);
                 assert(t.type == TT_LITERAL_STRING_TEMPLATE_CONT);
@@ -1145,6 +1211,7 @@ static ParseResult parser_parse_lit_str_template(Parser* const parser, LL_Direct
             // }
             // printf("]\n");
 
+            parser->uses_string_templates = true;
             return parseres_ok((ASTNode){
                 .id = { parser->next_node_id++ },
                 .type = ANT_TEMPLATE_STRING,
@@ -1314,13 +1381,109 @@ static ParseResult parser_parse_var_ref(Parser* const parser, LL_Directive const
     });
 }
 
+static bool is_type_token(TokenType const type) {
+    if (type >= TT_VOID && type <= TT_FLOAT64) {
+        return true;
+    }
+
+    switch (type) {
+        case TT_IDENTIFIER:
+        case TT_COMPILER_DIRECTIVE:
+        case TT_COLON_COLON:
+        case TT_STAR:
+        case TT_MUT:
+        case TT_LEFT_BRACKET:
+        case TT_RIGHT_BRACKET:
+        case TT_LITERAL_NUMBER:
+        case TT_LITERAL_CHAR:
+        case TT_TRUE:
+        case TT_FALSE:
+            return true;
+
+        default: return false;
+    }
+}
+
+// index of the first token from `index` that can't be part of a type, tracking `<>` nesting in depth
+static size_t parser_skip_type(Parser* const parser, size_t index, size_t* const depth) {
+    for (;; ++index) {
+        TokenType const type = parser_token_at(parser, index).type;
+
+        if (type == TT_LESS) {
+            *depth += 1;
+        } else if (type == TT_GREATER || type == TT_GREATER_GREATER) {
+            size_t const closing = type == TT_GREATER ? 1 : 2;
+            if (closing > *depth) {
+                return index;
+            }
+            *depth -= closing;
+        } else if (type == TT_COMMA) {
+            if (*depth == 0) {
+                return index;
+            }
+        } else if (!is_type_token(type)) {
+            return index;
+        }
+    }
+}
+
+static bool parser_starts_expr(Parser* const parser, size_t const index) {
+    switch (parser_token_at(parser, index).type) {
+        case TT_IDENTIFIER:
+        case TT_NULL:
+        case TT_TRUE:
+        case TT_FALSE:
+        case TT_SIZEOF:
+        case TT_LITERAL_NUMBER:
+        case TT_LITERAL_CHAR:
+        case TT_LITERAL_STRING:
+        case TT_LITERAL_STRING_TEMPLATE_START:
+        case TT_LITERAL_STRING_TEMPLATE_FULL:
+        case TT_LEFT_PAREN:
+        case TT_LEFT_BRACKET:
+        case TT_BANG:
+        case TT_MINUS:
+        case TT_AMPERSAND:
+        case TT_STAR:
+        case TT_PLUS_PLUS:
+        case TT_MINUS_MINUS:
+            return true;
+
+        case TT_DOT: return parser_token_at(parser, index + 1).type == TT_LEFT_BRACE;
+
+        default: return false;
+    }
+}
+
+// `(` Type `)` followed by an expression
+static bool parser_at_cast(Parser* const parser) {
+    size_t const start = parser->cursor_current + 1;
+    size_t depth = 0;
+    size_t const end = parser_skip_type(parser, start, &depth);
+
+    if (end == start || depth > 0 || parser_token_at(parser, end).type != TT_RIGHT_PAREN) {
+        return false;
+    }
+
+    return parser_starts_expr(parser, end + 1);
+}
+
+// `<` Type, ... `>(`
+static bool parser_at_generic_call(Parser* const parser) {
+    size_t const start = parser->cursor_current + 1;
+    size_t depth = 1;
+    size_t const end = parser_skip_type(parser, start, &depth);
+
+    return end > start + 1 && depth == 0 && parser_token_at(parser, end).type == TT_LEFT_PAREN;
+}
+
 static ParseResult parser_parse_index(Parser* const parser, ASTNode expr) {
     if (parser_peek(parser).type != TT_LEFT_BRACKET) {
         return parseres_none();
     }
     parser_advance(parser);
 
-    ParseResult value_res = parser_parse_simple_expr(parser, (LL_Directive){0});
+    ParseResult value_res = parser_parse_expr(parser, (LL_Directive){0});
     if (value_res.status != PRS_OK) {
         return parseres_none();
     }
@@ -1351,7 +1514,7 @@ static ParseResult parser_parse_range(Parser* const parser, ASTNode expr) {
     bool inclusive = parser_peek(parser).type == TT_DOT_DOT_EQUAL;
     parser_advance(parser);
 
-    ParseResult rhs_res = parser_parse_simple_expr(parser, (LL_Directive){0});
+    ParseResult rhs_res = parser_parse_expr_bp(parser, (LL_Directive){0}, BP_RANGE);
     assert(rhs_res.status == PRS_OK);
 
     ASTNode* lhs = arena_alloc(parser->arena, sizeof *lhs);
@@ -1459,7 +1622,7 @@ static ParseResult parser_parse_fn_call(Parser* const parser, ASTNode expr) {
     while (current.type != TT_RIGHT_PAREN && current.type != TT_EOF) {
         LL_Directive const expr_directives = parser_parse_directives(parser);
         ParseResult const arg_res = parser_parse_expr(parser, expr_directives);
-        ll_ast_push(parser->arena, &fn_call.node.function_call.args, arg_res.node);
+        arraylist_ast_push(parser->arena, &fn_call.node.function_call.args, arg_res.node);
 
         if (arg_res.status != PRS_OK) {
             return parseres_err(fn_call);
@@ -1506,44 +1669,19 @@ static ParseResult parser_parse_sizeof(Parser* const parser, LL_Directive const
 }
 
 static ParseResult parser_parse_tuple_or_cast(Parser* const parser, LL_Directive const directives) {
-    if (!parser_consume(parser, TT_LEFT_PAREN, "Expected '('.")) {
+    if (parser_peek(parser).type != TT_LEFT_PAREN) {
         return parseres_none();
     }
 
-    size_t cached_current = parser->cursor_current;
-    bool failed = false;
-
-    LL_ASTNode exprs = {0};
-
-    Token t = parser_peek(parser);
-    while (t.type != TT_RIGHT_PAREN && t.type != TT_EOF) {
-        ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
-        if (res.status != PRS_OK) {
-            failed = true;
-            break;
-        }
-
-        ll_ast_push(parser->arena, &exprs, res.node);
-
-        t = parser_peek(parser);
-        if (t.type != TT_RIGHT_PAREN && t.type != TT_EOF) {
-            if (t.type != TT_COMMA) {
-                failed = true;
-                break;
-            }
-            t = parser_peek(parser);
-        }
-    }
-
-    if (failed) {
-        parser->cursor_current = cached_current;
+    if (parser_at_cast(parser)) {
+        parser_advance(parser);
 
         Type* type = parser_parse_type(parser);
         assert(type);
 
         assert(parser_consume(parser, TT_RIGHT_PAREN, "Expected ')'."));
 
-        ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
+        ParseResult res = parser_parse_expr_bp(parser, (LL_Directive){0}, BP_PREFIX);
         assert(res.status == PRS_OK);
 
         ASTNode* target = arena_alloc(parser->arena, sizeof *target);
@@ -1559,40 +1697,30 @@ static ParseResult parser_parse_tuple_or_cast(Parser* const parser, LL_Directive
             .directives = directives,
         });
     }
+    parser_advance(parser);
 
-    assert(parser_consume(parser, TT_RIGHT_PAREN, "Expected ')'."));
-
-    if (exprs.length == 1) {
-        size_t cached_current_post = parser->cursor_current;
-
-        ParseResult cast_test = parser_parse_expr(parser, (LL_Directive){0});
-        if (cast_test.status == PRS_OK) {
-            parser->cursor_current = cached_current;
-
-            Type* type = parser_parse_type(parser);
-            assert(type);
-
-            assert(parser_consume(parser, TT_RIGHT_PAREN, "Expected ')'."));
+    ArrayList_ASTNode exprs = {0};
 
-            ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
-            assert(res.status == PRS_OK);
+    Token t = parser_peek(parser);
+    while (t.type != TT_RIGHT_PAREN && t.type != TT_EOF) {
+        ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
+        if (res.status != PRS_OK) {
+            return parseres_none();
+        }
 
-            ASTNode* target = arena_alloc(parser->arena, sizeof *target);
-            *target = res.node;
+        arraylist_ast_push(parser->arena, &exprs, res.node);
 
-            return parseres_ok((ASTNode){
-                .id = { parser->next_node_id++ },
-                .type = ANT_CAST,
-                .node.cast = {
-                    .type = type,
-                    .target = target,
-                },
-                .directives = directives,
-            });
+        t = parser_peek(parser);
+        if (t.type != TT_RIGHT_PAREN && t.type != TT_EOF) {
+            if (!parser_consume(parser, TT_COMMA, "Expected ',' between tuple elements.")) {
+                return parseres_none();
+            }
+            t = parser_peek(parser);
         }
-        parser->cursor_current = cached_current_post;
     }
 
+    assert(parser_consume(parser, TT_RIGHT_PAREN, "Expected ')'."));
+
     return parseres_ok((ASTNode){
         .id = { parser->next_node_id++ },
         .type = ANT_TUPLE,
@@ -1672,47 +1800,32 @@ static ParseResult parser_parse_array_init(Parser* const parser, LL_Directive co
 
     Token t = parser_peek(parser);
     while (t.type != TT_RIGHT_BRACE && t.type != TT_EOF) {
-        size_t cached_current = parser->cursor_current;
-
-        ParseResult s_res = parser_parse_simple_expr(parser, (LL_Directive){0});
-        if (s_res.status == PRS_OK) {
-            if (parser_peek(parser).type == TT_EQUAL) {
-                ASTNode* maybe_index = arena_alloc(parser->arena, sizeof *maybe_index);
-                *maybe_index = s_res.node;
-
-                ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
-                assert(res.status == PRS_OK);
-
-                ASTNode* value = arena_alloc(parser->arena, sizeof *value);
-                *value = res.node;
-                ll_array_init_elem_push(parser->arena, &elems, (ArrayInitElem){
-                    .maybe_index = NULL,
-                    .value = value,
-                });
-            } else if (parser_peek(parser).type == TT_COMMA || parser_peek(parser).type == TT_RIGHT_BRACE) {
-                ASTNode* value = arena_alloc(parser->arena, sizeof *value);
-                *value = s_res.node;
-                ll_array_init_elem_push(parser->arena, &elems, (ArrayInitElem){
-                    .maybe_index = NULL,
-                    .value = value,
-                });
-            } else {
-                assert(parser_consume(parser, TT_RIGHT_BRACE, "Expected '}'"));
-            }
-        } else {
-            parser->cursor_current = cached_current;
+        ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
+        assert(res.status == PRS_OK);
+
+        ASTNode* value = arena_alloc(parser->arena, sizeof *value);
+        *value = res.node;
+
+        ASTNode* maybe_index = NULL;
+
+        // `index = value` puts the value at that index
+        if (parser_peek(parser).type == TT_EQUAL) {
+            parser_advance(parser);
+
+            maybe_index = value;
 
-            ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
+            res = parser_parse_expr(parser, (LL_Directive){0});
             assert(res.status == PRS_OK);
 
-            ASTNode* value = arena_alloc(parser->arena, sizeof *value);
+            value = arena_alloc(parser->arena, sizeof *value);
             *value = res.node;
-            ll_array_init_elem_push(parser->arena, &elems, (ArrayInitElem){
-                .maybe_index = NULL,
-                .value = value,
-            });
         }
 
+        ll_array_init_elem_push(parser->arena, &elems, (ArrayInitElem){
+            .maybe_index = maybe_index,
+            .value = value,
+        });
+
         t = parser_peek(parser);
         if (t.type != TT_RIGHT_BRACE && t.type != TT_EOF) {
             assert(parser_consume(parser, TT_COMMA, "Expected ','"));
@@ -1748,7 +1861,7 @@ static ParseResult parser_parse_unary(Parser* const parser, LL_Directive const d
     }
     parser_advance(parser);
 
-    ParseResult rhs_res = parser_parse_expr(parser, directives);
+    ParseResult rhs_res = parser_parse_expr_bp(parser, directives, BP_PREFIX);
 
     ASTNode* rhs = arena_alloc(parser->arena, sizeof *rhs);
     *rhs = rhs_res.node;
@@ -1793,93 +1906,7 @@ static ParseResult parser_parse_postfix(Parser* const parser, ASTNode expr) {
     });
 }
 
-static ParseResult parser_wrap_simple_expr(Parser* const parser, ParseResult expr_res) {
-    if (expr_res.status != PRS_OK) {
-        return expr_res;
-    }
-    ASTNode expr = expr_res.node;
-
-    switch (parser_peek(parser).type) {
-        case TT_PLUS_PLUS: return parser_wrap_simple_expr(parser, parser_parse_postfix(parser, expr));
-
-        default: break;
-    }
-
-    ParseResult wrapped_res;
-    size_t const cached_current = parser->cursor_current;
-
-    wrapped_res = parser_parse_fn_call(parser, expr);
-    if (wrapped_res.status == PRS_OK) {
-        wrapped_res.node.directives = expr.directives;
-        expr.directives = (LL_Directive){0};
-        return parser_wrap_simple_expr(parser, wrapped_res);
-    }
-    parser->cursor_current = cached_current;
-
-    wrapped_res = parser_parse_get_field(parser, expr);
-    if (wrapped_res.status == PRS_OK) {
-        wrapped_res.node.directives = expr.directives;
-        expr.directives = (LL_Directive){0};
-        return parser_wrap_simple_expr(parser, wrapped_res);
-    }
-    parser->cursor_current = cached_current;
-
-    wrapped_res = parser_parse_index(parser, expr);
-    if (wrapped_res.status == PRS_OK) {
-        wrapped_res.node.directives = expr.directives;
-        expr.directives = (LL_Directive){0};
-        return parser_wrap_simple_expr(parser, wrapped_res);
-    }
-    parser->cursor_current = cached_current;
-
-    return expr_res;
-}
-
-static ParseResult parser_parse_simple_expr(Parser* const parser, LL_Directive const directives) {
-    switch (parser_peek(parser).type) {
-        case TT_NULL: {
-            parser_advance(parser);
-            return parseres_ok((ASTNode){
-                .id = { parser->next_node_id++ },
-                .directives = directives,
-                .type = ANT_LITERAL,
-                .node.literal = {
-                    .kind = LK_NULL,
-                    .value.lit_null = NULL,
-                },
-            });
-        }
-        case TT_SIZEOF: return parser_wrap_simple_expr(parser, parser_parse_sizeof(parser, directives));
-        case TT_LEFT_PAREN: return parser_wrap_simple_expr(parser, parser_parse_tuple_or_cast(parser, directives));
-
-        default: break;
-    }
-
-    ParseResult expr_res;
-    size_t const cached_current = parser->cursor_current;
-
-    expr_res = parser_parse_unary(parser, directives);
-    if (expr_res.status == PRS_OK) {
-        return parser_wrap_simple_expr(parser, expr_res);
-    }
-    parser->cursor_current = cached_current;
-
-    expr_res = parser_parse_lit(parser, directives);
-    if (expr_res.status == PRS_OK) {
-        return parser_wrap_simple_expr(parser, expr_res);
-    }
-    parser->cursor_current = cached_current;
-
-    expr_res = parser_parse_var_ref(parser, directives);
-    if (expr_res.status == PRS_OK) {
-        return parser_wrap_simple_expr(parser, expr_res);
-    }
-    parser->cursor_current = cached_current;
-
-    return parseres_none();
-}
-
-static ParseResult parser_parse_binary(Parser* const parser, ASTNode expr) {
+static ParseResult parser_parse_binary(Parser* const parser, ASTNode expr, BindingPower const bp) {
     BinaryOp op;
     switch (parser_peek(parser).type) {
         case TT_PLUS: op = BO_ADD; break;
@@ -1907,7 +1934,7 @@ static ParseResult parser_parse_binary(Parser* const parser, ASTNode expr) {
     }
     parser_advance(parser);
 
-    ParseResult res = parser_parse_expr(parser, (LL_Directive){0});
+    ParseResult res = parser_parse_expr_bp(parser, (LL_Directive){0}, bp);
     if (res.status != PRS_OK) {
         return parseres_none();
     }
@@ -1932,52 +1959,98 @@ static ParseResult parser_parse_binary(Parser* const parser, ASTNode expr) {
     });
 }
 
-static ParseResult parser_wrap_expr(Parser* const parser, ParseResult expr_res) {
-    if (expr_res.status != PRS_OK) {
-        return expr_res;
-    }
-    ASTNode expr = expr_res.node;
+static ParseResult parser_parse_prefix(Parser* const parser, LL_Directive const directives) {
+    switch (parser_peek(parser).type) {
+        case TT_NULL: {
+            parser_advance(parser);
+            return parseres_ok((ASTNode){
+                .id = { parser->next_node_id++ },
+                .directives = directives,
+                .type = ANT_LITERAL,
+                .node.literal = {
+                    .kind = LK_NULL,
+                    .value.lit_null = NULL,
+                },
+            });
+        }
+        case TT_SIZEOF: return parser_parse_sizeof(parser, directives);
+        case TT_LEFT_PAREN: return parser_parse_tuple_or_cast(parser, directives);
+        case TT_DOT: return parser_parse_struct_init(parser, directives);
+        case TT_LEFT_BRACKET: return parser_parse_array_init(parser, directives);
 
-    ParseResult wrapped_res;
-    size_t const cached_current = parser->cursor_current;
+        case TT_BANG:
+        case TT_MINUS:
+        case TT_AMPERSAND:
+        case TT_STAR:
+        case TT_PLUS_PLUS:
+        case TT_MINUS_MINUS:
+            return parser_parse_unary(parser, directives);
 
-    wrapped_res = parser_parse_binary(parser, expr);
-    if (wrapped_res.status == PRS_OK) {
-        wrapped_res.node.directives = expr.directives;
-        expr.directives = (LL_Directive){0};
-        return parser_wrap_expr(parser, wrapped_res);
-    }
-    parser->cursor_current = cached_current;
+        case TT_IDENTIFIER: return parser_parse_var_ref(parser, directives);
 
-    wrapped_res = parser_parse_range(parser, expr);
-    if (wrapped_res.status == PRS_OK) {
-        wrapped_res.node.directives = expr.directives;
-        expr.directives = (LL_Directive){0};
-        return parser_wrap_expr(parser, wrapped_res);
+        default: return parser_parse_lit(parser, directives);
     }
-    parser->cursor_current = cached_current;
-
-    return expr_res;
 }
 
-static ParseResult parser_parse_expr(Parser* const parser, LL_Directive const directives) {
+static ParseResult parser_parse_infix(Parser* const parser, ASTNode expr, BindingPower const bp) {
     switch (parser_peek(parser).type) {
-        case TT_DOT: return parser_wrap_expr(parser, parser_parse_struct_init(parser, directives));
-        case TT_LEFT_BRACKET: return parser_wrap_expr(parser, parser_parse_array_init(parser, directives));
+        case TT_PLUS_PLUS:
+        case TT_MINUS_MINUS:
+            return parser_parse_postfix(parser, expr);
 
-        default: break;
+        case TT_LESS: {
+            if (bp == BP_POSTFIX) {
+                return parser_parse_fn_call(parser, expr);
+            }
+            return parser_parse_binary(parser, expr, bp);
+        }
+
+        case TT_LEFT_PAREN: return parser_parse_fn_call(parser, expr);
+        case TT_DOT:
+        case TT_MINUS_GREATER:
+            return parser_parse_get_field(parser, expr);
+        case TT_LEFT_BRACKET: return parser_parse_index(parser, expr);
+
+        case TT_DOT_DOT:
+        case TT_DOT_DOT_EQUAL:
+            return parser_parse_range(parser, expr);
+
+        default: return parser_parse_binary(parser, expr, bp);
     }
+}
 
-    ParseResult expr_res;
-    size_t const cached_current = parser->cursor_current;
+static ParseResult parser_parse_expr_bp(Parser* const parser, LL_Directive const directives, BindingPower const min_bp) {
+    ParseResult expr_res = parser_parse_prefix(parser, directives);
+
+    while (expr_res.status == PRS_OK) {
+        Token const t = parser_peek(parser);
+
+        BindingPower bp = INFIX_BINDING_POWERS[t.type];
+        if (t.type == TT_LESS && parser_at_generic_call(parser)) {
+            bp = BP_POSTFIX;
+        }
+
+        if (bp <= min_bp) {
+            break;
+        }
 
-    expr_res = parser_parse_simple_expr(parser, directives);
-    if (expr_res.status == PRS_OK) {
-        return parser_wrap_expr(parser, expr_res);
+        ASTNode const expr = expr_res.node;
+        expr_res = parser_parse_infix(parser, expr, bp);
+        if (expr_res.status == PRS_OK) {
+            expr_res.node.directives = expr.directives;
+        }
     }
-    parser->cursor_current = cached_current;
 
-    return parseres_none();
+    return expr_res;
+}
+
+// unary, literals, paths and their postfix ops (calls, fields, indexing), but no binary ops
+static ParseResult parser_parse_simple_expr(Parser* const parser, LL_Directive const directives) {
+    return parser_parse_expr_bp(parser, directives, BP_PREFIX);
+}
+
+static ParseResult parser_parse_expr(Parser* const parser, LL_Directive const directives) {
+    return parser_parse_expr_bp(parser, directives, BP_NONE);
 }
 
 static ParseResult parser_parse_var_decl(Parser* const parser, LL_Directive const directives) {
@@ -2427,7 +2500,7 @@ static ParseResult parser_parse_stmt(Parser* const parser) {
 static ASTNodeStatementBlock parser_parse_stmt_block(Parser* const parser) {
     assert(parser_consume(parser, TT_LEFT_BRACE, "Expected '{'"));
 
-    LL_ASTNode stmts = {0};
+    ArrayList_ASTNode stmts = {0};
 
     Token t = parser_peek(parser);
     while (t.type != TT_RIGHT_BRACE && t.type != TT_EOF) {
@@ -2448,7 +2521,7 @@ static ASTNodeStatementBlock parser_parse_stmt_block(Parser* const parser) {
         }
         assert(res.status == PRS_OK);
 
-        ll_ast_push(parser->arena, &stmts, res.node);
+        arraylist_ast_push(parser->arena, &stmts, res.node);
         t = parser_peek(parser);
     }
     assert(parser_consume(parser, TT_RIGHT_BRACE, "Expected '}'"));
@@ -2530,6 +2603,7 @@ static ParseResult parser_parse_fn_decl(Parser* const parser, LL_Directive const
                 .length = current.length,
                 .chars = current.start,
             },
+            .symbol = current.symbol,
         };
 
         current = parser_peek(parser);
@@ -2554,37 +2628,39 @@ static ParseResult parser_parse_fn_decl(Parser* const parser, LL_Directive const
 
     bool is_main = str_eq(name, c_str("main"));
 
+    ASTNodeFunctionHeaderDecl const header = {
+        .return_type = *type,
+        .name = name,
+        .generic_params = generic_params,
+        .generic_impls = generic_impls,
+        .params = params,
+        .is_main = is_main,
+    };
+
     if (parser_peek(parser).type == TT_SEMICOLON) {
         parser_advance(parser);
+
+        ASTNodeFunctionHeaderDecl* const header_decl = arena_alloc(parser->arena, sizeof *header_decl);
+        *header_decl = header;
+
         return parseres_ok((ASTNode){
             .id = { parser->next_node_id++ },
             .type = ANT_FUNCTION_HEADER_DECL,
-            .node.function_header_decl = {
-                .return_type = *type,
-                .name = name,
-                .generic_params = generic_params,
-                .generic_impls = generic_impls,
-                .params = params,
-                .is_main = is_main,
-            },
+            .node.function_header_decl = header_decl,
             .directives = directives,
         });
     }
 
+    ASTNodeFunctionDecl* const function_decl = arena_alloc(parser->arena, sizeof *function_decl);
+    *function_decl = (ASTNodeFunctionDecl){
+        .header = header,
+        .stmts = {0},
+    };
+
     ASTNode node = {
         .id = { parser->next_node_id++ },
         .type = ANT_FUNCTION_DECL,
-        .node.function_decl = {
-            .header = {
-                .return_type = *type,
-                .name = name,
-                .generic_params = generic_params,
-                .generic_impls = generic_impls,
-                .params = params,
-                .is_main = is_main,
-            },
-            .stmts = {0},
-        },
+        .node.function_decl = function_decl,
         .directives = directives,
     };
 
@@ -2607,7 +2683,7 @@ static ParseResult parser_parse_fn_decl(Parser* const parser, LL_Directive const
         }
 
         ParseResult const stmt_res = parser_parse_stmt(parser);
-        ll_ast_push(parser->arena, &node.node.function_decl.stmts, stmt_res.node);
+        arraylist_ast_push(parser->arena, &function_decl->stmts, stmt_res.node);
 
         if (stmt_res.status != PRS_OK) {
             if (stmt_res.status == PRS_NONE) {
@@ -2681,16 +2757,17 @@ static ParseResult parser_parse_node(Parser* const parser) {
     return parser_parse_filescope_decl(parser);
 }
 
-Parser parser_create(Arena* const arena, ArrayList_Token const tokens) {
+Parser parser_create(Arena* const arena, Lexer* const lexer) {
     return (Parser){
         .arena = arena,
-        .tokens = tokens,
+        .stream = token_stream_create(lexer),
         .cursor_start = 0,
         .cursor_current = 0,
 
         .package = NULL,
         .had_error = false,
         .panic_mode = false,
+        .uses_string_templates = false,
 
         .next_node_id = 0,
         .next_type_id = 0,
@@ -2698,10 +2775,17 @@ Parser parser_create(Arena* const arena, ArrayList_Token const tokens) {
 }
 
 ASTNodeResult parser_parse(Parser* const parser) {
-    LL_ASTNode nodes = {0};
+    ArrayList_ASTNode nodes = {0};
+    size_t package_idx = 0;
+    bool has_package = false;
 
     while (!parser_is_at_end(parser)) {
         parser->cursor_start = parser->cursor_current;
+
+        // backtracking never crosses a filescope decl, keep just the previous token for errors
+        if (parser->cursor_start > 0) {
+            token_stream_release(&parser->stream, parser->cursor_start - 1);
+        }
     
         ParseResult const node_res = parser_parse_node(parser);
         if (node_res.status != PRS_OK) {
@@ -2709,17 +2793,24 @@ ASTNodeResult parser_parse(Parser* const parser) {
             parser_advance(parser);
         }
 
-        ll_ast_push(parser->arena, &nodes, node_res.node);
+        arraylist_ast_push(parser->arena, &nodes, node_res.node);
 
         if (node_res.node.type == ANT_PACKAGE) {
-            assert(!parser->package);
-            parser->package = &nodes.tail->data;
+            assert(!has_package);
+            package_idx = nodes.length - 1;
+            has_package = true;
         }
     }
 
+    // nodes may move while the list grows, so only point into it once it's done
+    if (has_package) {
+        parser->package = nodes.array + package_idx;
+    }
+
     ASTNode* const file_root = arena_alloc(parser->arena, sizeof(ASTNode));
     file_root->id.val = parser->next_node_id++;
     file_root->type = ANT_FILE_ROOT;
+    file_root->directives = (LL_Directive){0};
     file_root->node.file_root = (ASTNodeFileRoot){ .nodes = nodes };
 
     return astres_ok(file_root);
@@ -2,19 +2,22 @@
 #define quill_parser_h
 
 #include "./ast.h"
+#include "./lexer.h"
 #include "./token.h"
 #include "../utils/utils.h"
 
 typedef struct {
     Arena* const arena;
     
-    ArrayList_Token const tokens;
+    TokenStream stream;
     size_t cursor_start;
     size_t cursor_current;
 
     ASTNode* package;
     bool had_error;
     bool panic_mode;
+    // codegen lowers these with the runtime's string template type
+    bool uses_string_templates;
 
     size_t next_node_id;
     size_t next_type_id;
@@ -25,7 +28,7 @@ typedef struct {
 
 void debug_token_type(TokenType token_type);
 
-Parser parser_create(Arena* const arena, ArrayList_Token const tokens);
+Parser parser_create(Arena* const arena, Lexer* const lexer);
 
 ASTNodeResult parser_parse(Parser* const parser);
 
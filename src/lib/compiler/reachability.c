@@ -0,0 +1,495 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./reachability.h"
+
+#define INITIAL_WORKLIST_CAPACITY 64
+
+typedef struct {
+    Package* package;
+    ASTNode* decl;
+} Reached;
+
+typedef struct {
+    Arena* arena;
+    Packages* packages;
+    bool* reachable;
+
+    // decls to walk, each one pushed once
+    size_t worklist_capacity;
+    size_t worklist_length;
+    Reached* worklist;
+} Walker;
+
+static bool is_prunable(ASTNode const* node) {
+    switch (node->type) {
+        case ANT_FUNCTION_DECL:
+        case ANT_VAR_DECL:
+        case ANT_STRUCT_DECL:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static bool has_directive(ASTNode const* node, DirectiveType type) {
+    for (LLNode_Directive* curr = node->directives.head; curr; curr = curr->next) {
+        if (curr->data.type == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_c_header(Package const* package) {
+    ASTNodeFileRoot const root = package->ast->node.file_root;
+    for (size_t i = 0; i < root.nodes.length; ++i) {
+        ASTNode const* curr = root.nodes.array + i;
+        if (curr->type == ANT_PACKAGE && has_directive(curr, DT_C_HEADER)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void push(Walker* walker, Package* package, ASTNode* decl) {
+    if (walker->worklist_length == walker->worklist_capacity) {
+        size_t const new_capacity = walker->worklist_capacity ? walker->worklist_capacity * 2 : INITIAL_WORKLIST_CAPACITY;
+        walker->worklist = arena_realloc(
+            walker->arena,
+            walker->worklist,
+            walker->worklist_capacity * sizeof *walker->worklist,
+            new_capacity * sizeof *walker->worklist
+        );
+        walker->worklist_capacity = new_capacity;
+    }
+
+    walker->worklist[walker->worklist_length++] = (Reached){ .package = package, .decl = decl };
+}
+
+static void reach(Walker* walker, Package* package, ASTNode* decl) {
+    if (!package || !decl || !is_prunable(decl)) {
+        return;
+    }
+
+    assert(decl->id.val < walker->packages->generic_impls_nodes_length);
+    if (walker->reachable[decl->id.val]) {
+        return;
+    }
+
+    walker->reachable[decl->id.val] = true;
+    push(walker, package, decl);
+}
+
+static void reach_name(Walker* walker, Package* package, String name) {
+    if (!package) {
+        return;
+    }
+
+    // headers are implemented by @impl functions, which are always reachable
+    reach(walker, package, decl_index_by_name(&package->decls, name));
+}
+
+static void reach_resolved_type(Walker* walker, ResolvedType* rt);
+
+static void reach_resolved_types(Walker* walker, ResolvedTypes rts) {
+    for (size_t i = 0; i < rts.length; ++i) {
+        reach_resolved_type(walker, rts.resolved_types[i]);
+    }
+}
+
+static void reach_resolved_type(Walker* walker, ResolvedType* rt) {
+    if (!rt) {
+        return;
+    }
+
+    switch (rt->kind) {
+        case RTK_POINTER: reach_resolved_type(walker, rt->type.ptr.of); break;
+        case RTK_MUT_POINTER: reach_resolved_type(walker, rt->type.mut_ptr.of); break;
+        case RTK_ARRAY: reach_resolved_type(walker, rt->type.array.of); break;
+
+        case RTK_STRUCT_DECL: reach(walker, rt->from_pkg, rt->src); break;
+        case RTK_STRUCT_REF: {
+            ResolvedType* decl = rt->type.struct_ref.decl;
+            if (decl) {
+                reach(walker, decl->from_pkg, decl->src);
+            }
+            reach_resolved_types(walker, rt->type.struct_ref.generic_args);
+            break;
+        }
+
+        // params and return types are walked with the decl
+        case RTK_FUNCTION_DECL: reach(walker, rt->from_pkg, rt->src); break;
+        case RTK_FUNCTION_REF: {
+            reach(walker, rt->from_pkg, rt->src);
+            reach_resolved_types(walker, rt->type.function_ref.generic_args);
+            break;
+        }
+
+        default: break;
+    }
+}
+
+static void walk_type(Walker* walker, Type* type);
+
+static void walk_types(Walker* walker, LL_Type types) {
+    for (LLNode_Type* curr = types.head; curr; curr = curr->next) {
+        walk_type(walker, &curr->data);
+    }
+}
+
+static void walk_type(Walker* walker, Type* type) {
+    if (!type) {
+        return;
+    }
+
+    reach_resolved_type(walker, packages_type_by_type(walker->packages, type->id)->type);
+
+    switch (type->kind) {
+        case TK_STATIC_PATH: walk_types(walker, type->type.static_path.generic_args); break;
+        case TK_POINTER: walk_type(walker, type->type.ptr.of); break;
+        case TK_MUT_POINTER: walk_type(walker, type->type.mut_ptr.of); break;
+        case TK_ARRAY: walk_type(walker, type->type.array.of); break;
+
+        default: break;
+    }
+}
+
+static void walk_node(Walker* walker, Package* package, ASTNode* node);
+
+static void walk_nodes(Walker* walker, Package* package, ArrayList_ASTNode nodes) {
+    for (size_t i = 0; i < nodes.length; ++i) {
+        walk_node(walker, package, nodes.array + i);
+    }
+}
+
+static void walk_block(Walker* walker, Package* package, ASTNodeStatementBlock* block) {
+    if (block) {
+        walk_nodes(walker, package, block->stmts);
+    }
+}
+
+static void walk_fn_header(Walker* walker, ASTNodeFunctionHeaderDecl* header) {
+    walk_type(walker, &header->return_type);
+    for (size_t i = 0; i < header->generic_impls.length; ++i) {
+        walk_types(walker, header->generic_impls.array[i]);
+    }
+    for (LLNode_FnParam* curr = header->params.head; curr; curr = curr->next) {
+        walk_type(walker, &curr->data.type);
+    }
+}
+
+// the name a single-name import brings into scope, if any
+static ImportStaticPath* import_ident(ASTNodeImport const* import) {
+    ImportPath* curr = import->import_path;
+    while (curr->type != IPT_FILE) {
+        curr = curr->import.dir.child;
+    }
+
+    ImportStaticPath* ident = curr->import.file.child;
+    if (!ident || ident->type != ISPT_IDENT) {
+        return NULL;
+    }
+    return ident;
+}
+
+// Statics aren't found through the type of a reference, so references are also
+// looked up by name. A local that shadows a decl only keeps more than needed.
+static void walk_var_ref(Walker* walker, Package* package, ASTNode* node) {
+    StaticPath* path = node->node.var_ref.path;
+    TypeInfo const ti = walker->packages->types[node->id.val];
+
+    if (path->child) {
+        StaticPath* last = path;
+        while (last->child) {
+            last = last->child;
+        }
+        reach_name(walker, ti.namespace_, last->name);
+        return;
+    }
+
+    reach_name(walker, package, path->name);
+
+    ASTNodeFileRoot const root = package->ast->node.file_root;
+    for (size_t i = 0; i < root.nodes.length; ++i) {
+        ASTNode* curr = root.nodes.array + i;
+        if (curr->type != ANT_IMPORT) {
+            continue;
+        }
+
+        ImportStaticPath* ident = import_ident(&curr->node.import);
+        if (ident && str_eq(ident->import.ident.name, path->name)) {
+            reach_name(walker, walker->packages->types[curr->id.val].namespace_, path->name);
+        }
+    }
+}
+
+static void walk_node(Walker* walker, Package* package, ASTNode* node) {
+    if (!node) {
+        return;
+    }
+
+    reach_resolved_type(walker, walker->packages->types[node->id.val].type);
+
+    switch (node->type) {
+        case ANT_VAR_REF: walk_var_ref(walker, package, node); break;
+
+        case ANT_UNARY_OP: walk_node(walker, package, node->node.unary_op.right); break;
+        case ANT_POSTFIX_OP: walk_node(walker, package, node->node.postfix_op.left); break;
+        case ANT_BINARY_OP: {
+            walk_node(walker, package, node->node.binary_op.lhs);
+            walk_node(walker, package, node->node.binary_op.rhs);
+            break;
+        }
+
+        case ANT_TUPLE: walk_nodes(walker, package, node->node.tuple.exprs); break;
+
+        case ANT_VAR_DECL: {
+            walk_type(walker, node->node.var_decl.type_or_let.maybe_type);
+            walk_node(walker, package, node->node.var_decl.initializer);
+            break;
+        }
+
+        case ANT_GET_FIELD: walk_node(walker, package, node->node.get_field.root); break;
+        case ANT_INDEX: {
+            walk_node(walker, package, node->node.index.root);
+            walk_node(walker, package, node->node.index.value);
+            break;
+        }
+        case ANT_RANGE: {
+            walk_node(walker, package, node->node.range.lhs);
+            walk_node(walker, package, node->node.range.rhs);
+            break;
+        }
+        case ANT_ASSIGNMENT: {
+            walk_node(walker, package, node->node.assignment.lhs);
+            walk_node(walker, package, node->node.assignment.rhs);
+            break;
+        }
+        case ANT_FUNCTION_CALL: {
+            walk_node(walker, package, node->node.function_call.function);
+            walk_types(walker, node->node.function_call.generic_args);
+            walk_nodes(walker, package, node->node.function_call.args);
+            break;
+        }
+
+        case ANT_STATEMENT_BLOCK: walk_nodes(walker, package, node->node.statement_block.stmts); break;
+        case ANT_IF: {
+            walk_node(walker, package, node->node.if_.cond);
+            walk_block(walker, package, node->node.if_.block);
+            walk_node(walker, package, node->node.if_.else_);
+            break;
+        }
+        case ANT_TRY: walk_node(walker, package, node->node.try_.target); break;
+        case ANT_CATCH: {
+            walk_node(walker, package, node->node.catch_.target);
+            walk_node(walker, package, node->node.catch_.then);
+            break;
+        }
+        case ANT_BREAK: walk_node(walker, package, node->node.break_.maybe_expr); break;
+        case ANT_WHILE: {
+            walk_node(walker, package, node->node.while_.cond);
+            walk_block(walker, package, node->node.while_.block);
+            break;
+        }
+        case ANT_DO_WHILE: {
+            walk_block(walker, package, node->node.do_while.block);
+            walk_node(walker, package, node->node.do_while.cond);
+            break;
+        }
+        case ANT_FOR: {
+            walk_node(walker, package, node->node.for_.init);
+            walk_node(walker, package, node->node.for_.cond);
+            walk_node(walker, package, node->node.for_.step);
+            walk_block(walker, package, node->node.for_.block);
+            break;
+        }
+        case ANT_FOREACH: {
+            walk_node(walker, package, node->node.foreach.iterable);
+            walk_block(walker, package, node->node.foreach.block);
+            break;
+        }
+        case ANT_RETURN: walk_node(walker, package, node->node.return_.maybe_expr); break;
+        case ANT_DEFER: walk_node(walker, package, node->node.defer.stmt); break;
+        case ANT_CRASH: walk_node(walker, package, node->node.crash.maybe_expr); break;
+
+        case ANT_STRUCT_INIT: {
+            for (LLNode_StructFieldInit* curr = node->node.struct_init.fields.head; curr; curr = curr->next) {
+                walk_node(walker, package, curr->data.value);
+            }
+            break;
+        }
+        case ANT_ARRAY_INIT: {
+            walk_node(walker, package, node->node.array_init.maybe_explicit_length);
+            for (LLNode_ArrayInitElem* curr = node->node.array_init.elems.head; curr; curr = curr->next) {
+                walk_node(walker, package, curr->data.maybe_index);
+                walk_node(walker, package, curr->data.value);
+            }
+            break;
+        }
+
+        case ANT_TEMPLATE_STRING: walk_nodes(walker, package, node->node.template_string.template_expr_parts); break;
+
+        case ANT_SIZEOF: {
+            if (node->node.sizeof_.kind == SOK_TYPE) {
+                walk_type(walker, node->node.sizeof_.sizeof_.type);
+            } else {
+                walk_node(walker, package, node->node.sizeof_.sizeof_.expr);
+            }
+            break;
+        }
+        case ANT_SWITCH: {
+            walk_node(walker, package, node->node.switch_.expr);
+            for (size_t i = 0; i < node->node.switch_.cases_count; ++i) {
+                SwitchCase* const switch_case = node->node.switch_.cases + i;
+                if (switch_case->matches) {
+                    walk_nodes(walker, package, *switch_case->matches);
+                }
+                walk_node(walker, package, switch_case->then);
+            }
+            walk_node(walker, package, node->node.switch_.maybe_else);
+            break;
+        }
+        case ANT_CAST: {
+            walk_type(walker, node->node.cast.type);
+            walk_node(walker, package, node->node.cast.target);
+            break;
+        }
+
+        case ANT_STRUCT_DECL: {
+            for (LLNode_StructField* curr = node->node.struct_decl->fields.head; curr; curr = curr->next) {
+                walk_type(walker, curr->data.type);
+            }
+            for (size_t i = 0; i < node->node.struct_decl->generic_impls.length; ++i) {
+                walk_types(walker, node->node.struct_decl->generic_impls.array[i]);
+            }
+            break;
+        }
+        case ANT_TYPEDEF_DECL: walk_type(walker, node->node.typedef_decl.type); break;
+        case ANT_FUNCTION_HEADER_DECL: walk_fn_header(walker, node->node.function_header_decl); break;
+        case ANT_FUNCTION_DECL: {
+            walk_fn_header(walker, &node->node.function_decl->header);
+            walk_nodes(walker, package, node->node.function_decl->stmts);
+            break;
+        }
+
+        // nothing to reach below these
+        case ANT_NONE:
+        case ANT_FILE_ROOT:
+        case ANT_FILE_SEPARATOR:
+        case ANT_LITERAL:
+        case ANT_CONTINUE:
+        case ANT_IMPORT:
+        case ANT_PACKAGE:
+        case ANT_UNION_DECL:
+        case ANT_ENUM_DECL:
+        case ANT_GLOBALTAG_DECL:
+        case ANT_COUNT:
+            break;
+    }
+}
+
+// every version of a generic decl gets generated, so the types of all of them are needed
+static void walk_generic_versions(Walker* walker, ASTNode* decl) {
+    GenericImpls const* impls = walker->packages->generic_impls_nodes_concrete + decl->id.val;
+    for (size_t version = 0; version < impls->length; ++version) {
+        GenericImpl const impl = impls->array[version];
+        for (size_t i = 0; i < impl.length; ++i) {
+            reach_resolved_type(walker, impl.resolved_types[i]);
+        }
+    }
+}
+
+static void push_roots(Walker* walker) {
+    Packages* packages = walker->packages;
+
+    for (size_t i = 0; i < packages->count; ++i) {
+        Package* package = packages->list[i];
+        if (!package->ast) {
+            continue;
+        }
+
+        ASTNodeFileRoot const root = package->ast->node.file_root;
+        for (size_t j = 0; j < root.nodes.length; ++j) {
+            ASTNode* curr = root.nodes.array + j;
+            switch (curr->type) {
+                case ANT_FUNCTION_DECL: {
+                    if ((package->is_entry && curr->node.function_decl->header.is_main) || has_directive(curr, DT_IMPL)) {
+                        reach(walker, package, curr);
+                    }
+                    break;
+                }
+
+                // typedefs are always generated
+                case ANT_TYPEDEF_DECL: push(walker, package, curr); break;
+
+                default: break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < RUNTIME_DECLS_LENGTH; ++i) {
+        RuntimeDecl const runtime_decl = RUNTIME_DECLS[i];
+        for (size_t j = 0; j < packages->count; ++j) {
+            Package* package = packages->list[j];
+            if (package->ast && package->full_name && str_eq(package_path_to_str(walker->arena, package->full_name), c_str(RUNTIME_PACKAGES[runtime_decl.package]))) {
+                reach_name(walker, package, c_str(runtime_decl.name));
+            }
+        }
+    }
+
+    reach_resolved_type(walker, packages->string_literal_type);
+    reach_resolved_type(walker, packages->string_template_type);
+    reach_resolved_type(walker, packages->range_literal_type);
+}
+
+Reachability reachability_find(Arena* arena, Packages* packages) {
+    Walker walker = {
+        .arena = arena,
+        .packages = packages,
+        .reachable = arena_calloc(arena, packages->generic_impls_nodes_length, sizeof *walker.reachable),
+    };
+
+    push_roots(&walker);
+
+    while (walker.worklist_length > 0) {
+        Reached const curr = walker.worklist[--walker.worklist_length];
+        walk_node(&walker, curr.package, curr.decl);
+        walk_generic_versions(&walker, curr.decl);
+    }
+
+    Reachability reachability = {
+        .length = packages->generic_impls_nodes_length,
+        .reachable = walker.reachable,
+    };
+
+    for (size_t i = 0; i < packages->count; ++i) {
+        Package const* package = packages->list[i];
+        if (!package->ast || is_c_header(package)) {
+            continue;
+        }
+
+        ASTNodeFileRoot const root = package->ast->node.file_root;
+        for (size_t j = 0; j < root.nodes.length; ++j) {
+            ASTNode const* curr = root.nodes.array + j;
+            if (is_prunable(curr)) {
+                reachability.decls += 1;
+                if (!reachability_keeps(&reachability, curr)) {
+                    reachability.pruned += 1;
+                }
+            }
+        }
+    }
+
+    return reachability;
+}
+
+bool reachability_keeps(Reachability const* reachability, ASTNode const* node) {
+    if (!is_prunable(node)) {
+        return true;
+    }
+
+    assert(node->id.val < reachability->length);
+    return reachability->reachable[node->id.val];
+}
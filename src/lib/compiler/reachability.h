@@ -0,0 +1,28 @@
+#ifndef quill_reachability_h
+#define quill_reachability_h
+
+#include "./package.h"
+#include "../utils/utils.h"
+
+// Top-level functions, statics and structs that the program can reach, starting
+// from main, @impl functions, typedefs, and what codegen calls by name.
+//
+// A decl is kept or left out as a whole: a reachable generic keeps every version
+// it was instantiated with, and the types of all those versions are reachable too.
+typedef struct {
+    // by node id, only set for functions, statics and structs
+    size_t length;
+    bool* reachable;
+
+    // functions, statics and structs outside of C headers, and how many of them are unreachable
+    size_t decls;
+    size_t pruned;
+} Reachability;
+
+// once types are resolved and generics monomorphized
+Reachability reachability_find(Arena* arena, Packages* packages);
+
+// false only for functions, statics and structs that nothing reaches
+bool reachability_keeps(Reachability const* reachability, ASTNode const* node);
+
+#endif
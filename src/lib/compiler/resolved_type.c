@@ -1,73 +1,291 @@
 #include <stdio.h>
 
 #include "./resolved_type.h"
+#include "./package.h"
 
-bool resolved_struct_decl_eq(ResolvedStructDecl* a, ResolvedStructDecl* b) {
-    if (!a || !b) {
-        return !a && !b;
-    }
+#define INITIAL_TABLE_CAPACITY 256
 
-    if (!str_eq(a->name, b->name)) {
-        return false;
+ResolvedTypeTable resolved_type_table_create(Arena* arena) {
+    return (ResolvedTypeTable){
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+        .arena = arena,
+
+        .capacity = INITIAL_TABLE_CAPACITY,
+        .length = 0,
+        .slots = arena_calloc(arena, INITIAL_TABLE_CAPACITY, sizeof(ResolvedType*)),
+    };
+}
+
+bool resolved_type_kind_is_interned(ResolvedTypeKind kind) {
+    switch (kind) {
+        case RTK_VOID:
+        case RTK_BOOL:
+        case RTK_CHAR:
+        case RTK_INT:
+        case RTK_INT8:
+        case RTK_INT16:
+        case RTK_INT32:
+        case RTK_INT64:
+        case RTK_UINT:
+        case RTK_UINT8:
+        case RTK_UINT16:
+        case RTK_UINT32:
+        case RTK_UINT64:
+        case RTK_FLOAT:
+        case RTK_FLOAT32:
+        case RTK_FLOAT64:
+        case RTK_POINTER:
+        case RTK_MUT_POINTER:
+        case RTK_ARRAY:
+        case RTK_STRUCT_DECL:
+        case RTK_STRUCT_REF:
+        case RTK_GENERIC:
+            return true;
+
+        default: return false;
     }
+}
 
-    if (a->fields_length != b->fields_length) {
-        return false;
+// hashes a type by its kind and the identity of its (already canonical) components
+static uint64_t hash_resolved_type(ResolvedType* rt) {
+    uint64_t hash = fingerprint_mix(FNV_OFFSET_BASIS, rt->kind);
+
+    switch (rt->kind) {
+        case RTK_POINTER:
+            return fingerprint_mix(hash, (uintptr_t)rt->type.ptr.of);
+
+        case RTK_MUT_POINTER:
+            return fingerprint_mix(hash, (uintptr_t)rt->type.mut_ptr.of);
+
+        case RTK_ARRAY:
+            hash = fingerprint_mix(hash, (uintptr_t)rt->type.array.of);
+            hash = fingerprint_mix(hash, rt->type.array.has_explicit_length);
+            return fingerprint_mix(hash, rt->type.array.explicit_length);
+
+        case RTK_STRUCT_DECL:
+            return fingerprint_mix(hash, (uintptr_t)rt->src);
+
+        case RTK_STRUCT_REF:
+            hash = fingerprint_mix(hash, (uintptr_t)rt->type.struct_ref.decl);
+            for (size_t i = 0; i < rt->type.struct_ref.generic_args.length; ++i) {
+                hash = fingerprint_mix(hash, (uintptr_t)rt->type.struct_ref.generic_args.resolved_types[i]);
+            }
+            return hash;
+
+        case RTK_GENERIC:
+            hash = fingerprint_mix(hash, (uintptr_t)rt->src);
+            return fingerprint_mix(hash, rt->type.generic.idx);
+
+        default: return hash;
     }
+}
 
-    if (a->generic_params.length != b->generic_params.length) {
+static bool resolved_type_same_key(ResolvedType* a, ResolvedType* b) {
+    if (a->kind != b->kind) {
         return false;
     }
 
-    for (size_t i = 0; i < a->fields_length; ++i) {
-        if (!str_eq(a->fields[i].name, b->fields[i].name)) {
-            return false;
-        }
+    switch (a->kind) {
+        case RTK_POINTER: return a->type.ptr.of == b->type.ptr.of;
+        case RTK_MUT_POINTER: return a->type.mut_ptr.of == b->type.mut_ptr.of;
+
+        case RTK_ARRAY:
+            return a->type.array.of == b->type.array.of
+                && a->type.array.has_explicit_length == b->type.array.has_explicit_length
+                && a->type.array.explicit_length == b->type.array.explicit_length;
 
-        if (!resolved_type_eq(a->fields[i].type, b->fields[i].type)) {
-            return false;
+        case RTK_STRUCT_DECL: return a->src == b->src;
+
+        case RTK_STRUCT_REF: {
+            if (a->type.struct_ref.decl != b->type.struct_ref.decl) {
+                return false;
+            }
+            if (a->type.struct_ref.generic_args.length != b->type.struct_ref.generic_args.length) {
+                return false;
+            }
+            for (size_t i = 0; i < a->type.struct_ref.generic_args.length; ++i) {
+                if (a->type.struct_ref.generic_args.resolved_types[i] != b->type.struct_ref.generic_args.resolved_types[i]) {
+                    return false;
+                }
+            }
+            return true;
         }
+
+        case RTK_GENERIC: return a->src == b->src && a->type.generic.idx == b->type.generic.idx;
+
+        default: return true;
+    }
+}
+
+static ResolvedType** table_slot(ResolvedType** slots, size_t capacity, ResolvedType* key, uint64_t hash) {
+    size_t idx = hash & (capacity - 1);
+    while (slots[idx] && !resolved_type_same_key(slots[idx], key)) {
+        idx = (idx + 1) & (capacity - 1);
     }
+    return slots + idx;
+}
 
-    for (size_t i = 0; i < a->generic_params.length; ++i) {
-        if (!str_eq(a->generic_params.strings[i], b->generic_params.strings[i])) {
-            return false;
+static void table_grow(ResolvedTypeTable* table) {
+    size_t capacity = table->capacity * 2;
+    ResolvedType** slots = arena_calloc(table->arena, capacity, sizeof(ResolvedType*));
+
+    for (size_t i = 0; i < table->capacity; ++i) {
+        ResolvedType* rt = table->slots[i];
+        if (rt) {
+            *table_slot(slots, capacity, rt, hash_resolved_type(rt)) = rt;
         }
     }
 
-    return true;
+    table->capacity = capacity;
+    table->slots = slots;
 }
 
+ResolvedType* resolved_type_intern(ResolvedTypeTable* table, ResolvedType candidate) {
+    assert(table);
+    assert(resolved_type_kind_is_interned(candidate.kind));
+
+    // derived fields are not part of the key, so fill them in before lookup
+    switch (candidate.kind) {
+        case RTK_POINTER:
+            candidate.from_pkg = candidate.type.ptr.of ? candidate.type.ptr.of->from_pkg : NULL;
+            candidate.src = NULL;
+            break;
+
+        case RTK_MUT_POINTER:
+            candidate.from_pkg = candidate.type.mut_ptr.of ? candidate.type.mut_ptr.of->from_pkg : NULL;
+            candidate.src = NULL;
+            break;
+
+        case RTK_ARRAY:
+            candidate.from_pkg = candidate.type.array.of ? candidate.type.array.of->from_pkg : NULL;
+            candidate.src = NULL;
+            break;
+
+        case RTK_STRUCT_REF:
+            assert(candidate.type.struct_ref.decl);
+            assert(candidate.type.struct_ref.decl->kind == RTK_STRUCT_DECL);
+            candidate.from_pkg = candidate.type.struct_ref.decl->from_pkg;
+            candidate.src = candidate.type.struct_ref.decl->src;
+            candidate.type.struct_ref.decl_node_id = candidate.src->id;
+            break;
+
+        case RTK_STRUCT_DECL:
+        case RTK_GENERIC:
+            assert(candidate.src);
+            break;
+
+        default:
+            candidate.from_pkg = NULL;
+            candidate.src = NULL;
+            break;
+    }
+
+    uint64_t hash = hash_resolved_type(&candidate);
+
+    pthread_mutex_lock(&table->lock);
+
+    ResolvedType** slot = table_slot(table->slots, table->capacity, &candidate, hash);
+    if (*slot) {
+        ResolvedType* found = *slot;
+        pthread_mutex_unlock(&table->lock);
+        return found;
+    }
+
+    ResolvedType* rt = arena_alloc(table->arena, sizeof *rt);
+    *rt = candidate;
+
+    if (rt->kind == RTK_STRUCT_REF && rt->type.struct_ref.generic_args.length > 0) {
+        rt->type.struct_ref.generic_args.resolved_types = arena_memcpy(
+            table->arena,
+            candidate.type.struct_ref.generic_args.resolved_types,
+            sizeof(ResolvedType*) * candidate.type.struct_ref.generic_args.length
+        );
+    }
+
+    // keep the table at most half full
+    if ((table->length + 1) * 2 > table->capacity) {
+        table_grow(table);
+        slot = table_slot(table->slots, table->capacity, rt, hash);
+    }
+
+    *slot = rt;
+    table->length += 1;
+
+    pthread_mutex_unlock(&table->lock);
+
+    return rt;
+}
+
+ResolvedType* resolved_type_primitive(ResolvedTypeTable* table, ResolvedTypeKind kind) {
+    return resolved_type_intern(table, (ResolvedType){ .kind = kind });
+}
+
+ResolvedType* resolved_type_pointer(ResolvedTypeTable* table, ResolvedTypeKind kind, ResolvedType* of) {
+    assert(kind == RTK_POINTER || kind == RTK_MUT_POINTER);
+
+    ResolvedType candidate = { .kind = kind };
+    if (kind == RTK_POINTER) {
+        candidate.type.ptr.of = of;
+    } else {
+        candidate.type.mut_ptr.of = of;
+    }
+    return resolved_type_intern(table, candidate);
+}
+
+uint64_t resolved_type_eq_hash(ResolvedType* rt) {
+    if (!rt) {
+        return FNV_OFFSET_BASIS;
+    }
+
+    switch (rt->kind) {
+        // a pointer equals a mut pointer to an equal type
+        case RTK_POINTER:
+            return fingerprint_mix(fingerprint_mix(FNV_OFFSET_BASIS, RTK_POINTER), resolved_type_eq_hash(rt->type.ptr.of));
+        case RTK_MUT_POINTER:
+            return fingerprint_mix(fingerprint_mix(FNV_OFFSET_BASIS, RTK_POINTER), resolved_type_eq_hash(rt->type.mut_ptr.of));
+
+        case RTK_ARRAY: {
+            uint64_t hash = fingerprint_mix(FNV_OFFSET_BASIS, RTK_ARRAY);
+            hash = fingerprint_mix(hash, rt->type.array.has_explicit_length ? rt->type.array.explicit_length + 1 : 0);
+            return fingerprint_mix(hash, resolved_type_eq_hash(rt->type.array.of));
+        }
+
+        // and a struct ref without args equals its decl
+        case RTK_STRUCT_DECL:
+            return fingerprint_mix(FNV_OFFSET_BASIS, (uintptr_t)rt);
+        case RTK_STRUCT_REF: {
+            uint64_t hash = fingerprint_mix(FNV_OFFSET_BASIS, (uintptr_t)rt->type.struct_ref.decl);
+            for (size_t i = 0; i < rt->type.struct_ref.generic_args.length; ++i) {
+                hash = fingerprint_mix(hash, resolved_type_eq_hash(rt->type.struct_ref.generic_args.resolved_types[i]));
+            }
+            return hash;
+        }
+
+        default:
+            if (resolved_type_kind_is_interned(rt->kind)) {
+                return fingerprint_mix(FNV_OFFSET_BASIS, (uintptr_t)rt);
+            }
+            return fingerprint_mix(FNV_OFFSET_BASIS, rt->kind);
+    }
+}
+
+// Structural, so that types built from equal parts are equal even when they aren't
+// the same interned type, like `*Foo` pointing at a struct ref and at the decl.
 bool resolved_type_eq(ResolvedType* a, ResolvedType* b) {
+    if (a == b) {
+        return true;
+    }
+
     if (!a || !b) {
-        return !a && !b;
+        return false;
     }
 
     switch (a->kind) {
         case RTK_NAMESPACE: assert(false); // TODO
         case RTK_FUNCTION_DECL: assert(false); // TODO
         case RTK_FUNCTION_REF: assert(false); // TODO
-        case RTK_ARRAY: assert(false); // TODO
         case RTK_TERMINAL: assert(false); // TODO
 
-        case RTK_VOID:
-        case RTK_BOOL:
-        case RTK_CHAR:
-        case RTK_INT:
-        case RTK_INT8:
-        case RTK_INT16:
-        case RTK_INT32:
-        case RTK_INT64:
-        case RTK_UINT:
-        case RTK_UINT8:
-        case RTK_UINT16:
-        case RTK_UINT32:
-        case RTK_UINT64:
-        case RTK_FLOAT:
-        case RTK_FLOAT32:
-        case RTK_FLOAT64:
-            return b->kind == a->kind;
-
         case RTK_POINTER: switch (b->kind) {
             case RTK_POINTER: return resolved_type_eq(a->type.ptr.of, b->type.ptr.of);
             case RTK_MUT_POINTER: return resolved_type_eq(a->type.ptr.of, b->type.mut_ptr.of);
@@ -80,45 +298,48 @@ bool resolved_type_eq(ResolvedType* a, ResolvedType* b) {
             default: return false;
         }
 
+        case RTK_ARRAY: {
+            if (b->kind != RTK_ARRAY) {
+                return false;
+            }
+            if (a->type.array.has_explicit_length != b->type.array.has_explicit_length) {
+                return false;
+            }
+            if (a->type.array.has_explicit_length && a->type.array.explicit_length != b->type.array.explicit_length) {
+                return false;
+            }
+            return resolved_type_eq(a->type.array.of, b->type.array.of);
+        }
+
         case RTK_STRUCT_REF: switch (b->kind) {
             case RTK_STRUCT_REF: {
+                if (a->type.struct_ref.decl != b->type.struct_ref.decl) {
+                    return false;
+                }
                 if (a->type.struct_ref.generic_args.length != b->type.struct_ref.generic_args.length) {
                     return false;
                 }
                 for (size_t i = 0; i < a->type.struct_ref.generic_args.length; ++i) {
-                    if (!resolved_type_eq(a->type.struct_ref.generic_args.resolved_types + i, b->type.struct_ref.generic_args.resolved_types + i)) {
+                    if (!resolved_type_eq(a->type.struct_ref.generic_args.resolved_types[i], b->type.struct_ref.generic_args.resolved_types[i])) {
                         return false;
                     }
                 }
-                return resolved_struct_decl_eq(&a->type.struct_ref.decl, &b->type.struct_ref.decl);
+                return true;
             }
-            case RTK_STRUCT_DECL: return resolved_struct_decl_eq(&a->type.struct_ref.decl, &b->type.struct_decl);
+            case RTK_STRUCT_DECL: return a->type.struct_ref.decl == b && a->type.struct_ref.generic_args.length == 0;
             default: return false;
         }
 
         case RTK_STRUCT_DECL: switch (b->kind) {
-            case RTK_STRUCT_REF: return resolved_struct_decl_eq(&a->type.struct_decl, &b->type.struct_ref.decl);
-            case RTK_STRUCT_DECL: return resolved_struct_decl_eq(&a->type.struct_decl, &b->type.struct_decl);
+            case RTK_STRUCT_REF: return b->type.struct_ref.decl == a && b->type.struct_ref.generic_args.length == 0;
             default: return false;
         }
 
-        case RTK_GENERIC: {
-            if (b->kind != a->kind) {
-                return false;
-            }
-            if (a->src->id.val != b->src->id.val) {
-                return false;
-            }
-            if (a->type.generic.idx != b->type.generic.idx) {
-                return false;
-            }
-            return str_eq(a->type.generic.name, b->type.generic.name);
-        }
-
         case RTK_COUNT: printf("TODO: resolved_type_eq(%d)\n", a->kind); assert(false); // TODO
-    }
 
-    return true;
+        // other interned types are only equal to themselves
+        default: return false;
+    }
 }
 
 bool resolved_type_implict_to(ResolvedType* from, ResolvedType* to) {
@@ -306,19 +527,19 @@ bool resolved_type_implict_to(ResolvedType* from, ResolvedType* to) {
                     return false;
                 }
                 for (size_t i = 0; i < from->type.struct_ref.generic_args.length; ++i) {
-                    if (!resolved_type_implict_to(from->type.struct_ref.generic_args.resolved_types + i, to->type.struct_ref.generic_args.resolved_types + i)) {
+                    if (!resolved_type_implict_to(from->type.struct_ref.generic_args.resolved_types[i], to->type.struct_ref.generic_args.resolved_types[i])) {
                         return false;
                     }
                 }
-                return resolved_struct_decl_eq(&to->type.struct_ref.decl, &to->type.struct_ref.decl);
+                return from->type.struct_ref.decl == to->type.struct_ref.decl;
             }
-            case RTK_STRUCT_DECL: return resolved_struct_decl_eq(&from->type.struct_ref.decl, &to->type.struct_decl);
+            case RTK_STRUCT_DECL: return from->type.struct_ref.decl == to;
             default: return false;
         }
 
         case RTK_STRUCT_DECL: switch (to->kind) {
-            case RTK_STRUCT_REF: return resolved_struct_decl_eq(&from->type.struct_decl, &to->type.struct_ref.decl);
-            case RTK_STRUCT_DECL: return resolved_struct_decl_eq(&from->type.struct_decl, &to->type.struct_decl);
+            case RTK_STRUCT_REF: return from == to->type.struct_ref.decl;
+            case RTK_STRUCT_DECL: return from == to;
             default: return false;
         }
 
@@ -479,7 +700,7 @@ void print_resolved_type(ResolvedType* rt) {
                     if (i > 0) {
                         printf(", ");
                     }
-                    print_resolved_type(rt->type.function_ref.generic_args.resolved_types + i);
+                    print_resolved_type(rt->type.function_ref.generic_args.resolved_types[i]);
                 }
                 printf(">");
             }
@@ -511,14 +732,14 @@ void print_resolved_type(ResolvedType* rt) {
         }
 
         case RTK_STRUCT_REF: {
-            print_string(rt->type.struct_ref.decl.name);
+            print_string(rt->type.struct_ref.decl->type.struct_decl.name);
             if (rt->type.struct_ref.generic_args.length > 0) {
                 printf("<");
                 for (size_t i = 0; i < rt->type.struct_ref.generic_args.length; ++i) {
                     if (i > 0) {
                         printf(", ");
                     }
-                    print_resolved_type(rt->type.struct_ref.generic_args.resolved_types + i);
+                    print_resolved_type(rt->type.struct_ref.generic_args.resolved_types[i]);
                 }
                 printf(">");
             }
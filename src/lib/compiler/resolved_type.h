@@ -1,18 +1,27 @@
 #ifndef quill_resolved_type_h
 #define quill_resolved_type_h
 
+#include <pthread.h>
+
 #include "./ast.h"
 #include "../utils/utils.h"
 
 typedef struct {
+    // index in Packages.list
+    size_t id;
     PackagePath* full_name;
     ASTNode const* ast;
+    DeclIndex decls;
     bool is_entry;
+
+    // hash of the source bytes and compiler version, then folded with the
+    // fingerprints of its imports once they are sorted
+    uint64_t fingerprint;
 } Package;
 
 typedef struct {
     size_t length;
-    struct ResolvedType* resolved_types;
+    struct ResolvedType** resolved_types;
 } ResolvedTypes;
 
 typedef enum {
@@ -101,10 +110,10 @@ typedef struct {
 } ResolvedStructDecl;
 
 typedef struct {
-    ResolvedStructDecl decl;
+    // canonical RTK_STRUCT_DECL this refers to
+    struct ResolvedType* decl;
     NodeId decl_node_id;
     ResolvedTypes generic_args;
-    size_t impl_version;
 } ResolvedStructRef;
 
 typedef struct {
@@ -137,10 +146,31 @@ typedef struct ResolvedType {
     } type;
 } ResolvedType;
 
+// Hash-consing table for resolved types.
+// Primitives, pointers, arrays, generics, struct decls and struct refs are
+// interned here, so two of them are equal exactly when they are the same pointer.
+// Packages resolved in parallel share it, so lookups and inserts take the lock.
+typedef struct {
+    pthread_mutex_t lock;
+    Arena* arena;
+
+    size_t capacity;
+    size_t length;
+    ResolvedType** slots;
+} ResolvedTypeTable;
+
+ResolvedTypeTable resolved_type_table_create(Arena* arena);
+
+bool resolved_type_kind_is_interned(ResolvedTypeKind kind);
+ResolvedType* resolved_type_intern(ResolvedTypeTable* table, ResolvedType candidate);
+ResolvedType* resolved_type_primitive(ResolvedTypeTable* table, ResolvedTypeKind kind);
+ResolvedType* resolved_type_pointer(ResolvedTypeTable* table, ResolvedTypeKind kind, ResolvedType* of);
+
 bool resolved_type_cast_to(ResolvedType* from, ResolvedType* to);
 bool resolved_type_implict_to(ResolvedType* from, ResolvedType* to);
 bool resolved_type_eq(ResolvedType* a, ResolvedType* b);
-bool resolved_struct_decl_eq(ResolvedStructDecl* a, ResolvedStructDecl* b);
+// equal types under resolved_type_eq hash the same
+uint64_t resolved_type_eq_hash(ResolvedType* rt);
 
 void print_resolved_type(ResolvedType* rt);
 
@@ -86,6 +86,7 @@ typedef enum {
 
 typedef struct {
     TokenType type;
+    Symbol symbol; // interned name of a TT_IDENTIFIER, otherwise SYMBOL_NONE
 
     char* start;
     size_t length;
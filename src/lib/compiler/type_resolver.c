@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -5,132 +6,264 @@
 #include "./type_resolver.h"
 #include "./resolved_type.h"
 #include "./package.h"
+#include "./package_graph.h"
+#include "./monomorphizer.h"
 
 #define HASHTABLE_BUCKETS 256
-#define FNV_OFFSET_BASIS 14695981039346656037ULL
-#define FNV_PRIME 1099511628211ULL
 
-#define INITIAL_SCOPE_CAPACITY 8
-#define INITIAL_BUCKET_CAPACITY 1
+// scopes scan an inline array until they outgrow it, then switch to an open-addressed table
+#define SCOPE_INLINE_CAPACITY 4
+#define INITIAL_SCOPE_TABLE_CAPACITY 16
+
+typedef bool Changed;
 
 typedef struct {
-    Arena* arena;
-    size_t capacity;
-    size_t length;
-    size_t* dependent_idxs;
-    size_t* dependency_idxs;
-} AdjacencyList;
+    Symbol key;
+    ResolvedType* value;
+} ScopeItem;
 
-static AdjacencyList adjacency_list_create(Arena* arena, size_t capacity) {
-    size_t* dependents = arena_calloc(arena, capacity, sizeof *dependents);
-    size_t* dependencies = arena_calloc(arena, capacity, sizeof *dependencies);
+typedef struct Scope {
+    size_t scope_id;
 
-    return (AdjacencyList){
-        .arena = arena,
-        .capacity = capacity,
-        .length = 0,
-        .dependent_idxs = dependents,
-        .dependency_idxs = dependencies,
-    };
-}
+    Arena* arena;
+    struct Scope* parent;
 
-static void add_package_dependency(AdjacencyList* list, size_t dependent_idx, size_t dependency_idx) {
-    if (list->length >= list->capacity) {
-        size_t prev_cap = list->capacity;
-        list->capacity = list->length * 2;
-        list->dependent_idxs = arena_realloc(list->arena, list->dependent_idxs, sizeof(*list->dependent_idxs) * prev_cap, sizeof(*list->dependent_idxs) * list->capacity);
-        list->dependency_idxs = arena_realloc(list->arena, list->dependency_idxs, sizeof(*list->dependency_idxs) * prev_cap, sizeof(*list->dependency_idxs) * list->capacity);
-    }
+    size_t length;
+    ScopeItem items[SCOPE_INLINE_CAPACITY];
 
-    list->dependent_idxs[list->length] = dependent_idx;
-    list->dependency_idxs[list->length] = dependency_idx;
-    list->length += 1;
-}
+    // power of two, 0 until the scope outgrows its inline items
+    size_t table_capacity;
+    ScopeItem* table;
 
-typedef bool Changed;
+    // only set on file scopes, so new top-level bindings wake waiting decls
+    struct Worklist* worklist;
+} Scope;
 
 typedef struct {
-    String key;
-    ResolvedType* value;
-} BucketItem;
+    Symbol symbol;
+    size_t decl_idx;
+    size_t generation;
+} Waiter;
 
 typedef struct {
-    Arena* arena;
-
     size_t capacity;
     size_t length;
-    BucketItem* array;
-} Bucket;
-
-typedef struct Scope {
-    size_t scope_id;
+    Waiter* array;
+} Waiters;
 
+// Top-level decls still to be resolved in a file.
+// A decl that misses a symbol is parked until that symbol gets bound,
+// instead of re-walking the whole file until nothing changes.
+typedef struct Worklist {
     Arena* arena;
-    struct Scope* parent;
+    size_t decls_length;
 
-    size_t lookup_length;
-    Bucket* lookup_buckets;
-} Scope;
+    // ring of decl indices, each decl is queued at most once at a time
+    size_t* queue;
+    size_t queue_start;
+    size_t queue_length;
+    bool* queued;
 
-static size_t hash_str(String str) {
-    if (!str.length) { return 0; }
+    // bumped on each visit, so waiters from older visits are ignored
+    size_t* generations;
 
-    // FNV-1a
-    size_t hash = FNV_OFFSET_BASIS;
-    for (size_t i = 0; i < str.length; ++i) {
-        char c = str.chars[i];
-        hash ^= c;
-        hash *= FNV_PRIME;
-    }
+    // pass the fixed-point loop would have resolved each decl in
+    size_t* rounds;
+    size_t current;
+
+    Waiters* waiters;
+
+    // unresolved without missing a symbol, retried whenever a symbol is bound
+    size_t stalled_length;
+    size_t* stalled;
+
+    // symbols missed during the current visit
+    size_t misses_capacity;
+    size_t misses_length;
+    Symbol* misses;
+} Worklist;
 
-    // map to bucket index
-    // note: reserve index 0 for empty string
+// A reference to a generic decl with the args it was given.
+// The impl version is only known once the use is registered on the decl.
+typedef struct {
+    ASTNode* decl;
+    LL_Type generic_args;
+
+    size_t resolved_types_length;
+    ResolvedType** resolved_types;
+
+    size_t* impl_version;
+    size_t* ref_impl_version;
+} GenericUse;
+
+typedef struct GenericUses {
+    Arena* arena;
+    size_t capacity;
+    size_t length;
+    GenericUse* array;
+} GenericUses;
+
+static size_t hash_symbol(Symbol symbol) {
+    if (symbol == SYMBOL_NONE) { return 0; }
+
+    // map the cached hash to a bucket index
+    // note: reserve index 0 for no symbol
+    size_t hash = symbol_hash(symbol);
     hash %= HASHTABLE_BUCKETS - 1;
     return 1 + hash;
 }
 
-static Bucket bucket_create_with_capacity(Arena* arena, size_t capacity) {
-    return (Bucket){
+
+static Worklist worklist_create(Arena* arena, size_t decls_length) {
+    return (Worklist){
         .arena = arena,
+        .decls_length = decls_length,
 
-        .capacity = capacity,
-        .length = 0,
-        .array = arena_calloc(arena, capacity, sizeof(Bucket)),
+        .queue = arena_calloc(arena, decls_length + 1, sizeof(size_t)),
+        .queue_start = 0,
+        .queue_length = 0,
+        .queued = arena_calloc(arena, decls_length + 1, sizeof(bool)),
+
+        .generations = arena_calloc(arena, decls_length + 1, sizeof(size_t)),
+        .rounds = arena_calloc(arena, decls_length + 1, sizeof(size_t)),
+        .current = 0,
+
+        .waiters = arena_calloc(arena, HASHTABLE_BUCKETS, sizeof(Waiters)),
+
+        .stalled_length = 0,
+        .stalled = arena_calloc(arena, decls_length + 1, sizeof(size_t)),
+
+        .misses_capacity = 0,
+        .misses_length = 0,
+        .misses = NULL,
     };
 }
 
-static Bucket bucket_create(Arena* arena) {
-    return bucket_create_with_capacity(arena, INITIAL_BUCKET_CAPACITY);
+static void worklist_push(Worklist* worklist, size_t decl_idx, size_t round) {
+    assert(decl_idx < worklist->decls_length);
+
+    if (worklist->rounds[decl_idx] < round) {
+        worklist->rounds[decl_idx] = round;
+    }
+
+    if (worklist->queued[decl_idx]) {
+        return;
+    }
+
+    size_t end = (worklist->queue_start + worklist->queue_length) % worklist->decls_length;
+    worklist->queue[end] = decl_idx;
+    worklist->queue_length += 1;
+    worklist->queued[decl_idx] = true;
 }
 
-static void bucket_push(Bucket* list, BucketItem item) {
-    if (list->length >= list->capacity) {
-        size_t prev_cap = list->capacity;
-        list->capacity = list->length * 2;
-        list->array = arena_realloc(
-            list->arena,
-            list->array,
-            sizeof(Token) * prev_cap,
-            sizeof(Token) * list->capacity
+static bool worklist_pop(Worklist* worklist, size_t* out_decl_idx) {
+    if (worklist->queue_length == 0) {
+        return false;
+    }
+
+    size_t decl_idx = worklist->queue[worklist->queue_start];
+    worklist->queue_start = (worklist->queue_start + 1) % worklist->decls_length;
+    worklist->queue_length -= 1;
+    worklist->queued[decl_idx] = false;
+
+    *out_decl_idx = decl_idx;
+    return true;
+}
+
+static void worklist_wait(Worklist* worklist, Symbol symbol) {
+    for (size_t i = 0; i < worklist->misses_length; ++i) {
+        if (worklist->misses[i] == symbol) {
+            return;
+        }
+    }
+
+    if (worklist->misses_length >= worklist->misses_capacity) {
+        size_t prev_cap = worklist->misses_capacity;
+        worklist->misses_capacity = prev_cap > 0 ? prev_cap * 2 : 4;
+        worklist->misses = arena_realloc(
+            worklist->arena,
+            worklist->misses,
+            sizeof(Symbol) * prev_cap,
+            sizeof(Symbol) * worklist->misses_capacity
         );
     }
 
-    list->array[list->length] = item;
-    list->length += 1;
+    worklist->misses[worklist->misses_length] = symbol;
+    worklist->misses_length += 1;
 }
 
+static void worklist_park(Worklist* worklist, size_t decl_idx) {
+    for (size_t i = 0; i < worklist->misses_length; ++i) {
+        Symbol symbol = worklist->misses[i];
+        Waiters* waiters = worklist->waiters + hash_symbol(symbol);
+
+        if (waiters->length >= waiters->capacity) {
+            size_t prev_cap = waiters->capacity;
+            waiters->capacity = prev_cap > 0 ? prev_cap * 2 : 2;
+            waiters->array = arena_realloc(
+                worklist->arena,
+                waiters->array,
+                sizeof(Waiter) * prev_cap,
+                sizeof(Waiter) * waiters->capacity
+            );
+        }
+
+        waiters->array[waiters->length] = (Waiter){
+            .symbol = symbol,
+            .decl_idx = decl_idx,
+            .generation = worklist->generations[decl_idx],
+        };
+        waiters->length += 1;
+    }
+}
+
+static void worklist_stall(Worklist* worklist, size_t decl_idx) {
+    assert(worklist->stalled_length < worklist->decls_length);
+    worklist->stalled[worklist->stalled_length] = decl_idx;
+    worklist->stalled_length += 1;
+}
+
+static void worklist_wake(Worklist* worklist, Symbol symbol) {
+    // a decl before the current one would only see this binding on the next pass
+    size_t round = worklist->rounds[worklist->current];
+
+    Waiters* waiters = worklist->waiters + hash_symbol(symbol);
+    for (size_t i = 0; i < waiters->length; ++i) {
+        Waiter waiter = waiters->array[i];
+        if (waiter.symbol != symbol) {
+            continue;
+        }
+
+        if (waiter.generation == worklist->generations[waiter.decl_idx]) {
+            worklist_push(worklist, waiter.decl_idx, round + (waiter.decl_idx < worklist->current));
+        }
+
+        waiters->length -= 1;
+        waiters->array[i] = waiters->array[waiters->length];
+        i -= 1;
+    }
 
-static Scope scope_create(Arena* arena, Scope* parent) {
-    static size_t next = 0;
+    for (size_t i = 0; i < worklist->stalled_length; ++i) {
+        size_t decl_idx = worklist->stalled[i];
+        worklist_push(worklist, decl_idx, round + (decl_idx < worklist->current));
+    }
+    worklist->stalled_length = 0;
+}
 
+static Scope scope_create(TypeResolver* type_resolver, Scope* parent) {
     return (Scope){
-        .scope_id = next++,
+        .scope_id = type_resolver->next_scope_id++,
 
-        .arena = arena,
+        .arena = type_resolver->arena,
         .parent = parent,
 
-        .lookup_length = HASHTABLE_BUCKETS,
-        .lookup_buckets = arena_calloc(arena, HASHTABLE_BUCKETS, sizeof(Bucket)),
+        .length = 0,
+        .items = {{0}},
+
+        .table_capacity = 0,
+        .table = NULL,
+
+        .worklist = NULL,
     };
 }
 
@@ -151,576 +284,451 @@ static void scope_print_ids(Scope* scope) {
     printf("]\n");
 }
 
-static void scope_set(Scope* scope, String key, ResolvedType* value) {
-    assert(scope);
-    // printf("Set \""); print_string(key); printf("\" = RTK_%d; ", value->kind);
-    // scope_print_ids(scope);
+static ScopeItem* scope_table_slot(ScopeItem* table, size_t capacity, Symbol key) {
+    size_t idx = symbol_hash(key) & (capacity - 1);
+    while (table[idx].key != SYMBOL_NONE && table[idx].key != key) {
+        idx = (idx + 1) & (capacity - 1);
+    }
+    return table + idx;
+}
 
-    size_t idx = hash_str(key);
-    Bucket* bucket = scope->lookup_buckets + idx;
-    assert(bucket);
+static void scope_table_grow(Scope* scope) {
+    size_t capacity = scope->table_capacity > 0 ? scope->table_capacity * 2 : INITIAL_SCOPE_TABLE_CAPACITY;
+    ScopeItem* table = arena_calloc(scope->arena, capacity, sizeof *table);
 
-    if (!bucket->array) {
-        *bucket = bucket_create(scope->arena);
+    if (scope->table) {
+        for (size_t i = 0; i < scope->table_capacity; ++i) {
+            if (scope->table[i].key != SYMBOL_NONE) {
+                *scope_table_slot(table, capacity, scope->table[i].key) = scope->table[i];
+            }
+        }
+    } else {
+        for (size_t i = 0; i < scope->length; ++i) {
+            *scope_table_slot(table, capacity, scope->items[i].key) = scope->items[i];
+        }
     }
 
-    for (size_t i = 0; i < bucket->length; ++i) {
-        BucketItem* item = bucket->array + i;
+    scope->table_capacity = capacity;
+    scope->table = table;
+}
+
+static ScopeItem* scope_find(Scope* scope, Symbol key) {
+    if (scope->table) {
+        ScopeItem* slot = scope_table_slot(scope->table, scope->table_capacity, key);
+        return slot->key == key ? slot : NULL;
+    }
 
-        if (str_eq(item->key, key)) {
-            item->value = value;
+    for (size_t i = 0; i < scope->length; ++i) {
+        if (scope->items[i].key == key) {
+            return scope->items + i;
         }
     }
 
-    bucket_push(bucket, (BucketItem){ key, value });
+    return NULL;
 }
 
-static ResolvedType* _scope_get(Scope* scope, String key, size_t idx) {
+static void scope_set(Scope* scope, Symbol key, ResolvedType* value) {
     assert(scope);
-    // printf("Get \""); print_string(key); printf("\"; ");
+    assert(key != SYMBOL_NONE);
+    // printf("Set \""); print_string(key); printf("\" = RTK_%d; ", value->kind);
     // scope_print_ids(scope);
 
-    Bucket* bucket = scope->lookup_buckets + idx;
-
-    if (bucket) {
-        for (size_t i = 0; i < bucket->length; ++i) {
-            BucketItem* item = bucket->array + i;
+    ScopeItem* item = scope_find(scope, key);
+    if (item) {
+        item->value = value;
+        return;
+    }
 
-            if (str_eq(item->key, key)) {
-                // printf("Got RTK_%d\n", item->value->kind);
-                return item->value;
-            }
+    if (!scope->table && scope->length < SCOPE_INLINE_CAPACITY) {
+        scope->items[scope->length] = (ScopeItem){ key, value };
+    } else {
+        // keep the table at most half full
+        if ((scope->length + 1) * 2 > scope->table_capacity) {
+            scope_table_grow(scope);
         }
+        *scope_table_slot(scope->table, scope->table_capacity, key) = (ScopeItem){ key, value };
     }
+    scope->length += 1;
 
-    if (scope->parent) {
-        return _scope_get(scope->parent, key, idx);
-    } else {
-        // printf("Not found\n");
-        return NULL;
+    if (scope->worklist) {
+        worklist_wake(scope->worklist, key);
     }
 }
 
-static ResolvedType* scope_get(Scope* scope, String key) {
-    return _scope_get(scope, key, hash_str(key));
+static ResolvedType* scope_get(Scope* scope, Symbol key) {
+    assert(scope);
+    // printf("Get \""); print_string(key); printf("\"; ");
+    // scope_print_ids(scope);
+
+    Scope* curr = scope;
+    while (curr) {
+        ScopeItem* item = scope_find(curr, key);
+        if (item) {
+            // printf("Got RTK_%d\n", item->value->kind);
+            return item->value;
+        }
+        curr = curr->parent;
+    }
+
+    // printf("Not found\n");
+    return NULL;
 }
 
-TypeResolver type_resolver_create(Arena* arena, Packages* packages) {
+TypeResolver type_resolver_create(Arena* arena, Packages* packages, size_t jobs) {
+    assert(jobs > 0);
+
     return (TypeResolver){
         .arena = arena,
         .packages = packages,
 
+        .jobs = jobs,
+        .worker_arenas = arena_calloc(arena, jobs, sizeof(Arena)),
+
+        .deferred_generic_uses = NULL,
+
         .current_package = NULL,
         .current_function = NULL,
         .seen_separator = false,
-    };
-}
 
-static ImportPath* expand_import_path(TypeResolver* type_resolver, ASTNodeImport* import) {
-    if (!import) {
-        return NULL;
-    }
+        .worklist = NULL,
+        .untyped_nodes = 0,
 
-    switch (import->type) {
-        case IT_DEFAULT: return import->import_path;
+        .next_scope_id = 0,
 
-        case IT_LOCAL: {
-            ImportPath* local = package_path_to_import_path(type_resolver->arena, type_resolver->current_package->full_name);
-            ImportPath* curr = local;
-            while (curr->type == IPT_DIR && curr->import.dir.child->type == IPT_DIR) {
-                curr = curr->import.dir.child;
-                assert(curr);
-            }
-            curr->import.dir.child = import->import_path;
-            return local;
-        }
+        .nodes_visited = 0,
+        .decl_visits = 0,
+        .passes_saved = 0,
+    };
+}
 
-        case IT_ROOT: {
-            ImportPath* root = arena_alloc(type_resolver->arena, sizeof *root);
-            root->type = IPT_DIR;
-            root->import.dir.name = type_resolver->current_package->full_name->name;
-            root->import.dir.child = import->import_path;
-            return root;
-        }
+void type_resolver_free(TypeResolver* type_resolver) {
+    for (size_t i = 0; i < type_resolver->jobs; ++i) {
+        arena_free(type_resolver->worker_arenas + i);
     }
 }
 
-bool is_generic_impl_eq(GenericImpl* a, GenericImpl* b) {
-    if (a->length != b->length) {
-        return false;
-    }
+static void register_generic_use(Packages* packages, GenericUse use) {
+    packages_register_generic_impl(packages, use.decl, use.resolved_types_length, use.resolved_types);
 
-    for (size_t i = 0; i < a->length; ++i) {
-        ResolvedType* rta = a->resolved_types[i];
-        ResolvedType* rtb = b->resolved_types[i];
+    ArrayList_LL_Type* generic_impls;
+    if (use.decl->type == ANT_STRUCT_DECL) {
+        generic_impls = &use.decl->node.struct_decl->generic_impls;
+    } else if (use.decl->type == ANT_FUNCTION_DECL) {
+        generic_impls = &use.decl->node.function_decl->header.generic_impls;
+    } else {
+        return;
+    }
 
-        if (!resolved_type_eq(rta, rtb)) {
-            return false;
+    size_t version = generic_impls->length;
+    for (size_t i = 0; i < generic_impls->length; ++i) {
+        if (typells_eq(generic_impls->array[i], use.generic_args)) {
+            version = i;
+            break;
         }
     }
 
-    return true;
-}
-
-LL_GenericImpl map_generic_impls_to_concrete(Packages* packages, LL_GenericImpl* generic_impls, size_t depth) {
-    LL_GenericImpl to_generic_impls = {
-        .length = 0,
-        .head = NULL,
-        .tail = NULL,
-    };
-
-    LLNode_GenericImpl* curr = generic_impls->head;
-    while (curr) {
-        GenericImpl* generic_impl = &curr->data;
-
-        bool has_generic = false;
-
-        for (size_t i = 0; i < generic_impl->length; ++i) {
-            if (generic_impl->resolved_types[i]->kind == RTK_GENERIC) {
-                has_generic = true;
-                break;
-            }
+    if (version == generic_impls->length) {
+        if (use.generic_args.length == 0) {
+            return;
         }
+        arraylist_typells_push(generic_impls, use.generic_args);
+    }
 
-        if (!has_generic) {
-            GenericImpl to_generic_impl = {
-                .length = 0,
-                .resolved_types = arena_calloc(packages->arena, generic_impl->length, sizeof(uintptr_t)),
-            };
-            for (size_t i = 0; i < generic_impl->length; ++i) {
-                to_generic_impl.resolved_types[to_generic_impl.length++] = generic_impl->resolved_types[i];
-            }
-            ll_generic_impls_push(packages->arena, &to_generic_impls, to_generic_impl);
-        } else {
-            // ArrayList<ResolvedType*>
-            ArrayList_Ptr* first = arena_alloc(packages->arena, sizeof *first);
-            *first = arraylist_ptr_create(packages->arena);
-
-            // ArrayList<ArrayList<ResolvedType*>*>
-            ArrayList_Ptr to_generic_impl_many = arraylist_ptr_create(packages->arena);
-            arraylist_ptr_push(&to_generic_impl_many, first);
-
-            for (size_t rtidx = 0; rtidx < generic_impl->length; ++rtidx) {
-                ResolvedType* rt = generic_impl->resolved_types[rtidx];
-
-                if (rt->kind == RTK_GENERIC) {
-                    size_t src_node_id = rt->src->id.val;
-                    size_t idx = rt->type.generic.idx;
-
-                    printf("[%lu] recursively checking %lu...\n", depth, src_node_id);
-
-                    TypeInfo* ti = packages_type_by_node(packages, (NodeId){src_node_id});
-                    assert(ti);
-                    assert(ti->type);
-
-                    if (ti->type->kind == RTK_STRUCT_REF && ti->type->type.struct_ref.decl.generic_params.length > 0) {
-                        assert(ti->type->type.struct_ref.generic_args.length == ti->type->type.struct_ref.decl.generic_params.length);
-
-                        ResolvedType** rts = arena_calloc(packages->arena, ti->type->type.struct_ref.generic_args.length, sizeof(uintptr_t));
-                        for (size_t i = 0; i < ti->type->type.struct_ref.generic_args.length; ++i) {
-                            rts[i] = ti->type->type.struct_ref.generic_args.resolved_types + i;
-                        }
-                        packages_register_generic_impl(packages, ti->type->src, ti->type->type.struct_ref.generic_args.length, rts);
-                    } else if (ti->type->kind == RTK_FUNCTION_REF && ti->type->type.function_ref.decl.generic_params.length > 0) {
-                        assert(ti->type->type.function_ref.generic_args.length == ti->type->type.function_ref.decl.generic_params.length);
-
-                        ResolvedType** rts = arena_calloc(packages->arena, ti->type->type.function_ref.generic_args.length, sizeof(uintptr_t));
-                        for (size_t i = 0; i < ti->type->type.function_ref.generic_args.length; ++i) {
-                            rts[i] = ti->type->type.function_ref.generic_args.resolved_types + i;
-                        }
-                        packages_register_generic_impl(packages, ti->type->src, ti->type->type.function_ref.generic_args.length, rts);
-                    }
-
-                    LL_GenericImpl generic_impls_cache = packages->generic_impls_nodes_raw[ti->type->src->id.val];
-                    packages->generic_impls_nodes_raw[ti->type->src->id.val] = (LL_GenericImpl){0};
-
-                    LL_GenericImpl nested_all = map_generic_impls_to_concrete(packages, &generic_impls_cache, depth + 1);
-
-                    packages->generic_impls_nodes_raw[ti->type->src->id.val] = generic_impls_cache;
-                    LL_GenericImpl* generic_impls = packages->generic_impls_nodes_raw + ti->type->src->id.val;
-
-                    printf("- mapped %lu raw to %lu concrete impls\n", generic_impls->length, nested_all.length);
-
-                    // ArrayList<ResolvedType*>
-                    ArrayList_Ptr nested = arraylist_ptr_create(packages->arena);
-
-                    LLNode_GenericImpl* curr = nested_all.head;
-                    while (curr) {
-                        arraylist_ptr_push(&nested, curr->data.resolved_types[idx]);
-                        curr = curr->next;
-                    }
-
-                    for (size_t mappedidx = 0; mappedidx < nested.length; ++mappedidx) {
-                        ResolvedType* mapped = nested.data[mappedidx];
-                        if (mappedidx == 0) {
-                            for (size_t i = 0; i < to_generic_impl_many.length; ++i) {
-                                ArrayList_Ptr* to_generic_impl = to_generic_impl_many.data[i];
-                                arraylist_ptr_push(to_generic_impl, mapped);
-                            }
-                        } else {
-                            size_t len = to_generic_impl_many.length;
-                            for (size_t i = 0; i < len; ++i) {
-                                ArrayList_Ptr* to_generic_impl_ref = to_generic_impl_many.data[i];
-
-                                ArrayList_Ptr* to_generic_impl = arena_alloc(packages->arena, sizeof *to_generic_impl);
-                                *to_generic_impl = arraylist_ptr_create_with_capacity(packages->arena, to_generic_impl_ref->capacity);
-                                to_generic_impl->length = to_generic_impl_ref->length;
-                                for (size_t j = 0; j < to_generic_impl->length; ++j) {
-                                    to_generic_impl->data[j] = to_generic_impl_ref->data[j];
-                                }
-
-                                size_t last = to_generic_impl->length - 1;
-                                to_generic_impl->data[last] = mapped;
-                                arraylist_ptr_push(&to_generic_impl_many, to_generic_impl);
-                            }
-                        }
-                    }
-                } else {
-                    for (size_t i = 0; i < to_generic_impl_many.length; ++i) {
-                        ArrayList_Ptr* to_generic_impl = to_generic_impl_many.data[i];
-                        arraylist_ptr_push(to_generic_impl, rt);
-                    }
-                }
-            }
-            for (size_t to_generic_implidx = 0; to_generic_implidx < to_generic_impl_many.length; ++to_generic_implidx) {
-                ArrayList_Ptr* to_generic_impl = to_generic_impl_many.data[to_generic_implidx];
-                GenericImpl a = {
-                    .length = to_generic_impl->length,
-                    .resolved_types = (ResolvedType**)to_generic_impl->data,
-                };
-
-                bool found = false;
-                for (size_t i = 0; i < to_generic_implidx; ++i) {
-                    ArrayList_Ptr* to_generic_impl_other = to_generic_impl_many.data[i];
-
-                    GenericImpl b = {
-                        .length = to_generic_impl_other->length,
-                        .resolved_types = (ResolvedType**)to_generic_impl_other->data,
-                    };
+    *use.impl_version = version;
+    if (use.ref_impl_version) {
+        *use.ref_impl_version = version;
+    }
+}
 
-                    if (is_generic_impl_eq(&a, &b)) {
-                        found = true;
-                        break;
-                    }
-                }
+static void use_generic_decl(TypeResolver* type_resolver, GenericUse use) {
+    GenericUses* deferred = type_resolver->deferred_generic_uses;
+    if (!deferred) {
+        register_generic_use(type_resolver->packages, use);
+        return;
+    }
 
-                if (!found) {
-                    ll_generic_impls_push(packages->arena, &to_generic_impls, a);
-                }
-            }
-        }
+    if (deferred->length >= deferred->capacity) {
+        size_t prev_cap = deferred->capacity;
+        deferred->capacity = prev_cap > 0 ? prev_cap * 2 : 8;
+        deferred->array = arena_realloc(deferred->arena, deferred->array, sizeof(*deferred->array) * prev_cap, sizeof(*deferred->array) * deferred->capacity);
+    }
+    deferred->array[deferred->length++] = use;
+}
 
-        curr = curr->next;
+// returns the shared instance of a type computed in scratch memory
+static ResolvedType* canonical_type(TypeResolver* type_resolver, ResolvedType* rt) {
+    if (resolved_type_kind_is_interned(rt->kind)) {
+        return resolved_type_intern(&type_resolver->packages->type_table, *rt);
     }
+    return arena_memcpy(type_resolver->arena, rt, sizeof *rt);
+}
 
-    LL_GenericImpl out = {
-        .length = 0,
-        .head = NULL,
-        .tail = NULL,
-    };
+static ResolvedType* primitive_type(TypeResolver* type_resolver, ResolvedTypeKind kind) {
+    return resolved_type_primitive(&type_resolver->packages->type_table, kind);
+}
 
-    size_t to_generic_implidx = 0;
-    curr = to_generic_impls.head;
-    while (curr) {
-        GenericImpl* to_generic_impl = &curr->data;
+static void resolve_file(TypeResolver* type_resolver, Scope* scope, ASTNodeFileRoot file);
 
-        bool found = false;
-        size_t i = 0;
-        LLNode_GenericImpl* i_curr = to_generic_impls.head;
-        while (i_curr) {
-            if (i >= to_generic_implidx) {
-                break;
-            }
-            GenericImpl* to_generic_impl_other = &i_curr->data;
+typedef struct {
+    TypeResolver resolver;
+
+    Package** packages;
+    size_t* order;
+    size_t order_length;
+    GenericUses* deferred;
+
+    pthread_mutex_t* lock;
+    size_t* next;
+} TypeResolverWorker;
+
+static void resolve_package(TypeResolver* type_resolver, Package* pkg) {
+    type_resolver->current_package = pkg;
+    Scope scope = scope_create(type_resolver, NULL);
+    resolve_file(type_resolver, &scope, pkg->ast->node.file_root);
+    type_resolver->current_package = NULL;
+}
 
-            if (is_generic_impl_eq(to_generic_impl, to_generic_impl_other)) {
-                found = true;
-                break;
-            }
+static void* type_resolver_worker_run(void* arg) {
+    TypeResolverWorker* worker = arg;
 
-            i += 1;
-            i_curr = i_curr->next;
-        }
+    while (true) {
+        pthread_mutex_lock(worker->lock);
+        size_t i = *worker->next;
+        *worker->next += 1;
+        pthread_mutex_unlock(worker->lock);
 
-        if (!found && to_generic_impl->length > 0) {
-            ll_generic_impls_push(packages->arena, &out, *to_generic_impl);
+        if (i >= worker->order_length) {
+            break;
         }
 
-        to_generic_implidx += 1;
-        curr = curr->next;
+        worker->deferred[i].arena = worker->resolver.arena;
+        worker->resolver.deferred_generic_uses = worker->deferred + i;
+        resolve_package(&worker->resolver, worker->packages[worker->order[i]]);
+        worker->resolver.deferred_generic_uses = NULL;
     }
 
-    return out;
+    return NULL;
 }
 
-void resolve_generic_nodes(Packages* packages) {
-    for (size_t i = 0; i < packages->generic_impls_nodes_length; ++i) {
-        LL_GenericImpl* generic_impls = packages->generic_impls_nodes_raw + i;
-        if (generic_impls->length > 0) {
-            printf("RESOLVING %lu...\n", i);
-            LL_GenericImpl concrete_generic_impls = map_generic_impls_to_concrete(packages, generic_impls, 0);
-
-            packages->generic_impls_nodes_concrete[i] = concrete_generic_impls;
-
-            printf("Node [%lu]: ", i);
-            print_resolved_type(packages_type_by_node(packages, (NodeId){i})->type);
-            printf("\n");
-
-            if (concrete_generic_impls.length > 0) {
-                printf("- From:\n");
-            }
-            {
-                size_t j = 0;
-                LLNode_GenericImpl* curr = generic_impls->head;
-                while (curr) {
-                    printf("[%lu] ", j);
-                    for (size_t k = 0; k < curr->data.length; ++k) {
-                        print_resolved_type(curr->data.resolved_types[k]);
-                        printf(", ");
-                    }
-                    printf("\n");
-
-                    j += 1;
-                    curr = curr->next;
-                }
-            }
+// Packages in one level only read types from earlier levels, and each writes
+// the types of its own nodes, so the only shared writes are generic uses.
+static void resolve_level(TypeResolver* type_resolver, Package** packages, size_t* order, size_t order_length) {
+    size_t jobs = type_resolver->jobs;
+    if (jobs > order_length) {
+        jobs = order_length;
+    }
+    // dumps are written as types are resolved, so they stay in order
+    if (log_dumps(LOG_DUMP_GENERICS)) {
+        jobs = 1;
+    }
 
-            if (concrete_generic_impls.length > 0) {
-                printf("- To:\n");
-                size_t j = 0;
-                LLNode_GenericImpl* curr = concrete_generic_impls.head;
-                while (curr) {
-                    assert(curr->data.length);
-                    printf("[%lu] ", j);
-                    for (size_t k = 0; k < curr->data.length; ++k) {
-                        print_resolved_type(curr->data.resolved_types[k]);
-                        printf(", ");
-                    }
-                    printf("\n");
+    for (size_t i = 0; i < order_length; ++i) {
+        Package* pkg = packages[order[i]];
+        assert(packages_resolve(type_resolver->packages, pkg->full_name) == pkg);
 
-                    j += 1;
-                    curr = curr->next;
-                }
-            }
+        log_verbose("Resolving package \"%s\"...\n",
+            pkg->full_name ? package_path_to_str(type_resolver->arena, pkg->full_name).chars : "<main>"
+        );
 
-            printf("\n");
+        if (jobs <= 1) {
+            resolve_package(type_resolver, pkg);
         }
     }
-}
-
-// This is my 3rd attempt ... comments are so I can understand again
-size_t* calculate_resolve_order(Arena* arena, AdjacencyList dependencies, size_t packages_length) {
-    // array of number of unresolved dependencies for each package
-    size_t* in_degree = arena_calloc(arena, packages_length, sizeof *in_degree);
-    assert(in_degree);
-
-    // calculate in-degrees (number of dependencies) for each package
-    for (size_t i = 0; i < dependencies.length; ++i) {
-        size_t dependent_idx = dependencies.dependent_idxs[i];
-        in_degree[dependent_idx] += 1;
+    if (jobs <= 1) {
+        return;
     }
 
-    // array of sorted order
-    size_t* resolve_order = arena_calloc(arena, packages_length, sizeof *resolve_order);
-    assert(resolve_order);
-
-    // queue for packages with no unresolved dependencies
-    size_t* queue = arena_calloc(arena, packages_length, sizeof *queue);
-    assert(queue);
-
-    size_t queue_start = 0;
-    size_t queue_end = 0;
-
-    // init queue with packages that have no dependencies
-    for (size_t i = 0; i < packages_length; ++i) {
-        if (in_degree[i] == 0) {
-            queue[queue_end++] = i;
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+    size_t next = 0;
+
+    GenericUses* deferred = arena_calloc(type_resolver->arena, order_length, sizeof *deferred);
+    TypeResolverWorker* workers = arena_calloc(type_resolver->arena, jobs, sizeof *workers);
+    pthread_t* threads = arena_calloc(type_resolver->arena, jobs, sizeof *threads);
+
+    for (size_t i = 0; i < jobs; ++i) {
+        TypeResolver resolver = *type_resolver;
+        resolver.arena = type_resolver->worker_arenas + i;
+        resolver.nodes_visited = 0;
+        resolver.decl_visits = 0;
+        resolver.passes_saved = 0;
+
+        workers[i] = (TypeResolverWorker){
+            .resolver = resolver,
+            .packages = packages,
+            .order = order,
+            .order_length = order_length,
+            .deferred = deferred,
+            .lock = &lock,
+            .next = &next,
+        };
+        if (pthread_create(threads + i, NULL, type_resolver_worker_run, workers + i) != 0) {
+            fprintf(stderr, "Could not start type resolver worker thread.\n");
+            exit(71);
         }
     }
 
-    // index for filling the resolve_order array
-    size_t order_index = 0;
+    for (size_t i = 0; i < jobs; ++i) {
+        pthread_join(threads[i], NULL);
 
-    while (queue_start < queue_end) {
-        size_t pkg = queue[queue_start++];
-        resolve_order[order_index++] = pkg;
-
-        // process all dependents of the current package
-        for (size_t i = 0; i < dependencies.length; ++i) {
-            if (dependencies.dependency_idxs[i] == pkg) {
-                size_t dependent = dependencies.dependent_idxs[i];
-                
-                // decrease the in-degree and add to queue if no more dependencies
-                in_degree[dependent] -= 1;
-                if (in_degree[dependent] == 0) {
-                    queue[queue_end++] = dependent;
-                }
-            }
-        }
+        type_resolver->nodes_visited += workers[i].resolver.nodes_visited;
+        type_resolver->decl_visits += workers[i].resolver.decl_visits;
+        type_resolver->passes_saved += workers[i].resolver.passes_saved;
     }
 
-    // check if we were able to resolve all packages
-    if (order_index != packages_length) {
-        printf("Cycle detected!\n");
-        assert(false);
-    }
+    pthread_mutex_destroy(&lock);
 
-    return resolve_order;
+    // register generic uses in the order a serial run would have
+    for (size_t i = 0; i < order_length; ++i) {
+        for (size_t j = 0; j < deferred[i].length; ++j) {
+            register_generic_use(type_resolver->packages, deferred[i].array[j]);
+        }
+    }
 }
 
-static void resolve_file(TypeResolver* type_resolver, Scope* scope, ASTNodeFileRoot file);
-
 void resolve_types(TypeResolver* type_resolver) {
-    size_t packages_len = 0;
-    Package* packages = arena_calloc(type_resolver->arena, type_resolver->packages->count, sizeof *packages);
-
-    // Understand which files depend on which other files
-    for (size_t i = 0; i < type_resolver->packages->lookup_length; ++i) {
-        ArrayList_Package bucket = type_resolver->packages->lookup_buckets[i];
-
-        for (size_t j = 0; j < bucket.length; ++j) {
-            Package pkg = bucket.array[j];
+    // in insertion order, so ties in the resolve order don't depend on hashing
+    size_t packages_len = type_resolver->packages->count;
+    Package** packages = type_resolver->packages->list;
 
-            assert(pkg.ast);
-            assert(pkg.ast->type == ANT_FILE_ROOT);
-
-            assert(packages_len < type_resolver->packages->count);
-            packages[packages_len++] = pkg;
-        }
+    for (size_t i = 0; i < packages_len; ++i) {
+        assert(packages[i]->id == i);
+        assert(packages[i]->ast);
+        assert(packages[i]->ast->type == ANT_FILE_ROOT);
     }
-    assert(packages_len == type_resolver->packages->count);
 
-    AdjacencyList dependencies = adjacency_list_create(type_resolver->arena, 1);
+    // Understand which files depend on which other files
+    PackageGraph graph = package_graph_create(type_resolver->arena, packages, packages_len);
 
     for (size_t i = 0; i < packages_len; ++i) {
-        Package pkg = packages[i];
-        LLNode_ASTNode* decl = pkg.ast->node.file_root.nodes.head;
-        bool has_imports = false;
-        while (decl) {
-            if (decl->data.type == ANT_IMPORT) {
-                has_imports = true;
-
-                type_resolver->current_package = &pkg;
-                ImportPath* path = expand_import_path(type_resolver, &decl->data.node.import);
-                type_resolver->current_package = NULL;
+        Package* pkg = packages[i];
+        for (size_t d = 0; d < pkg->ast->node.file_root.nodes.length; ++d) {
+            ASTNode* decl = pkg->ast->node.file_root.nodes.array + d;
+            if (decl->type == ANT_IMPORT) {
+                ImportPath* path = import_path_expand(type_resolver->arena, &decl->node.import, pkg->full_name);
 
                 PackagePath* dependency = import_path_to_package_path(type_resolver->arena, path);
                 assert(dependency);
 
                 Package* found = packages_resolve(type_resolver->packages, dependency);
                 if (!found) {
-                    printf("FROM FILE: \"%s\"\n", pkg.full_name ? package_path_to_str(type_resolver->arena, pkg.full_name).chars : "<main>");
-                    printf("Cannot find import [%s]\n", import_path_to_str(type_resolver->arena, path).chars);
-                    printf("Cannot find package [%s]\n", package_path_to_str(type_resolver->arena, dependency).chars);
-                    assert(false);
+                    fprintf(stderr, "Cannot find package [%s] imported by [%s]: it is neither a source path nor found in a module path (-I).\n",
+                        package_path_to_str(type_resolver->arena, dependency).chars,
+                        pkg->full_name ? package_path_to_str(type_resolver->arena, pkg->full_name).chars : "<main>"
+                    );
+                    exit(65);
                 }
 
-                bool found_idx = false;
-                for (size_t j = 0; j < packages_len; ++j) {
-                    if (i == j) {
-                        continue;
-                    }
-
-                    if (!packages[j].full_name) {
-                        continue;
-                    }
+                size_t found_idx = package_graph_index(&graph, found);
+                assert(found_idx < packages_len);
 
-                    if (packages[j].ast->id.val == found->ast->id.val) {
-                        found_idx = true;
-                        add_package_dependency(&dependencies, i, j);
-                        break;
-                    }
+                if (found_idx != i && found->full_name) {
+                    package_graph_add_import(&graph, i, found_idx);
                 }
-                assert(found);
             }
-
-            decl = decl->next;
         }
     }
 
-    {
-        printf("Unsorted packages:\n");
+    package_graph_build(&graph);
+
+    if (log_enabled(LOG_VERBOSE)) {
+        log_verbose("Unsorted packages:\n");
         for (size_t i = 0; i < packages_len; ++i) {
-            Package* pkg = packages + i;
+            log_verbose("[%lu] %s\n", i, arena_strcpy(type_resolver->arena, package_graph_name(&graph, i)).chars);
+        }
+        log_verbose("\n");
 
-            printf("[%lu] %s\n", i,
-                pkg->full_name ? package_path_to_str(type_resolver->arena, pkg->full_name).chars : "<main>"
+        log_verbose("Dependencies:\n");
+        for (size_t i = 0; i < graph.edges_length; ++i) {
+            log_verbose("- [%s] depends on [%s]\n",
+                arena_strcpy(type_resolver->arena, package_graph_name(&graph, graph.edge_importers[i])).chars,
+                arena_strcpy(type_resolver->arena, package_graph_name(&graph, graph.edge_imports[i])).chars
             );
         }
-        printf("\n");
-
-        printf("Dependencies:\n");
-        for (size_t i = 0; i < dependencies.length; ++i) {
-            assert(dependencies.dependent_idxs + i);
-            assert(dependencies.dependency_idxs + i);
-
-            size_t dependent_idx = dependencies.dependent_idxs[i];
-            size_t dependency_idx = dependencies.dependency_idxs[i];
-
-            assert(packages + dependent_idx);
-            assert(packages + dependency_idx);
-
-            Package dependent = packages[dependent_idx];
-            Package dependency = packages[dependency_idx];
+        log_verbose("\n");
+    }
 
-            assert(dependency.full_name);
+    size_t* resolve_order = arena_calloc(type_resolver->arena, packages_len, sizeof *resolve_order);
 
-            printf("- [");
-            printf("%s", dependent.full_name ? package_path_to_str(type_resolver->arena, dependent.full_name).chars : "<main>");
-            printf("] depends on [");
-            printf("%s", package_path_to_str(type_resolver->arena, dependency.full_name).chars);
-            printf("]\n");
+    PackageCycle cycle = {0};
+    if (!package_graph_sort(&graph, resolve_order, &cycle)) {
+        fprintf(stderr, "Import cycle detected: ");
+        for (size_t i = 0; i < cycle.length; ++i) {
+            if (i > 0) {
+                fprintf(stderr, " -> ");
+            }
+            fprintf(stderr, "%s", arena_strcpy(type_resolver->arena, package_graph_name(&graph, cycle.package_idxs[i])).chars);
         }
-        printf("\n");
+        fprintf(stderr, "\n");
+        exit(65);
     }
 
-    size_t* resolve_order = calculate_resolve_order(type_resolver->arena, dependencies, packages_len);
-    assert(resolve_order);
-
-    {
-        printf("Resolve order:\n");
+    if (log_enabled(LOG_VERBOSE)) {
+        log_verbose("Resolve order:\n");
         for (size_t i = 0; i < packages_len; ++i) {
-            size_t idx = resolve_order[i];
+            log_verbose("- %s\n", arena_strcpy(type_resolver->arena, package_graph_name(&graph, resolve_order[i])).chars);
+        }
+        log_verbose("\n");
+    }
 
-            Package* pkg = packages + idx;
-            printf("- %s\n",
-                pkg->full_name ? package_path_to_str(type_resolver->arena, pkg->full_name).chars : "<main>"
-            );
+    // imports come earlier in the resolve order, so their fingerprints are final
+    for (size_t i = 0; i < packages_len; ++i) {
+        Package* pkg = packages[resolve_order[i]];
+        for (size_t e = graph.import_offsets[resolve_order[i]]; e < graph.import_offsets[resolve_order[i] + 1]; ++e) {
+            pkg->fingerprint = fingerprint_mix(pkg->fingerprint, packages[graph.imports[e]]->fingerprint);
         }
-        printf("\n");
     }
 
+    // level of a package: one past the deepest of its imports
+    size_t* levels = arena_calloc(type_resolver->arena, packages_len, sizeof *levels);
     for (size_t i = 0; i < packages_len; ++i) {
         size_t idx = resolve_order[i];
+        for (size_t e = graph.import_offsets[idx]; e < graph.import_offsets[idx + 1]; ++e) {
+            size_t level = levels[graph.imports[e]] + 1;
+            if (level > levels[idx]) {
+                levels[idx] = level;
+            }
+        }
+    }
 
-        Package* pkg = packages + idx;
-        assert(packages_resolve(type_resolver->packages, pkg->full_name));
+    // the resolve order visits levels in ascending order
+    size_t level_start = 0;
+    while (level_start < packages_len) {
+        size_t level = levels[resolve_order[level_start]];
 
-        printf("Resolving package \"%s\"...\n",
-            pkg->full_name ? package_path_to_str(type_resolver->arena, pkg->full_name).chars : "<main>"
-        );
+        size_t level_end = level_start + 1;
+        while (level_end < packages_len && levels[resolve_order[level_end]] == level) {
+            level_end += 1;
+        }
+        assert(level_end == packages_len || levels[resolve_order[level_end]] > level);
 
-        type_resolver->current_package = pkg;
-        Scope scope = scope_create(type_resolver->arena, NULL);
-        resolve_file(type_resolver, &scope, pkg->ast->node.file_root);
-        type_resolver->current_package = NULL;
+        resolve_level(type_resolver, packages, resolve_order + level_start, level_end - level_start);
+        level_start = level_end;
     }
-    printf("\n");
 
-    assert(type_resolver->packages->generic_impls_nodes_concrete);
-    resolve_generic_nodes(type_resolver->packages);
+    log_verbose("Type resolution visited %lu nodes in %lu decl visits (%lu full passes saved)\n",
+        type_resolver->nodes_visited,
+        type_resolver->decl_visits,
+        type_resolver->passes_saved
+    );
+
+    monomorphize(type_resolver->packages);
 }
 
 static ResolvedType* calc_resolved_type(TypeResolver* type_resolver, Scope* scope, Type* type);
 
-static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* scope, TypeStaticPath* t_static_path) {
+static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* scope, TypeStaticPath* t_static_path, Package** out_namespace) {
     assert(t_static_path);
     assert(t_static_path->path);
 
     StaticPath* static_path = t_static_path->path;
 
-    ResolvedType* rt = scope_get(scope, static_path->name);
+    Symbol symbol = static_path->symbol ? static_path->symbol : intern(static_path->name);
+    ResolvedType* rt = scope_get(scope, symbol);
     if (!rt) {
+        if (type_resolver->worklist) {
+            worklist_wait(type_resolver->worklist, symbol);
+        }
         return NULL;
     }
 
@@ -730,7 +738,9 @@ static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* s
             case RTK_NAMESPACE: {
                 assert(rt->type.namespace_->ast->type == ANT_FILE_ROOT);
 
-                ASTNode* node = find_decl_by_name(rt->type.namespace_->ast->node.file_root, static_path->name);
+                ASTNode* node = static_path->symbol
+                    ? decl_index_by_symbol(&rt->type.namespace_->decls, static_path->symbol)
+                    : decl_index_by_name(&rt->type.namespace_->decls, static_path->name);
                 if (!node) {
                     printf("Couldn't find \"%s\" in \"%s\"\n", arena_strcpy(type_resolver->arena, static_path->name).chars, package_path_to_str(type_resolver->arena, rt->type.namespace_->full_name).chars);
                 }
@@ -739,11 +749,14 @@ static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* s
                 ResolvedType* tmp = packages_type_by_node(type_resolver->packages, node->id)->type;
                 if (!tmp) {
                     printf("failed lookup for: \"%s\"\n", arena_strcpy(type_resolver->arena, static_path->name).chars);
-                    assert(rt->type.namespace_->ast->node.file_root.nodes.head);
-                    assert(rt->type.namespace_->ast->node.file_root.nodes.head->data.type == ANT_PACKAGE);
-                    printf("Package: \"%s\"\n", package_path_to_str(type_resolver->arena, rt->type.namespace_->ast->node.file_root.nodes.head->data.node.package.package_path).chars);
+                    assert(rt->type.namespace_->ast->node.file_root.nodes.length > 0);
+                    assert(rt->type.namespace_->ast->node.file_root.nodes.array[0].type == ANT_PACKAGE);
+                    printf("Package: \"%s\"\n", package_path_to_str(type_resolver->arena, rt->type.namespace_->ast->node.file_root.nodes.array[0].node.package.package_path).chars);
                 }
                 assert(tmp);
+                if (out_namespace) {
+                    *out_namespace = rt->type.namespace_;
+                }
                 rt = tmp;
 
                 break;
@@ -755,40 +768,26 @@ static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* s
     assert(rt);
 
     if (rt->kind == RTK_STRUCT_DECL) {
-        ArrayList_LL_Type* generic_impls = &rt->src->node.struct_decl.generic_impls;
-        if (!generic_impls || !generic_impls->array) {
-            *generic_impls = arraylist_typells_create(type_resolver->arena);
-        }
-
-        Scope fields_scope = scope_create(type_resolver->arena, scope);
+        Scope fields_scope = scope_create(type_resolver, scope);
         for (size_t i = 0; i < rt->type.struct_decl.generic_params.length; ++i) {
-            ResolvedType* generic_rt = arena_alloc(type_resolver->arena, sizeof *generic_rt);
-            generic_rt->kind = RTK_GENERIC;
-            generic_rt->src = rt->src;
-            generic_rt->type.generic.idx = i;
-            generic_rt->type.generic.name = rt->type.struct_decl.generic_params.strings[i];
-            generic_rt->from_pkg = rt->from_pkg;
-            scope_set(&fields_scope, rt->type.struct_decl.generic_params.strings[i], generic_rt);
-        }
-
-        ResolvedType* rt_new = arena_alloc(type_resolver->arena, sizeof *rt_new);
-        *rt_new = (ResolvedType){
-            .from_pkg = rt->from_pkg,
-            .src = rt->src,
-            .kind = RTK_STRUCT_REF,
-            .type.struct_ref = {
-                .decl = rt->type.struct_decl,
-                .decl_node_id = rt->src->id,
-                .generic_args = {
-                    .length = 0,
-                    .resolved_types = arena_calloc(type_resolver->arena, t_static_path->generic_args.length, sizeof *rt_new->type.struct_ref.generic_args.resolved_types),
+            ResolvedType* generic_rt = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
+                .from_pkg = rt->from_pkg,
+                .src = rt->src,
+                .kind = RTK_GENERIC,
+                .type.generic = {
+                    .name = rt->type.struct_decl.generic_params.strings[i],
+                    .idx = i,
                 },
-                .impl_version = 0,
-            },
-        };
-        rt = rt_new;
+            });
+            scope_set(&fields_scope, intern(rt->type.struct_decl.generic_params.strings[i]), generic_rt);
+        }
+
+        assert(t_static_path->generic_args.length == rt->type.struct_decl.generic_params.length);
 
-        assert(t_static_path->generic_args.length == rt->type.struct_ref.decl.generic_params.length);
+        ResolvedTypes generic_args = {
+            .length = 0,
+            .resolved_types = arena_calloc(type_resolver->arena, t_static_path->generic_args.length, sizeof(ResolvedType*)),
+        };
 
         LLNode_Type* curr = t_static_path->generic_args.head;
         while (curr) {
@@ -796,14 +795,22 @@ static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* s
             assert(generic_arg);
 
             // if (generic_arg->kind == RTK_GENERIC) {
-            //     assert(generic_arg->src->id.val != rt->type.struct_ref.decl_node_id.val);
+            //     assert(generic_arg->src->id.val != rt->src->id.val);
             // }
 
-            assert(rt->type.struct_ref.generic_args.length < t_static_path->generic_args.length);
-            rt->type.struct_ref.generic_args.resolved_types[rt->type.struct_ref.generic_args.length++] = *generic_arg;
+            assert(generic_args.length < t_static_path->generic_args.length);
+            generic_args.resolved_types[generic_args.length++] = generic_arg;
 
             curr = curr->next;
         }
+
+        rt = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
+            .kind = RTK_STRUCT_REF,
+            .type.struct_ref = {
+                .decl = rt,
+                .generic_args = generic_args,
+            },
+        });
         assert(rt->type.struct_ref.generic_args.length == t_static_path->generic_args.length);
     }
 
@@ -831,26 +838,14 @@ static ResolvedType* calc_static_path_type(TypeResolver* type_resolver, Scope* s
                 curr = curr->next;
             }
 
-            packages_register_generic_impl(type_resolver->packages, rt->src, t_static_path->generic_args.length, resolved_types);
-        }
-        if (rt->src->type == ANT_STRUCT_DECL) {
-            ArrayList_LL_Type* generic_impls = &rt->src->node.struct_decl.generic_impls;
-
-            bool already_has_decl = false;
-            for (size_t i = 0; i < generic_impls->length; ++i) {
-                if (typells_eq(generic_impls->array[i], t_static_path->generic_args)) {
-                    already_has_decl = true;
-                    t_static_path->impl_version = i;
-                    rt->type.struct_ref.impl_version = i;
-                    break;
-                }
-            }
-
-            if (!already_has_decl && t_static_path->generic_args.length > 0) {
-                t_static_path->impl_version = generic_impls->length;
-                rt->type.struct_ref.impl_version = generic_impls->length;
-                arraylist_typells_push(generic_impls, t_static_path->generic_args);
-            }
+            use_generic_decl(type_resolver, (GenericUse){
+                .decl = rt->src,
+                .generic_args = t_static_path->generic_args,
+                .resolved_types_length = t_static_path->generic_args.length,
+                .resolved_types = resolved_types,
+                .impl_version = &t_static_path->impl_version,
+                .ref_impl_version = NULL,
+            });
         }
     } else {
         assert(t_static_path->generic_args.length == 0);
@@ -867,215 +862,47 @@ static ResolvedType* calc_resolved_type(TypeResolver* type_resolver, Scope* scop
     // printf("TK-%d\n", type->kind);
     switch (type->kind) {
         case TK_STATIC_PATH: {
-            return calc_static_path_type(type_resolver, scope, &type->type.static_path);
+            return calc_static_path_type(type_resolver, scope, &type->type.static_path, NULL);
         }
 
         case TK_BUILT_IN: {
             // printf("TBI-%d\n", type->type.built_in);
+            ResolvedTypeKind kind;
             switch (type->type.built_in) {
-                case TBI_VOID: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_VOID;
-                    resolved_type->type.void_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_BOOL: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_BOOL;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_CHAR: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_CHAR;
-                    resolved_type->type.char_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_INT: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_INT;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_INT8: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_INT8;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_INT16: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_INT16;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_INT32: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_INT32;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_INT64: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_INT64;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_UINT: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_UINT;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_UINT8: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_UINT8;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_UINT16: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_UINT16;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_UINT32: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_UINT32;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_UINT64: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_UINT64;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_FLOAT: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_FLOAT;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_FLOAT32: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_FLOAT32;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
-
-                case TBI_FLOAT64: {
-                    ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                    resolved_type->from_pkg = type_resolver->current_package;
-                    resolved_type->kind = RTK_FLOAT64;
-                    resolved_type->type.uint_ = NULL;
-                    *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
-                        .status = TIS_CONFIDENT,
-                        .type = resolved_type,
-                    };
-                    return resolved_type;
-                }
+                case TBI_VOID: kind = RTK_VOID; break;
+                case TBI_BOOL: kind = RTK_BOOL; break;
+                case TBI_CHAR: kind = RTK_CHAR; break;
+                case TBI_INT: kind = RTK_INT; break;
+                case TBI_INT8: kind = RTK_INT8; break;
+                case TBI_INT16: kind = RTK_INT16; break;
+                case TBI_INT32: kind = RTK_INT32; break;
+                case TBI_INT64: kind = RTK_INT64; break;
+                case TBI_UINT: kind = RTK_UINT; break;
+                case TBI_UINT8: kind = RTK_UINT8; break;
+                case TBI_UINT16: kind = RTK_UINT16; break;
+                case TBI_UINT32: kind = RTK_UINT32; break;
+                case TBI_UINT64: kind = RTK_UINT64; break;
+                case TBI_FLOAT: kind = RTK_FLOAT; break;
+                case TBI_FLOAT32: kind = RTK_FLOAT32; break;
+                case TBI_FLOAT64: kind = RTK_FLOAT64; break;
 
                 case TBI_COUNT: assert(false);
+                default: assert(false);
             }
 
-            break;
+            ResolvedType* resolved_type = resolved_type_primitive(&type_resolver->packages->type_table, kind);
+            *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
+                .status = TIS_CONFIDENT,
+                .type = resolved_type,
+            };
+            return resolved_type;
         }
 
         case TK_ARRAY: {
-            ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-            resolved_type->from_pkg = type_resolver->current_package;
-            resolved_type->kind = RTK_ARRAY;
-            resolved_type->type.array.of = calc_resolved_type(type_resolver, scope, type->type.array.of);
+            ResolvedType* resolved_type = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
+                .kind = RTK_ARRAY,
+                .type.array.of = calc_resolved_type(type_resolver, scope, type->type.array.of),
+            });
             *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
                 .status = TIS_CONFIDENT,
                 .type = resolved_type,
@@ -1084,10 +911,11 @@ static ResolvedType* calc_resolved_type(TypeResolver* type_resolver, Scope* scop
         }
 
         case TK_POINTER: {
-            ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-            resolved_type->from_pkg = type_resolver->current_package;
-            resolved_type->kind = RTK_POINTER;
-            resolved_type->type.ptr.of = calc_resolved_type(type_resolver, scope, type->type.ptr.of);
+            ResolvedType* resolved_type = resolved_type_pointer(
+                &type_resolver->packages->type_table,
+                RTK_POINTER,
+                calc_resolved_type(type_resolver, scope, type->type.ptr.of)
+            );
             *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
                 .status = TIS_CONFIDENT,
                 .type = resolved_type,
@@ -1096,14 +924,15 @@ static ResolvedType* calc_resolved_type(TypeResolver* type_resolver, Scope* scop
         }
 
         case TK_MUT_POINTER: {
-            ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-            resolved_type->type.mut_ptr.of = calc_resolved_type(type_resolver, scope, type->type.mut_ptr.of);
+            ResolvedType* resolved_type = resolved_type_pointer(
+                &type_resolver->packages->type_table,
+                RTK_MUT_POINTER,
+                calc_resolved_type(type_resolver, scope, type->type.mut_ptr.of)
+            );
             *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
                 .status = TIS_CONFIDENT,
                 .type = resolved_type,
             };
-            resolved_type->from_pkg = resolved_type->type.mut_ptr.of->from_pkg;
-            resolved_type->kind = RTK_MUT_POINTER;
             return resolved_type;
         }
 
@@ -1121,22 +950,14 @@ static Changed resolve_type_type(TypeResolver* type_resolver, Scope* scope, ASTN
     if (!resolved_type) {
         return false;
     }
-    if (!resolved_type->from_pkg) {
-        resolved_type->from_pkg = type_resolver->current_package;
-    }
-    resolved_type->src = node;
 
     type_resolver->packages->types[node->id.val] = (TypeInfo){
         .status = TIS_CONFIDENT,
         .type = resolved_type,
     };
-
-    ResolvedType* resolved_type2 = arena_alloc(type_resolver->arena, sizeof *resolved_type2);
-    *resolved_type2 = *resolved_type;
-
     *packages_type_by_type(type_resolver->packages, type->id) = (TypeInfo){
         .status = TIS_CONFIDENT,
-        .type = resolved_type2,
+        .type = resolved_type,
     };
 
     return !already_known;
@@ -1145,6 +966,7 @@ static Changed resolve_type_type(TypeResolver* type_resolver, Scope* scope, ASTN
 static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTNode* node) {
     Changed changed = false;
     bool already_known = type_resolver->packages->types[node->id.val].status == TIS_CONFIDENT;
+    type_resolver->nodes_visited += 1;
 
     switch (node->type) {
         case ANT_FILE_ROOT: assert(false);
@@ -1165,7 +987,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         };
 
         case ANT_IMPORT: {
-            ImportPath* import_path = expand_import_path(type_resolver, (ASTNodeImport*)&node->node.import);
+            ImportPath* import_path = import_path_expand(type_resolver->arena, (ASTNodeImport*)&node->node.import, type_resolver->current_package->full_name);
             PackagePath* to_import_path = import_path_to_package_path(type_resolver->arena, import_path);
             Package* package = packages_resolve(type_resolver->packages, to_import_path);
             if (!package) {
@@ -1183,7 +1005,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 assert(static_path->type == ISPT_IDENT);
                 assert(static_path->import.ident.child == NULL);
 
-                ASTNode* found = find_decl_by_name(package->ast->node.file_root, static_path->import.ident.name);
+                ASTNode* found = decl_index_by_name(&package->decls, static_path->import.ident.name);
                 TypeInfo* ti = packages_type_by_node(type_resolver->packages, found->id);
                 assert(ti);
                 assert(ti->status == TIS_CONFIDENT);
@@ -1192,8 +1014,9 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = TIS_CONFIDENT,
                     .type = ti->type,
+                    .namespace_ = package,
                 };
-                scope_set(scope, static_path->import.ident.name, ti->type);
+                scope_set(scope, intern(static_path->import.ident.name), ti->type);
             } else {
                 // Importing a package namespace, no specific decl
                 ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
@@ -1208,7 +1031,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                     .status = TIS_CONFIDENT,
                     .type = resolved_type,
                 };
-                scope_set(scope, ip_curr->import.file.name, resolved_type);
+                scope_set(scope, intern(ip_curr->import.file.name), resolved_type);
             }
 
             break;
@@ -1223,8 +1046,8 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             changed |= resolve_type_node(type_resolver, scope, node->node.unary_op.right);
             TypeInfo inner_ti = type_resolver->packages->types[node->node.unary_op.right->id.val];
             if (inner_ti.type) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = *inner_ti.type;
+                ResolvedType scratch = *inner_ti.type;
+                ResolvedType* rt = &scratch;
 
                 switch (node->node.unary_op.op) {
                     case UO_NUM_NEGATE: {
@@ -1339,7 +1162,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = inner_ti.status,
-                    .type = rt,
+                    .type = canonical_type(type_resolver, rt),
                 };
                 changed = true;
             }
@@ -1353,8 +1176,8 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             TypeInfo inner_ti1 = type_resolver->packages->types[node->node.binary_op.lhs->id.val];
             TypeInfo inner_ti2 = type_resolver->packages->types[node->node.binary_op.rhs->id.val];
             if (inner_ti1.type && inner_ti2.type) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = *inner_ti1.type;
+                ResolvedType scratch = *inner_ti1.type;
+                ResolvedType* rt = &scratch;
 
                 switch (node->node.binary_op.op) {
                     case BO_BIT_OR:
@@ -1661,7 +1484,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = inner_ti1.status,
-                    .type = rt,
+                    .type = canonical_type(type_resolver, rt),
                 };
                 changed = true;
             }
@@ -1672,8 +1495,8 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             changed |= resolve_type_node(type_resolver, scope, node->node.postfix_op.left);
             TypeInfo inner_ti = type_resolver->packages->types[node->node.postfix_op.left->id.val];
             if (inner_ti.type) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = *inner_ti.type;
+                ResolvedType scratch = *inner_ti.type;
+                ResolvedType* rt = &scratch;
 
                 switch (node->node.postfix_op.op) {
                     case PFO_PLUS_PLUS:
@@ -1711,7 +1534,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = inner_ti.status,
-                    .type = rt,
+                    .type = canonical_type(type_resolver, rt),
                 };
                 changed = true;
             }
@@ -1719,21 +1542,19 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         }
 
         case ANT_TUPLE: {
-            LLNode_ASTNode* curr = node->node.tuple.exprs.head;
             bool resolved = true;
-            while (curr) {
-                changed |= resolve_type_node(type_resolver, scope, &curr->data);
+            for (size_t i = 0; i < node->node.tuple.exprs.length; ++i) {
+                ASTNode* curr = node->node.tuple.exprs.array + i;
+                changed |= resolve_type_node(type_resolver, scope, curr);
 
-                if (!type_resolver->packages->types[curr->data.id.val].type) {
+                if (!type_resolver->packages->types[curr->id.val].type) {
                     resolved = false;
                 }
-                
-                curr = curr->next;
             }
 
             if (resolved) {
                 if (node->node.tuple.exprs.length == 1) {
-                    type_resolver->packages->types[node->id.val] = type_resolver->packages->types[node->node.tuple.exprs.head->data.id.val];
+                    type_resolver->packages->types[node->id.val] = type_resolver->packages->types[node->node.tuple.exprs.array[0].id.val];
                     changed = true;
                 } else {
                     assert(false);
@@ -1786,7 +1607,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
 
             if (type_resolver->packages->types[node->id.val].type) {
                 // type_resolver->packages->types[node->id.val].type->from_pkg = type_resolver->current_package;
-                scope_set(scope, node->node.var_decl.lhs.lhs.name, type_resolver->packages->types[node->id.val].type);
+                scope_set(scope, intern(node->node.var_decl.lhs.lhs.name), type_resolver->packages->types[node->id.val].type);
             } else {
                 changed = true;
             }
@@ -1809,7 +1630,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                     assert(root.type->type.ptr.of->kind == RTK_STRUCT_REF || root.type->type.ptr.of->kind == RTK_STRUCT_DECL);
                     if (root.type->type.ptr.of->kind == RTK_STRUCT_REF) {
                         maybe_struct_ref = &root.type->type.ptr.of->type.struct_ref;
-                        struct_decl = root.type->type.ptr.of->type.struct_ref.decl;
+                        struct_decl = root.type->type.ptr.of->type.struct_ref.decl->type.struct_decl;
                     } else {
                         struct_decl = root.type->type.ptr.of->type.struct_decl;
                     }
@@ -1817,7 +1638,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                     assert(root.type->type.mut_ptr.of->kind == RTK_STRUCT_REF || root.type->type.mut_ptr.of->kind == RTK_STRUCT_DECL);
                     if (root.type->type.mut_ptr.of->kind == RTK_STRUCT_REF) {
                         maybe_struct_ref = &root.type->type.mut_ptr.of->type.struct_ref;
-                        struct_decl = root.type->type.mut_ptr.of->type.struct_ref.decl;
+                        struct_decl = root.type->type.mut_ptr.of->type.struct_ref.decl->type.struct_decl;
                     } else {
                         struct_decl = root.type->type.mut_ptr.of->type.struct_decl;
                     }
@@ -1826,7 +1647,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 assert(root.type->kind == RTK_STRUCT_REF || root.type->kind == RTK_STRUCT_DECL);
                 if (root.type->kind == RTK_STRUCT_REF) {
                     maybe_struct_ref = &root.type->type.struct_ref;
-                    struct_decl = root.type->type.struct_ref.decl;
+                    struct_decl = root.type->type.struct_ref.decl->type.struct_decl;
                 } else {
                     struct_decl = root.type->type.struct_decl;
                 }
@@ -1844,20 +1665,25 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             }
             assert(found);
 
+            ResolvedType* field_type = found->type;
+
             // TODO: generalize this
-            if (found->type->kind == RTK_POINTER && found->type->type.ptr.of->kind == RTK_GENERIC) {
+            if (field_type->kind == RTK_POINTER && field_type->type.ptr.of->kind == RTK_GENERIC) {
                 assert(maybe_struct_ref);
                 assert(maybe_struct_ref->generic_args.length == 1);
-                // assert(maybe_struct_ref->generic_args.resolved_types->kind != RTK_GENERIC);
-                println_astnode(*maybe_struct_ref->generic_args.resolved_types->src);
+                // assert(maybe_struct_ref->generic_args.resolved_types[0]->kind != RTK_GENERIC);
+                if (log_dumps(LOG_DUMP_GENERICS) && maybe_struct_ref->generic_args.resolved_types[0]->src) {
+                    println_astnode(*maybe_struct_ref->generic_args.resolved_types[0]->src);
+                }
 
-                found->type->type.ptr.of = maybe_struct_ref->generic_args.resolved_types;
+                // field types are shared, so substitute rather than patching the decl
+                field_type = resolved_type_pointer(&type_resolver->packages->type_table, RTK_POINTER, maybe_struct_ref->generic_args.resolved_types[0]);
                 // assert(false);
             }
 
             type_resolver->packages->types[node->id.val] = (TypeInfo){
                 .status = root.status,
-                .type = found->type,
+                .type = field_type,
             };
             changed = true;
 
@@ -1899,6 +1725,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 assert(fn_rt->kind == RTK_FUNCTION_DECL || fn_rt->kind == RTK_FUNCTION_REF);
                 assert(fn_rt->kind == RTK_FUNCTION_DECL);
 
+                ResolvedType** generic_resolved_types = NULL;
                 if (fn_rt->type.function_decl.generic_params.length > 0) {
                     assert(node->node.function_call.generic_args.length <= fn_rt->type.function_decl.generic_params.length);
 
@@ -1918,15 +1745,13 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                             ResolvedType* gen_arg_rt = calc_resolved_type(type_resolver, scope, &curr->data);
                             assert(gen_arg_rt);
 
-                            gen_arg_rt->src = node;
-
                             resolved_types[i] = gen_arg_rt;
 
                             i += 1;
                             curr = curr->next;
                         }
 
-                        packages_register_generic_impl(type_resolver->packages, fn_rt->src, node->node.function_call.generic_args.length, resolved_types);
+                        generic_resolved_types = resolved_types;
                     }
                 } else {
                     assert(node->node.function_call.generic_args.length == 0);
@@ -1946,7 +1771,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                             .decl = fn_rt->type.function_decl,
                             .generic_args = {
                                 .length = 0,
-                                .resolved_types = arena_calloc(type_resolver->arena, node->node.function_call.generic_args.length, sizeof(ResolvedType)),
+                                .resolved_types = arena_calloc(type_resolver->arena, node->node.function_call.generic_args.length, sizeof(ResolvedType*)),
                             },
                             .impl_version = 0,
                         },
@@ -1959,29 +1784,20 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                         assert(generic_arg);
 
                         assert(fn_rt->type.function_ref.generic_args.length < node->node.function_call.generic_args.length);
-                        fn_rt->type.function_ref.generic_args.resolved_types[fn_rt->type.function_ref.generic_args.length++] = *generic_arg;
+                        fn_rt->type.function_ref.generic_args.resolved_types[fn_rt->type.function_ref.generic_args.length++] = generic_arg;
 
                         curr = curr->next;
                     }
                     assert(fn_rt->type.function_ref.generic_args.length == node->node.function_call.generic_args.length);
 
-                    ArrayList_LL_Type* generic_impls = &fn_rt->src->node.function_decl.header.generic_impls;
-
-                    bool already_has_decl = false;
-                    for (size_t i = 0; i < generic_impls->length; ++i) {
-                        if (typells_eq(generic_impls->array[i], node->node.function_call.generic_args)) {
-                            already_has_decl = true;
-                            node->node.function_call.impl_version = i;
-                            fn_rt->type.function_ref.impl_version = i;
-                            break;
-                        }
-                    }
-
-                    if (!already_has_decl) {
-                        node->node.function_call.impl_version = generic_impls->length;
-                        fn_rt->type.function_ref.impl_version = generic_impls->length;
-                        arraylist_typells_push(generic_impls, node->node.function_call.generic_args);
-                    }
+                    use_generic_decl(type_resolver, (GenericUse){
+                        .decl = fn_rt->src,
+                        .generic_args = node->node.function_call.generic_args,
+                        .resolved_types_length = node->node.function_call.generic_args.length,
+                        .resolved_types = generic_resolved_types,
+                        .impl_version = &node->node.function_call.impl_version,
+                        .ref_impl_version = &fn_rt->type.function_ref.impl_version,
+                    });
                 } else if (fn_rt->kind == RTK_FUNCTION_DECL) {
                     ResolvedType* new_fn_rt = arena_alloc(type_resolver->arena, sizeof *fn_rt);
                     *new_fn_rt = (ResolvedType){
@@ -1998,15 +1814,13 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
 
                 bool confident_args = true;
-                LLNode_ASTNode* curr = node->node.function_call.args.head;
-                while (curr) {
-                    changed |= resolve_type_node(type_resolver, scope, &curr->data);
+                for (size_t i = 0; i < node->node.function_call.args.length; ++i) {
+                    ASTNode* curr = node->node.function_call.args.array + i;
+                    changed |= resolve_type_node(type_resolver, scope, curr);
 
-                    if (type_resolver->packages->types[curr->data.id.val].status != TIS_CONFIDENT) {
+                    if (type_resolver->packages->types[curr->id.val].status != TIS_CONFIDENT) {
                         confident_args = false;
                     }
-                    
-                    curr = curr->next;
                 }
                 if (!confident_args) {
                     break;
@@ -2016,7 +1830,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 if (type->kind == RTK_GENERIC) {
                     assert(fn_rt->type.function_ref.generic_args.length > 0);
                     assert(fn_rt->type.function_ref.generic_args.length > type->type.generic.idx);
-                    type = &fn_rt->type.function_ref.generic_args.resolved_types[type->type.generic.idx];
+                    type = fn_rt->type.function_ref.generic_args.resolved_types[type->type.generic.idx];
                 }
                 
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
@@ -2030,25 +1844,18 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         }
 
         case ANT_STATEMENT_BLOCK: {
-            Scope block_scope = scope_create(type_resolver->arena, scope);
-            LLNode_ASTNode* curr = node->node.statement_block.stmts.head;
+            Scope block_scope = scope_create(type_resolver, scope);
             bool resolved = true;
-            while (curr) {
-                changed |= resolve_type_node(type_resolver, &block_scope, &curr->data);
-                if (!type_resolver->packages->types[curr->data.id.val].type) {
+            for (size_t i = 0; i < node->node.statement_block.stmts.length; ++i) {
+                ASTNode* curr = node->node.statement_block.stmts.array + i;
+                changed |= resolve_type_node(type_resolver, &block_scope, curr);
+                if (!type_resolver->packages->types[curr->id.val].type) {
                     resolved = false;
                 }
-                curr = curr->next;
             }
 
             if (resolved) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = (ResolvedType){
-                    .src = node,
-                    .from_pkg = type_resolver->current_package,
-                    .kind = RTK_VOID,
-                    .type.void_ = NULL,
-                };
+                ResolvedType* rt = primitive_type(type_resolver, RTK_VOID);
 
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = TIS_CONFIDENT,
@@ -2088,14 +1895,13 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             }
 
             {
-                Scope block_scope = scope_create(type_resolver->arena, scope);
-                LLNode_ASTNode* curr = node->node.if_.block->stmts.head;
-                while (curr) {
-                    changed |= resolve_type_node(type_resolver, &block_scope, &curr->data);
-                    if (!type_resolver->packages->types[curr->data.id.val].type) {
+                Scope block_scope = scope_create(type_resolver, scope);
+                for (size_t i = 0; i < node->node.if_.block->stmts.length; ++i) {
+                    ASTNode* curr = node->node.if_.block->stmts.array + i;
+                    changed |= resolve_type_node(type_resolver, &block_scope, curr);
+                    if (!type_resolver->packages->types[curr->id.val].type) {
                         resolved = false;
                     }
-                    curr = curr->next;
                 }
             }
 
@@ -2107,10 +1913,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             }
 
             if (resolved) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = (ResolvedType){
-                    .kind = RTK_VOID,
-                };
+                ResolvedType* rt = primitive_type(type_resolver, RTK_VOID);
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .type = rt,
                 };
@@ -2148,28 +1951,19 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 resolved = false;
             }
 
-            Scope block_scope = scope_create(type_resolver->arena, scope);
-            ResolvedType* i_rt = arena_alloc(type_resolver->arena, sizeof *i_rt);
-            i_rt->kind = type_resolver->packages->range_literal_type->type.struct_decl.fields[0].type->kind;
-            i_rt->type = type_resolver->packages->range_literal_type->type.struct_decl.fields[0].type->type;
-            i_rt->src = node;
-            i_rt->from_pkg = type_resolver->current_package;
-            scope_set(&block_scope, node->node.foreach.var.lhs.name, i_rt);
-            LLNode_ASTNode* curr = node->node.foreach.block->stmts.head;
-            while (curr) {
-                changed |= resolve_type_node(type_resolver, &block_scope, &curr->data);
-                if (!type_resolver->packages->types[curr->data.id.val].type) {
+            Scope block_scope = scope_create(type_resolver, scope);
+            ResolvedType* i_rt = type_resolver->packages->range_literal_type->type.struct_decl.fields[0].type;
+            scope_set(&block_scope, intern(node->node.foreach.var.lhs.name), i_rt);
+            for (size_t i = 0; i < node->node.foreach.block->stmts.length; ++i) {
+                ASTNode* curr = node->node.foreach.block->stmts.array + i;
+                changed |= resolve_type_node(type_resolver, &block_scope, curr);
+                if (!type_resolver->packages->types[curr->id.val].type) {
                     resolved = false;
                 }
-                curr = curr->next;
             }
 
             if (resolved) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = (ResolvedType){
-                    .from_pkg = type_resolver->current_package,
-                    .kind = RTK_VOID,
-                };
+                ResolvedType* rt = primitive_type(type_resolver, RTK_VOID);
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .type = rt,
                 };
@@ -2206,22 +2000,17 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 resolved = false;
             }
 
-            Scope block_scope = scope_create(type_resolver->arena, scope);
-            LLNode_ASTNode* curr = node->node.while_.block->stmts.head;
-            while (curr) {
-                changed |= resolve_type_node(type_resolver, &block_scope, &curr->data);
-                if (!type_resolver->packages->types[curr->data.id.val].type) {
+            Scope block_scope = scope_create(type_resolver, scope);
+            for (size_t i = 0; i < node->node.while_.block->stmts.length; ++i) {
+                ASTNode* curr = node->node.while_.block->stmts.array + i;
+                changed |= resolve_type_node(type_resolver, &block_scope, curr);
+                if (!type_resolver->packages->types[curr->id.val].type) {
                     resolved = false;
                 }
-                curr = curr->next;
             }
 
             if (resolved) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = (ResolvedType){
-                    .from_pkg = type_resolver->current_package,
-                    .kind = RTK_VOID,
-                };
+                ResolvedType* rt = primitive_type(type_resolver, RTK_VOID);
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .type = rt,
                 };
@@ -2279,11 +2068,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             } else {
                 assert(type_resolver->current_function->return_type->kind == RTK_VOID);
 
-                ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-                resolved_type->from_pkg = type_resolver->current_package;
-                resolved_type->src = node;
-                resolved_type->kind = RTK_VOID;
-                resolved_type->type.void_ = NULL;
+                ResolvedType* resolved_type = primitive_type(type_resolver, RTK_VOID);
 
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = TIS_CONFIDENT,
@@ -2395,17 +2180,14 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             }
 
             if (resolved) {
-                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                *rt = (ResolvedType){
-                    .from_pkg = type_resolver->current_package,
-                    .src = node,
+                ResolvedType* rt = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
                     .kind = RTK_ARRAY,
                     .type.array = {
                         .has_explicit_length = false, // TODO
                         .explicit_length = 0, // TODO
                         .of = of,
                     },
-                };
+                });
 
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = TIS_CONFIDENT,
@@ -2420,15 +2202,13 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         case ANT_TEMPLATE_STRING: {
             bool resolved = true;
 
-            LLNode_ASTNode* curr = node->node.template_string.template_expr_parts.head;
-            while (curr) {
-                changed |= resolve_type_node(type_resolver, scope, &curr->data);
+            for (size_t i = 0; i < node->node.template_string.template_expr_parts.length; ++i) {
+                ASTNode* curr = node->node.template_string.template_expr_parts.array + i;
+                changed |= resolve_type_node(type_resolver, scope, curr);
 
-                if (!type_resolver->packages->types[curr->data.id.val].type) {
+                if (!type_resolver->packages->types[curr->id.val].type) {
                     resolved = false;
                 }
-                
-                curr = curr->next;
             }
 
             if (resolved) {
@@ -2493,11 +2273,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             if (type_resolver->packages->types[node->id.val].status == TIS_CONFIDENT) {
                 break;
             }
-            ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-            resolved_type->from_pkg = type_resolver->current_package;
-            resolved_type->src = node;
-            resolved_type->kind = RTK_UINT;
-            resolved_type->type.uint_ = NULL;
+            ResolvedType* resolved_type = primitive_type(type_resolver, RTK_UINT);
 
             type_resolver->packages->types[node->id.val] = (TypeInfo){
                 .status = TIS_CONFIDENT,
@@ -2533,35 +2309,38 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         }
 
         case ANT_STRUCT_DECL: {
-            assert(node->node.struct_decl.maybe_name); // TODO
+            assert(node->node.struct_decl->maybe_name); // TODO
 
-            // if (str_eq(*node->node.struct_decl.maybe_name, c_str("Maybe"))) {
+            // if (str_eq(*node->node.struct_decl->maybe_name, c_str("Maybe"))) {
             //     static int x = 0;
             //     int y = x++;
             //     assert(y == 0);
             // }
 
-            ResolvedStructField* fields = arena_calloc(type_resolver->arena, node->node.struct_decl.fields.length, sizeof *fields);
+            ResolvedStructField* fields = arena_calloc(type_resolver->arena, node->node.struct_decl->fields.length, sizeof *fields);
 
             Strings generic_params = {
-                .length = node->node.struct_decl.generic_params.length,
-                .strings = node->node.struct_decl.generic_params.array,
+                .length = node->node.struct_decl->generic_params.length,
+                .strings = node->node.struct_decl->generic_params.array,
             };
 
-            Scope fields_scope = scope_create(type_resolver->arena, scope);
+            Scope fields_scope = scope_create(type_resolver, scope);
             for (size_t i = 0; i < generic_params.length; ++i) {
-                ResolvedType* generic_rt = arena_alloc(type_resolver->arena, sizeof *generic_rt);
-                generic_rt->from_pkg = type_resolver->current_package;
-                generic_rt->src = node;
-                generic_rt->kind = RTK_GENERIC;
-                generic_rt->type.generic.idx = i;
-                generic_rt->type.generic.name = generic_params.strings[i];
+                ResolvedType* generic_rt = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
+                    .from_pkg = type_resolver->current_package,
+                    .src = node,
+                    .kind = RTK_GENERIC,
+                    .type.generic = {
+                        .name = generic_params.strings[i],
+                        .idx = i,
+                    },
+                });
 
-                scope_set(&fields_scope, generic_params.strings[i], generic_rt);
+                scope_set(&fields_scope, intern(generic_params.strings[i]), generic_rt);
             }
 
             size_t i = 0;
-            LLNode_StructField* curr = node->node.struct_decl.fields.head;
+            LLNode_StructField* curr = node->node.struct_decl->fields.head;
             while (curr) {
                 ResolvedType* resolved_type = calc_resolved_type(type_resolver, &fields_scope, curr->data.type);
                 if (!resolved_type) {
@@ -2576,46 +2355,47 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 i += 1;
                 curr = curr->next;
             }
-            if (i < node->node.struct_decl.fields.length) {
+            if (i < node->node.struct_decl->fields.length) {
                 break;
             }
 
-            ResolvedType* resolved_type = arena_alloc(type_resolver->arena, sizeof *resolved_type);
-            resolved_type->from_pkg = type_resolver->current_package;
-            resolved_type->src = node;
-            resolved_type->kind = RTK_STRUCT_DECL;
-            resolved_type->type.struct_decl = (ResolvedStructDecl){
-                .name = *node->node.struct_decl.maybe_name,
-                .generic_params = generic_params,
-                .fields_length = node->node.struct_decl.fields.length,
-                .fields = fields,
-            };
+            ResolvedType* resolved_type = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
+                .from_pkg = type_resolver->current_package,
+                .src = node,
+                .kind = RTK_STRUCT_DECL,
+                .type.struct_decl = {
+                    .name = *node->node.struct_decl->maybe_name,
+                    .generic_params = generic_params,
+                    .fields_length = node->node.struct_decl->fields.length,
+                    .fields = fields,
+                },
+            });
 
             type_resolver->packages->types[node->id.val] = (TypeInfo){
                 .status = TIS_CONFIDENT,
                 .type = resolved_type,
             };
-            scope_set(scope, *node->node.struct_decl.maybe_name, resolved_type);
+            scope_set(scope, intern(*node->node.struct_decl->maybe_name), resolved_type);
             changed = true;
 
             if (node->directives.length > 0) {
                 LLNode_Directive* curr = node->directives.head;
                 while (curr) {
                     if (curr->data.type == DT_STRING_LITERAL) {
-                        assert(node->node.struct_decl.fields.length >= 2);
+                        assert(node->node.struct_decl->fields.length >= 2);
                         assert(fields[0].type->kind == RTK_UINT);
                         assert(fields[1].type->kind == RTK_POINTER);
                         assert(fields[1].type->type.ptr.of->kind == RTK_CHAR);
                         type_resolver->packages->string_literal_type = resolved_type;
                     } else if (curr->data.type == DT_STRING_TEMPLATE) {
-                        assert(node->node.struct_decl.fields.length >= 3);
+                        assert(node->node.struct_decl->fields.length >= 3);
                         assert(fields[0].type->kind == RTK_UINT);
                         assert(fields[1].type->kind == RTK_UINT);
                         assert(fields[2].type->kind == RTK_POINTER);
                         assert(fields[2].type->type.ptr.of->kind == RTK_CHAR);
                         type_resolver->packages->string_template_type = resolved_type;
                     } else if (curr->data.type == DT_RANGE_LITERAL) {
-                        assert(node->node.struct_decl.fields.length >= 3);
+                        assert(node->node.struct_decl->fields.length >= 3);
                         assert(fields[0].type->kind == RTK_INT);
                         assert(fields[1].type->kind == RTK_INT);
                         assert(fields[2].type->kind == RTK_BOOL);
@@ -2635,7 +2415,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             changed |= resolve_type_type(type_resolver, scope, node, node->node.typedef_decl.type);
 
             if (type_resolver->packages->types[node->id.val].type) {
-                scope_set(scope, node->node.typedef_decl.name, type_resolver->packages->types[node->id.val].type);
+                scope_set(scope, intern(node->node.typedef_decl.name), type_resolver->packages->types[node->id.val].type);
             }
             break;
         }
@@ -2643,8 +2423,8 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         case ANT_GLOBALTAG_DECL: assert(false); // TODO
 
         case ANT_FUNCTION_HEADER_DECL: {
-            ResolvedFunctionParam* params = arena_calloc(type_resolver->arena, node->node.function_header_decl.params.length, sizeof *params);
-            LLNode_FnParam* param = node->node.function_header_decl.params.head;
+            ResolvedFunctionParam* params = arena_calloc(type_resolver->arena, node->node.function_header_decl->params.length, sizeof *params);
+            LLNode_FnParam* param = node->node.function_header_decl->params.head;
             size_t i = 0;
             while (param) {
                 ResolvedType* param_type = calc_resolved_type(type_resolver, scope, &param->data.type);
@@ -2659,11 +2439,11 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 param = param->next;
                 i += 1;
             }
-            if (i < node->node.function_header_decl.params.length) {
+            if (i < node->node.function_header_decl->params.length) {
                 break;
             }
 
-            ResolvedType* return_type = calc_resolved_type(type_resolver, scope, (Type*)&node->node.function_header_decl.return_type);
+            ResolvedType* return_type = calc_resolved_type(type_resolver, scope, (Type*)&node->node.function_header_decl->return_type);
             if (!return_type) {
                 break;
             }
@@ -2674,7 +2454,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 .src = node,
                 .kind = RTK_FUNCTION_DECL,
                 .type.function_decl = {
-                    .params_length = node->node.function_decl.header.params.length,
+                    .params_length = node->node.function_decl->header.params.length,
                     .params = params,
                     .return_type = return_type,
                 },
@@ -2687,7 +2467,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
             changed = true;
 
             // TODO: handle cross-checking forward decl.
-            scope_set(scope, node->node.function_header_decl.name, resolved_type);
+            scope_set(scope, intern(node->node.function_header_decl->name), resolved_type);
 
             break;
         }
@@ -2695,24 +2475,27 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         case ANT_FUNCTION_DECL: {
             // if (type_resolver->packages->types[node->id.val].status != TIS_CONFIDENT) {
                 Strings generic_params = {
-                    .length = node->node.function_decl.header.generic_params.length,
-                    .strings = node->node.function_decl.header.generic_params.array,
+                    .length = node->node.function_decl->header.generic_params.length,
+                    .strings = node->node.function_decl->header.generic_params.array,
                 };
 
-                Scope signature_scope = scope_create(type_resolver->arena, scope);
+                Scope signature_scope = scope_create(type_resolver, scope);
                 for (size_t i = 0; i < generic_params.length; ++i) {
-                    ResolvedType* generic_rt = arena_alloc(type_resolver->arena, sizeof *generic_rt);
-                    generic_rt->from_pkg = type_resolver->current_package;
-                    generic_rt->src = node;
-                    generic_rt->kind = RTK_GENERIC;
-                    generic_rt->type.generic.idx = i;
-                    generic_rt->type.generic.name = generic_params.strings[i];
-
-                    scope_set(&signature_scope, generic_params.strings[i], generic_rt);
+                    ResolvedType* generic_rt = resolved_type_intern(&type_resolver->packages->type_table, (ResolvedType){
+                        .from_pkg = type_resolver->current_package,
+                        .src = node,
+                        .kind = RTK_GENERIC,
+                        .type.generic = {
+                            .name = generic_params.strings[i],
+                            .idx = i,
+                        },
+                    });
+
+                    scope_set(&signature_scope, intern(generic_params.strings[i]), generic_rt);
                 }
 
-                ResolvedFunctionParam* params = arena_calloc(type_resolver->arena, node->node.function_decl.header.params.length, sizeof *params);
-                LLNode_FnParam* param = node->node.function_decl.header.params.head;
+                ResolvedFunctionParam* params = arena_calloc(type_resolver->arena, node->node.function_decl->header.params.length, sizeof *params);
+                LLNode_FnParam* param = node->node.function_decl->header.params.head;
                 size_t i = 0;
                 while (param) {
                     ResolvedType* param_type = calc_resolved_type(type_resolver, &signature_scope, &param->data.type);
@@ -2731,15 +2514,15 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                     param = param->next;
                     i += 1;
                 }
-                if (i < node->node.function_decl.header.params.length) {
+                if (i < node->node.function_decl->header.params.length) {
                     break;
                 }
 
-                ResolvedType* return_type = calc_resolved_type(type_resolver, &signature_scope, &node->node.function_decl.header.return_type);
+                ResolvedType* return_type = calc_resolved_type(type_resolver, &signature_scope, &node->node.function_decl->header.return_type);
                 if (!return_type) {
                     break;
                 }
-                *packages_type_by_type(type_resolver->packages, node->node.function_decl.header.return_type.id) = (TypeInfo){
+                *packages_type_by_type(type_resolver->packages, node->node.function_decl->header.return_type.id) = (TypeInfo){
                     .status = TIS_CONFIDENT,
                     .type = return_type,
                 };
@@ -2751,7 +2534,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                     .kind = RTK_FUNCTION_DECL,
                     .type.function_decl = {
                         .generic_params = generic_params,
-                        .params_length = node->node.function_decl.header.params.length,
+                        .params_length = node->node.function_decl->header.params.length,
                         .params = params,
                         .return_type = return_type,
                     },
@@ -2764,7 +2547,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 changed = true;
 
                 // TODO: handle cross-checking forward decl.
-                scope_set(scope, node->node.function_header_decl.name, resolved_type);
+                scope_set(scope, intern(node->node.function_header_decl->name), resolved_type);
             // }
 
             ResolvedType* fn_type = type_resolver->packages->types[node->id.val].type;
@@ -2773,20 +2556,19 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
 
             type_resolver->current_function = &fn_type->type.function_decl;
 
-            Scope block_scope = scope_create(type_resolver->arena, &signature_scope);
+            Scope block_scope = scope_create(type_resolver, &signature_scope);
 
             // Add fn params to block scope
             for (size_t i = 0; i < fn_type->type.function_decl.params_length; ++i) {
                 ResolvedFunctionParam param = fn_type->type.function_decl.params[i];
-                scope_set(&block_scope, param.name, param.type);
+                scope_set(&block_scope, intern(param.name), param.type);
             }
 
-            LLNode_ASTNode* curr = node->node.function_decl.stmts.head;
-            while (curr) {
-                // if (type_resolver->packages->types[curr->data.id.val].status != TIS_CONFIDENT) {
-                    changed |= resolve_type_node(type_resolver, &block_scope, &curr->data);
+            for (size_t i = 0; i < node->node.function_decl->stmts.length; ++i) {
+                ASTNode* curr = node->node.function_decl->stmts.array + i;
+                // if (type_resolver->packages->types[curr->id.val].status != TIS_CONFIDENT) {
+                    changed |= resolve_type_node(type_resolver, &block_scope, curr);
                 // }
-                curr = curr->next;
             }
 
             type_resolver->current_function = NULL;
@@ -2803,17 +2585,8 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                         LLNode_Directive* curr = node->directives.head;
                         while (curr) {
                             if (curr->data.type == DT_C_STR) {
-                                ResolvedType* rt_char = arena_alloc(type_resolver->arena, sizeof *rt_char);
-                                rt_char->src = node;
-                                rt_char->from_pkg = type_resolver->current_package;
-                                rt_char->kind = RTK_CHAR;
-                                rt_char->type.char_ = NULL;
-
-                                ResolvedType* rt = arena_alloc(type_resolver->arena, sizeof *rt);
-                                rt->src = node;
-                                rt->from_pkg = type_resolver->current_package;
-                                rt->kind = RTK_POINTER;
-                                rt->type.ptr.of = rt_char;
+                                ResolvedType* rt_char = primitive_type(type_resolver, RTK_CHAR);
+                                ResolvedType* rt = resolved_type_pointer(&type_resolver->packages->type_table, RTK_POINTER, rt_char);
                                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                                     .status = TIS_CONFIDENT,
                                     .type = rt,
@@ -2838,11 +2611,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
 
                 case LK_CHAR: {
-                    ResolvedType* type = arena_alloc(type_resolver->arena, sizeof *type);
-                    type->src = node;
-                    type->from_pkg = type_resolver->current_package;
-                    type->kind = RTK_CHAR;
-                    type->type.char_ = NULL;
+                    ResolvedType* type = primitive_type(type_resolver, RTK_CHAR);
 
                     type_resolver->packages->types[node->id.val] = (TypeInfo){
                         .status = TIS_CONFIDENT,
@@ -2852,11 +2621,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
 
                 case LK_INT: {
-                    ResolvedType* type = arena_alloc(type_resolver->arena, sizeof *type);
-                    type->src = node;
-                    type->from_pkg = type_resolver->current_package;
-                    type->kind = RTK_INT;
-                    type->type.int_ = NULL;
+                    ResolvedType* type = primitive_type(type_resolver, RTK_INT);
 
                     type_resolver->packages->types[node->id.val] = (TypeInfo){
                         .status = TIS_CONFIDENT,
@@ -2866,11 +2631,7 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 }
 
                 case LK_BOOL: {
-                    ResolvedType* type = arena_alloc(type_resolver->arena, sizeof *type);
-                    type->src = node;
-                    type->from_pkg = type_resolver->current_package;
-                    type->kind = RTK_BOOL;
-                    type->type.bool_ = NULL;
+                    ResolvedType* type = primitive_type(type_resolver, RTK_BOOL);
 
                     type_resolver->packages->types[node->id.val] = (TypeInfo){
                         .status = TIS_CONFIDENT,
@@ -2899,11 +2660,13 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
                 .generic_args = {0},
                 .impl_version = 0,
             };
-            ResolvedType* resolved_type = calc_static_path_type(type_resolver, scope, &t_path);
+            Package* namespace_ = NULL;
+            ResolvedType* resolved_type = calc_static_path_type(type_resolver, scope, &t_path, &namespace_);
             if (resolved_type) {
                 type_resolver->packages->types[node->id.val] = (TypeInfo){
                     .status = TIS_CONFIDENT,
                     .type = resolved_type,
+                    .namespace_ = namespace_,
                 };
                 changed = true;
             } 
@@ -2973,26 +2736,81 @@ static Changed resolve_type_node(TypeResolver* type_resolver, Scope* scope, ASTN
         default: printf("TODO: ANT_%d\n", node->type); assert(false);
     }
 
+    if (!type_resolver->packages->types[node->id.val].type) {
+        type_resolver->untyped_nodes += 1;
+    }
+
     return changed && !already_known;
 }
 
 static void resolve_file(TypeResolver* type_resolver, Scope* scope, ASTNodeFileRoot file) {
-    Changed changed;
-    do {
-        changed = false;
+    Worklist worklist = worklist_create(type_resolver->arena, file.nodes.length);
+    for (size_t i = 0; i < file.nodes.length; ++i) {
+        worklist_push(&worklist, i, 1);
+    }
 
-        LLNode_ASTNode* curr = file.nodes.head;
-        while (curr) {
-            changed |= resolve_type_node(type_resolver, scope, &curr->data);
-            curr = curr->next;
+    scope->worklist = &worklist;
+    type_resolver->worklist = &worklist;
+
+    size_t visits = 0;
+    size_t passes = 0;
+
+    // whether any visit changed something since stalled decls were last retried
+    bool progressed = false;
+
+    size_t idx;
+    while (true) {
+        if (!worklist_pop(&worklist, &idx)) {
+            // stalled decls are woken when a symbol is bound, but types filled in
+            // elsewhere can unstall them too, so retry them while anything changes
+            if (!progressed || worklist.stalled_length == 0) {
+                break;
+            }
+            progressed = false;
+
+            for (size_t i = 0; i < worklist.stalled_length; ++i) {
+                worklist_push(&worklist, worklist.stalled[i], passes + 1);
+            }
+            worklist.stalled_length = 0;
+            continue;
+        }
+
+        ASTNode* curr = file.nodes.array + idx;
+
+        worklist.current = idx;
+        worklist.generations[idx] += 1;
+        worklist.misses_length = 0;
+        type_resolver->untyped_nodes = 0;
+
+        progressed |= resolve_type_node(type_resolver, scope, curr);
+        visits += 1;
+
+        if (worklist.rounds[idx] > passes) {
+            passes = worklist.rounds[idx];
         }
-    } while (changed);
+
+        if (worklist.misses_length > 0) {
+            worklist_park(&worklist, idx);
+        } else if (type_resolver->untyped_nodes > 0) {
+            worklist_stall(&worklist, idx);
+        }
+    }
+
+    scope->worklist = NULL;
+    type_resolver->worklist = NULL;
+
+    // the fixed-point loop re-walked every decl each pass, plus a final pass where nothing changed
+    size_t worklist_passes = file.nodes.length > 0 ? (visits + file.nodes.length - 1) / file.nodes.length : 0;
+    type_resolver->decl_visits += visits;
+    if (passes + 1 > worklist_passes) {
+        type_resolver->passes_saved += passes + 1 - worklist_passes;
+    }
 
     // Ensure all types resolved
     bool requires_type;
-    LLNode_ASTNode* curr = file.nodes.head;
-    while (curr) {
-        switch (curr->data.type) {
+    for (size_t i = 0; i < file.nodes.length; ++i) {
+        ASTNode* curr = file.nodes.array + i;
+        switch (curr->type) {
             case ANT_FILE_ROOT:
             case ANT_FILE_SEPARATOR:
             case ANT_PACKAGE:
@@ -3005,12 +2823,10 @@ static void resolve_file(TypeResolver* type_resolver, Scope* scope, ASTNodeFileR
         }
 
         if (requires_type) {
-            if (!type_resolver->packages->types[curr->data.id.val].type) {
-                println_astnode(curr->data);
+            if (!type_resolver->packages->types[curr->id.val].type) {
+                println_astnode(*curr);
             }
-            assert(type_resolver->packages->types[curr->data.id.val].type);
+            assert(type_resolver->packages->types[curr->id.val].type);
         }
-
-        curr = curr->next;
     }
 }
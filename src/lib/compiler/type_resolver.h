@@ -5,17 +5,42 @@
 #include "./resolved_type.h"
 #include "../utils/utils.h"
 
+struct Worklist;
+struct GenericUses;
+
+// Packages in the same level of the dependency graph are resolved on
+// `jobs` threads, each allocating into its own arena. Uses of generic
+// decls are deferred while a level runs and registered afterwards in
+// resolve order, so impl versions come out the same as resolving serially.
 typedef struct {
     Arena* arena;
     Packages* packages;
 
+    size_t jobs;
+    Arena* worker_arenas;
+
+    // set while resolving a package in parallel
+    struct GenericUses* deferred_generic_uses;
+
     Package* current_package;
     ResolvedFunctionDecl* current_function;
     bool seen_separator;
+
+    struct Worklist* worklist;
+    size_t untyped_nodes;
+
+    // only used to print scopes, counted per worker
+    size_t next_scope_id;
+
+    size_t nodes_visited;
+    size_t decl_visits;
+    size_t passes_saved;
 } TypeResolver;
 
-TypeResolver type_resolver_create(Arena* arena, Packages* packages);
+TypeResolver type_resolver_create(Arena* arena, Packages* packages, size_t jobs);
 
 void resolve_types(TypeResolver* type_resolver);
 
+void type_resolver_free(TypeResolver* type_resolver);
+
 #endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./file_writer.h"
+
+void file_writer_open(FileWriter* writer, String path, FILE* echo) {
+    writer->path = path.chars;
+    writer->file = fopen(path.chars, "wb");
+    if (writer->file == NULL) {
+        fprintf(stderr, "Could not open file \"%s\".\n", path.chars);
+        exit(74);
+    }
+
+    writer->echo = echo;
+    writer->last = '\0';
+    writer->length = 0;
+
+    if (echo) {
+        fprintf(echo, "// \"%s\"\n", path.chars);
+    }
+}
+
+static void file_writer_flush(FileWriter* writer) {
+    if (writer->length == 0) {
+        return;
+    }
+
+    if (fwrite(writer->buffer, sizeof(char), writer->length, writer->file) != writer->length) {
+        fprintf(stderr, "Could not write file \"%s\".\n", writer->path);
+        exit(74);
+    }
+    if (writer->echo) {
+        fwrite(writer->buffer, sizeof(char), writer->length, writer->echo);
+    }
+
+    writer->length = 0;
+}
+
+static void file_writer_write(FileWriter* writer, char const* bytes, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    writer->last = bytes[length - 1];
+
+    while (length > 0) {
+        if (writer->length == FILE_WRITER_BUFFER_SIZE) {
+            file_writer_flush(writer);
+        }
+
+        size_t n = FILE_WRITER_BUFFER_SIZE - writer->length;
+        if (n > length) {
+            n = length;
+        }
+
+        memcpy(writer->buffer + writer->length, bytes, n);
+        writer->length += n;
+        bytes += n;
+        length -= n;
+    }
+}
+
+void file_writer_write_char(FileWriter* writer, char const c) {
+    file_writer_write(writer, &c, 1);
+}
+
+void file_writer_write_chars(FileWriter* writer, char const* chars) {
+    file_writer_write(writer, chars, strlen(chars));
+}
+
+void file_writer_write_str(FileWriter* writer, String const str) {
+    file_writer_write(writer, str.chars, str.length);
+}
+
+void file_writer_close(FileWriter* writer) {
+    file_writer_flush(writer);
+
+    if (fclose(writer->file) != 0) {
+        fprintf(stderr, "Could not write file \"%s\".\n", writer->path);
+        exit(74);
+    }
+    writer->file = NULL;
+
+    if (writer->echo) {
+        fprintf(writer->echo, "\n");
+    }
+}
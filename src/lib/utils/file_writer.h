@@ -0,0 +1,36 @@
+#ifndef quill_file_writer_h
+#define quill_file_writer_h
+
+#include <stdio.h>
+
+#include "./base.h"
+#include "./string.h"
+
+#define FILE_WRITER_BUFFER_SIZE (64 * 1024)
+
+// Writes into a file through a fixed-size buffer, so output of any size
+// never has to be held in memory as a whole.
+typedef struct {
+    char const* path;
+    FILE* file;
+    // optional: everything written is also written here
+    FILE* echo;
+
+    // last byte written, or '\0' if there is none yet
+    char last;
+
+    size_t length;
+    char buffer[FILE_WRITER_BUFFER_SIZE];
+} FileWriter;
+
+// `path` must be NUL-terminated and outlive the writer
+void file_writer_open(FileWriter* writer, String path, FILE* echo);
+
+void file_writer_write_char(FileWriter* writer, char const c);
+void file_writer_write_chars(FileWriter* writer, char const* chars);
+void file_writer_write_str(FileWriter* writer, String const str);
+
+// flushes and closes the file
+void file_writer_close(FileWriter* writer);
+
+#endif
@@ -1,5 +1,7 @@
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include "./utils.h"
 #include "./string_buffer.h"
@@ -50,12 +52,7 @@ void write_file(Arena* arena, String dir, String filepath, String content) {
     strbuf_append_str(&sb, dir);
     strbuf_append_char(&sb, '/');
     strbuf_append_str(&sb, filepath);
-    String path_s = strbuf_to_strcpy(sb);
-
-    printf("// \"%s\"\n", arena_strcpy(arena, path_s).chars);
-    printf("%s\n", arena_strcpy(arena, content).chars);
-
-    char* path = path_s.chars;
+    char* path = strbuf_to_strcpy(sb).chars;
 
     FILE* file = fopen(path, "wb");
     if (file == NULL) {
@@ -64,5 +61,20 @@ void write_file(Arena* arena, String dir, String filepath, String content) {
     }
 
     size_t bytes_written = fwrite(content.chars, sizeof(char), content.length, file);
-    assert(bytes_written == content.length * sizeof(char));
+    if (bytes_written != content.length || fclose(file) != 0) {
+        fprintf(stderr, "Could not write file \"%s\".\n", path);
+        exit(74);
+    }
+}
+
+bool file_exists(String path) {
+    struct stat st;
+    return stat(path.chars, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+void dir_create(String path) {
+    if (mkdir(path.chars, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Could not create directory \"%s\".\n", path.chars);
+        exit(73);
+    }
 }
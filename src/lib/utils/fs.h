@@ -8,4 +8,8 @@
 String file_read(Arena* arena, String path_s);
 void write_file(Arena* arena, String dir, String file, String content);
 
+bool file_exists(String path);
+// creates the directory unless it already exists
+void dir_create(String path);
+
 #endif
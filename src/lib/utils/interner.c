@@ -0,0 +1,173 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "./interner.h"
+#include "./utils.h"
+
+#define FNV32_OFFSET_BASIS 2166136261U
+#define FNV32_PRIME 16777619U
+
+// entries live in fixed pages so readers never see them move
+#define INTERNER_PAGE_BITS 12
+#define INTERNER_PAGE_CAPACITY (1 << INTERNER_PAGE_BITS)
+#define INTERNER_MAX_PAGES 4096
+
+#define INITIAL_INTERNER_SLOTS 1024
+
+typedef struct {
+    String str;
+    uint32_t hash;
+} InternedEntry;
+
+// open-addressed, linear probing; holds symbols, SYMBOL_NONE for empty.
+// A table is filled before it is published and then only gains symbols, so a reader
+// holding an old one sees every symbol that was in it, and misses only newer ones.
+typedef struct {
+    size_t capacity;
+    Symbol* slots;
+} InternerSlots;
+
+// Lookups take no lock: symbols are stored into slots, and tables are published, with
+// release ordering after everything they point to is written, and read with acquire.
+// Only adding a symbol takes the lock.
+typedef struct {
+    pthread_mutex_t lock;
+    Arena arena;
+
+    // symbol - 1 => entry
+    size_t length;
+    InternedEntry* pages[INTERNER_MAX_PAGES];
+
+    InternerSlots* slots;
+} Interner;
+
+static Interner interner = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint32_t hash_chars(String const str) {
+    // FNV-1a
+    uint32_t hash = FNV32_OFFSET_BASIS;
+    for (size_t i = 0; i < str.length; ++i) {
+        hash ^= (uint8_t)str.chars[i];
+        hash *= FNV32_PRIME;
+    }
+    return hash;
+}
+
+static InternedEntry* interner_entry(Symbol const symbol) {
+    size_t const idx = symbol - 1;
+    return interner.pages[idx >> INTERNER_PAGE_BITS] + (idx & (INTERNER_PAGE_CAPACITY - 1));
+}
+
+// slot of str in the table, or the empty slot it would go in.
+// `symbol` is what the slot held when it was read, as another thread may fill it right after.
+static size_t interner_probe(InternerSlots const* const table, String const str, uint32_t const hash, Symbol* const symbol) {
+    size_t slot = hash & (table->capacity - 1);
+
+    while (true) {
+        *symbol = __atomic_load_n(table->slots + slot, __ATOMIC_ACQUIRE);
+        if (*symbol == SYMBOL_NONE) {
+            break;
+        }
+
+        InternedEntry const* const entry = interner_entry(*symbol);
+        if (entry->hash == hash && str_eq(entry->str, str)) {
+            break;
+        }
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+
+    return slot;
+}
+
+static Symbol interner_lookup(String const str, uint32_t const hash) {
+    InternerSlots const* const table = __atomic_load_n(&interner.slots, __ATOMIC_ACQUIRE);
+    if (!table) {
+        return SYMBOL_NONE;
+    }
+
+    Symbol symbol;
+    interner_probe(table, str, hash, &symbol);
+    return symbol;
+}
+
+// called with the lock held
+static void interner_grow(void) {
+    InternerSlots const* const prev = interner.slots;
+
+    InternerSlots* const table = arena_alloc(&interner.arena, sizeof *table);
+    table->capacity = prev ? prev->capacity * 2 : INITIAL_INTERNER_SLOTS;
+    table->slots = arena_calloc(&interner.arena, table->capacity, sizeof *table->slots);
+
+    for (size_t i = 0; prev && i < prev->capacity; ++i) {
+        Symbol const symbol = prev->slots[i];
+        if (symbol == SYMBOL_NONE) {
+            continue;
+        }
+
+        size_t slot = interner_entry(symbol)->hash & (table->capacity - 1);
+        while (table->slots[slot] != SYMBOL_NONE) {
+            slot = (slot + 1) & (table->capacity - 1);
+        }
+        table->slots[slot] = symbol;
+    }
+
+    // the old table stays in the arena for readers still probing it
+    __atomic_store_n(&interner.slots, table, __ATOMIC_RELEASE);
+}
+
+Symbol intern(String const str) {
+    uint32_t const hash = hash_chars(str);
+
+    Symbol symbol = interner_lookup(str, hash);
+    if (symbol != SYMBOL_NONE) {
+        return symbol;
+    }
+
+    pthread_mutex_lock(&interner.lock);
+
+    // keep the load factor under 1/2
+    if (!interner.slots || (interner.length + 1) * 2 > interner.slots->capacity) {
+        interner_grow();
+    }
+
+    // another thread may have added it since the lookup
+    size_t const slot = interner_probe(interner.slots, str, hash, &symbol);
+
+    if (symbol == SYMBOL_NONE) {
+        size_t const idx = interner.length;
+        assert((idx >> INTERNER_PAGE_BITS) < INTERNER_MAX_PAGES);
+
+        InternedEntry** const page = interner.pages + (idx >> INTERNER_PAGE_BITS);
+        if (!*page) {
+            *page = arena_alloc(&interner.arena, INTERNER_PAGE_CAPACITY * sizeof **page);
+        }
+
+        (*page)[idx & (INTERNER_PAGE_CAPACITY - 1)] = (InternedEntry){
+            .str = arena_strcpy(&interner.arena, str),
+            .hash = hash,
+        };
+
+        interner.length += 1;
+        symbol = (Symbol)interner.length;
+        __atomic_store_n(interner.slots->slots + slot, symbol, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&interner.lock);
+
+    return symbol;
+}
+
+Symbol symbol_find(String const str) {
+    return interner_lookup(str, hash_chars(str));
+}
+
+String symbol_str(Symbol const symbol) {
+    assert(symbol != SYMBOL_NONE);
+    return interner_entry(symbol)->str;
+}
+
+uint32_t symbol_hash(Symbol const symbol) {
+    assert(symbol != SYMBOL_NONE);
+    return interner_entry(symbol)->hash;
+}
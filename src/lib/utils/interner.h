@@ -0,0 +1,26 @@
+#ifndef quill_interner_h
+#define quill_interner_h
+
+#include <stdint.h>
+
+#include "./base.h"
+#include "./string.h"
+
+// Dense id for an interned identifier, so names compare as integers.
+// 0 is never handed out and means "no symbol".
+typedef uint32_t Symbol;
+
+#define SYMBOL_NONE ((Symbol)0)
+
+// returns the symbol for str, interning a copy of it if it's new (thread-safe).
+// Only a new str takes a lock.
+Symbol intern(String const str);
+
+// returns the symbol for str if it was interned, otherwise SYMBOL_NONE (thread-safe, lock-free)
+Symbol symbol_find(String const str);
+
+String symbol_str(Symbol const symbol);
+
+uint32_t symbol_hash(Symbol const symbol);
+
+#endif
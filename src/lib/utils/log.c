@@ -0,0 +1,46 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "./log.h"
+
+static struct {
+    LogLevel level;
+    unsigned dumps;
+} log_config = {
+    .level = LOG_NORMAL,
+    .dumps = 0,
+};
+
+void log_configure(LogLevel level, unsigned dumps) {
+    log_config.level = level;
+    log_config.dumps = dumps;
+}
+
+bool log_enabled(LogLevel level) {
+    return level <= log_config.level;
+}
+
+bool log_dumps(LogDump dump) {
+    return (log_config.dumps & dump) != 0;
+}
+
+static void log_vprint(LogLevel level, char const* fmt, va_list args) {
+    if (!log_enabled(level)) {
+        return;
+    }
+    vfprintf(stderr, fmt, args);
+}
+
+void log_info(char const* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_vprint(LOG_NORMAL, fmt, args);
+    va_end(args);
+}
+
+void log_verbose(char const* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_vprint(LOG_VERBOSE, fmt, args);
+    va_end(args);
+}
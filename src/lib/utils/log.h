@@ -0,0 +1,34 @@
+#ifndef quill_log_h
+#define quill_log_h
+
+#include "./base.h"
+
+typedef enum {
+    // errors only
+    LOG_QUIET,
+    // and a summary of the build
+    LOG_NORMAL,
+    // and what each phase did
+    LOG_VERBOSE,
+} LogLevel;
+
+// Dumps of the compiler's data, written to stdout when asked for.
+typedef enum {
+    LOG_DUMP_AST = 1 << 0,
+    LOG_DUMP_C = 1 << 1,
+    LOG_DUMP_GENERICS = 1 << 2,
+} LogDump;
+
+// Configures the process-wide log, before any threads are started.
+// `dumps` is a mask of LogDump.
+void log_configure(LogLevel level, unsigned dumps);
+
+bool log_enabled(LogLevel level);
+bool log_dumps(LogDump dump);
+
+// written to stderr, so stdout is left for dumps
+
+void log_info(char const* fmt, ...);
+void log_verbose(char const* fmt, ...);
+
+#endif
@@ -11,7 +11,10 @@
 #include "./arraylist.h"
 #include "./base.h"
 #include "./error.h"
+#include "./file_writer.h"
 #include "./fs.h"
+#include "./interner.h"
+#include "./log.h"
 #include "./number.h"
 #include "./path.h"
 #include "./string.h"
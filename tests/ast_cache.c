@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/lib/compiler/ast_cache.h"
+#include "../src/lib/compiler/lexer.h"
+#include "../src/lib/compiler/parser.h"
+
+#define assert_true(expr) \
+    if (!(expr)) { fprintf(stderr, "Test failed: \"%s\"\n", test_name); } \
+    assert(expr)
+
+#define assert_eq_u64(expected, actual) \
+    if (expected != actual) { \
+        fprintf(stderr, "Test failed: \"%s\" ... Expected [%lu] but got [%lu] \n", test_name, expected, actual); \
+    } \
+    assert(expected == actual)
+
+static String read_bytes(Arena* const arena, char const* const path) {
+    FILE* file = fopen(path, "rb");
+    assert(file);
+
+    fseek(file, 0, SEEK_END);
+    size_t const length = ftell(file);
+    rewind(file);
+
+    char* chars = arena_alloc(arena, length + 1);
+    assert(fread(chars, sizeof(char), length, file) == length);
+    chars[length] = '\0';
+    fclose(file);
+
+    return (String){ .length = length, .chars = chars };
+}
+
+void test_ast_cache(
+    char const* const test_name,
+    Arena* const arena,
+    String const src
+) {
+    uint64_t const source_hash = 42;
+    String const path = c_str(".bin/ast_cache_test.qlast");
+    String const reloaded_path = c_str(".bin/ast_cache_test_reloaded.qlast");
+
+    Lexer lexer = lexer_create(arena, src);
+    Parser parser = parser_create(arena, &lexer);
+
+    ASTNodeResult const ast_res = parser_parse(&parser);
+    astres_assert(ast_res);
+    assert_true(!parser.had_error);
+
+    ParsedSource parsed = {0};
+    parsed.ast = (ASTNode*)ast_res.res.ast;
+    parsed.node_ids_length = parser.next_node_id;
+    parsed.type_ids_length = parser.next_type_id;
+
+    ast_cache_write(arena, path, source_hash, &parsed);
+
+    ParsedSource stale = {0};
+    assert_true(!ast_cache_load(arena, path, source_hash + 1, &stale));
+
+    ParsedSource loaded = {0};
+    assert_true(ast_cache_load(arena, path, source_hash, &loaded));
+
+    assert_eq_u64(parsed.node_ids_length, loaded.node_ids_length);
+    assert_eq_u64(parsed.type_ids_length, loaded.type_ids_length);
+    assert_true(loaded.package_name != NULL);
+    assert_true(str_eq(loaded.package_name->name, parser.package->node.package.package_path->name));
+
+    ArrayList_ASTNode const nodes = parsed.ast->node.file_root.nodes;
+    ArrayList_ASTNode const loaded_nodes = loaded.ast->node.file_root.nodes;
+    assert_eq_u64(nodes.length, loaded_nodes.length);
+    for (size_t i = 0; i < nodes.length; ++i) {
+        assert_true(nodes.array[i].type == loaded_nodes.array[i].type);
+        assert_eq_u64(nodes.array[i].id.val, loaded_nodes.array[i].id.val);
+    }
+
+    // writing what was loaded gives back the same file
+    ast_cache_write(arena, reloaded_path, source_hash, &loaded);
+
+    String const written = read_bytes(arena, path.chars);
+    String const rewritten = read_bytes(arena, reloaded_path.chars);
+    assert_eq_u64(written.length, rewritten.length);
+    assert_true(memcmp(written.chars, rewritten.chars, written.length) == 0);
+
+    ast_cache_unmap(&loaded);
+    remove(path.chars);
+    remove(reloaded_path.chars);
+}
+
+int main(void) {
+    Arena arena = {0};
+    {
+        test_ast_cache("test small package round trip",
+            &arena,
+            c_str("package demo;\n\nimport std;\n\nstruct Point {\n\tint x,\n\tint y,\n}\n\nint sum(Point p) {\n\treturn p.x + p.y;\n}\n")
+        );
+        arena_free(&arena);
+    }
+
+    return EXIT_SUCCESS;
+}
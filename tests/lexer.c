@@ -53,10 +53,10 @@ void test_lexer(
 int main(void) {
     Arena arena = {0};
     {
-        String src;
+        String src = c_str("void main() {\n\t// no-op\n}\n");
         test_lexer("test empty program",
             &arena,
-            src = c_str("void main() {\n\t// no-op\n}\n"),
+            src,
             (ArrayList_Token){
                 .length = 7,
                 .array = (Token[]){
@@ -109,10 +109,10 @@ int main(void) {
     }
 
     {
-        String src;
+        String src = c_str("import std::io;\n\nvoid main() {\n\tio::println(\"Hello, world!\");\n}\n");
         test_lexer("test hello world",
             &arena,
-            src = c_str("import std::io;\n\nvoid main() {\n\tio::println(\"Hello, world!\");\n}\n"),
+            src,
             (ArrayList_Token){
                 .length = 19,
                 .array = (Token[]){
@@ -236,6 +236,94 @@ int main(void) {
         arena_reset(&arena);
     }
 
+    {
+        String src = c_str("foreach fore int6 int64 CRASH crash\n");
+        test_lexer("test keywords and near misses",
+            &arena,
+            src,
+            (ArrayList_Token){
+                .length = 7,
+                .array = (Token[]){
+                    {
+                        .type = TT_FOREACH,
+                        .start = src.chars + 0,
+                        .length = 7,
+                        .line = 1,
+                    },
+                    {
+                        .type = TT_IDENTIFIER,
+                        .start = src.chars + 8,
+                        .length = 4,
+                        .line = 1,
+                    },
+                    {
+                        .type = TT_IDENTIFIER,
+                        .start = src.chars + 13,
+                        .length = 4,
+                        .line = 1,
+                    },
+                    {
+                        .type = TT_INT64,
+                        .start = src.chars + 18,
+                        .length = 5,
+                        .line = 1,
+                    },
+                    {
+                        .type = TT_CRASH,
+                        .start = src.chars + 24,
+                        .length = 5,
+                        .line = 1,
+                    },
+                    {
+                        .type = TT_IDENTIFIER,
+                        .start = src.chars + 30,
+                        .length = 5,
+                        .line = 1,
+                    },
+                    {
+                        .type = TT_EOF,
+                        .start = src.chars + src.length,
+                        .length = 0,
+                        .line = 2,
+                    },
+                },
+            }
+        );
+        arena_reset(&arena);
+    }
+
+    {
+        String src = c_str("/* a /* b */\n c */ x // y\nz\n");
+        test_lexer("test nested comments",
+            &arena,
+            src,
+            (ArrayList_Token){
+                .length = 3,
+                .array = (Token[]){
+                    {
+                        .type = TT_IDENTIFIER,
+                        .start = src.chars + 19,
+                        .length = 1,
+                        .line = 2,
+                    },
+                    {
+                        .type = TT_IDENTIFIER,
+                        .start = src.chars + 26,
+                        .length = 1,
+                        .line = 3,
+                    },
+                    {
+                        .type = TT_EOF,
+                        .start = src.chars + src.length,
+                        .length = 0,
+                        .line = 4,
+                    },
+                },
+            }
+        );
+        arena_reset(&arena);
+    }
+
     return EXIT_SUCCESS;
 }
 
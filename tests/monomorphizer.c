@@ -0,0 +1,143 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <sysexits.h>
+#include <unistd.h>
+
+#include "../src/lib/compiler/compiler.h"
+
+#define assert_true(expr) \
+    if (!(expr)) { fprintf(stderr, "Test failed: \"%s\"\n", test_name); } \
+    assert(expr)
+
+#define assert_eq_i32(expected, actual) \
+    if (expected != actual) { \
+        fprintf(stderr, "Test failed: \"%s\" ... Expected [%d] but got [%d] \n", test_name, expected, actual); \
+    } \
+    assert(expected == actual)
+
+#define assert_eq_u64(expected, actual) \
+    if (expected != actual) { \
+        fprintf(stderr, "Test failed: \"%s\" ... Expected [%lu] but got [%lu] \n", test_name, expected, actual); \
+    } \
+    assert(expected == actual)
+
+static String read_chars(Arena* const arena, char const* const path) {
+    FILE* file = fopen(path, "rb");
+    assert(file);
+
+    fseek(file, 0, SEEK_END);
+    size_t const length = ftell(file);
+    rewind(file);
+
+    char* chars = arena_alloc(arena, length + 1);
+    assert(fread(chars, sizeof(char), length, file) == length);
+    chars[length] = '\0';
+    fclose(file);
+
+    return (String){ .length = length, .chars = chars };
+}
+
+static size_t count_occurrences(String const haystack, char const* const needle) {
+    size_t const needle_length = strlen(needle);
+    size_t count = 0;
+
+    char const* cursor = haystack.chars;
+    while ((cursor = strstr(cursor, needle))) {
+        count += 1;
+        cursor += needle_length;
+    }
+
+    return count;
+}
+
+// Runs the frontend and type resolver on the source at `path`, monomorphizing as part of resolution.
+static void resolve(Arena* const arena, String path) {
+    Strings paths = { .length = 1, .strings = &path };
+    String module_path = c_str("./runtime");
+    Strings module_paths = { .length = 1, .strings = &module_path };
+
+    Frontend frontend = frontend_create(arena, paths, module_paths, c_str(""), 1);
+    frontend_parse(&frontend);
+
+    Packages packages = packages_create(arena);
+    for (size_t i = 0; i < frontend.sources_length; ++i) {
+        ParsedSource const* const source = frontend.sources + i;
+
+        Package* pkg = packages_resolve_or_create(&packages, source->package_name);
+        pkg->ast = source->ast;
+        pkg->decls = source->decls;
+    }
+
+    packages.generic_impls_nodes_length = frontend.next_node_id;
+    packages.generic_impls_nodes_raw = arena_calloc(arena, frontend.next_node_id, sizeof *packages.generic_impls_nodes_raw);
+    packages.generic_impls_nodes_concrete = arena_calloc(arena, frontend.next_node_id, sizeof *packages.generic_impls_nodes_concrete);
+
+    packages.types_length = frontend.next_node_id + frontend.next_type_id;
+    packages.types = arena_calloc(arena, packages.types_length, sizeof *packages.types);
+
+    TypeResolver type_resolver = type_resolver_create(arena, &packages, 1);
+    resolve_types(&type_resolver);
+}
+
+void test_depth_exceeded(
+    char const* const test_name,
+    Arena* const arena,
+    size_t const chain_length
+) {
+    char const* const src_path = ".bin/monomorphizer_test.ql";
+    char const* const err_path = ".bin/monomorphizer_test.err";
+
+    // f0 calls f1, which calls f2, and so on, each with the same generic arg
+    {
+        FILE* file = fopen(src_path, "wb");
+        assert(file);
+        fprintf(file, "package main;\n\n");
+        for (size_t i = 0; i < chain_length; ++i) {
+            fprintf(file, "void f%lu<T>(T x) { f%lu<T>(x); }\n\n", i, i + 1);
+        }
+        fprintf(file, "void f%lu<T>(T x) {}\n\n", chain_length);
+        fprintf(file, "int main() {\n\tf0<int>(1);\n\treturn 0;\n}\n");
+        fclose(file);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t const pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        assert(freopen(err_path, "w", stderr));
+        resolve(arena, c_str((char*)src_path));
+        exit(EXIT_SUCCESS);
+    }
+
+    int status = 0;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert_true(WIFEXITED(status));
+    assert_eq_i32(EX_DATAERR, WEXITSTATUS(status));
+
+    String const err = read_chars(arena, err_path);
+    assert_true(strstr(err.chars, "Generic instantiation of f65 is nested more than 64 levels deep:\n") == err.chars);
+
+    // the chain goes back to the call in main, naming each instance once
+    assert_eq_u64((size_t)(MAX_INSTANTIATION_DEPTH + 1), count_occurrences(err, "  instantiated by "));
+    assert_eq_u64((size_t)1, count_occurrences(err, "  instantiated by f0\n"));
+    assert_true(strstr(err.chars, "  instantiated by f64\n  instantiated by f63\n"));
+    assert_true(strcmp(err.chars + err.length - strlen("  instantiated by f1\n  instantiated by f0\n"), "  instantiated by f1\n  instantiated by f0\n") == 0);
+
+    remove(src_path);
+    remove(err_path);
+}
+
+int main(void) {
+    Arena arena = {0};
+    {
+        test_depth_exceeded("test instantiation depth limit reports the chain", &arena, 70);
+        arena_free(&arena);
+    }
+
+    return EXIT_SUCCESS;
+}